@@ -0,0 +1,243 @@
+/*
+ * amr_regrid.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef AMR_REGRID_HPP_
+#define AMR_REGRID_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include "Vector/map_vector.hpp"
+#include "Grid/grid_key.hpp"
+#include "Space/Shape/Box.hpp"
+
+/*! \brief Find where to cut a box of tagged points (Berger-Rigoutsos)
+ *
+ * The signature of the tags (number of tagged points on each plane orthogonal to a direction) is
+ * calculated for every direction. In order of preference the cut is placed
+ *
+ * * on a hole of the signature (plane without tags) closest to the center
+ * * on the strongest inflection point of the signature (zero crossing of its second derivative)
+ * * in the middle of the longest side
+ *
+ * \param tags tagged points
+ * \param start first tag of the box
+ * \param stop one after the last tag of the box
+ * \param bb bounding box of the tags
+ * \param min_side minimum side of the boxes produced by the cut (holes excluded)
+ * \param d direction of the cut
+ * \param cut the points with coordinate d smaller than cut go into the first box
+ *
+ * \return false if the box cannot be cut
+ *
+ */
+template<unsigned int dim>
+bool br_find_cut(const openfpm::vector<grid_key_dx<dim>> & tags, size_t start, size_t stop, const Box<dim,long int> & bb, size_t min_side, size_t & d, long int & cut)
+{
+	openfpm::vector<long int> sig;
+	openfpm::vector<long int> lap;
+
+	bool hole = false;
+	long int hole_dist = 0;
+
+	long int infl_str = 0;
+	long int infl_dist = 0;
+	size_t infl_d = 0;
+	long int infl_cut = 0;
+
+	for (size_t j = 0 ; j < dim ; j++)
+	{
+		long int len = bb.getHigh(j) - bb.getLow(j) + 1;
+		long int mid = len / 2;
+
+		if (len < 3)
+		{continue;}
+
+		sig.resize(len);
+		for (long int i = 0 ; i < len ; i++)
+		{sig.get(i) = 0;}
+
+		for (size_t t = start ; t < stop ; t++)
+		{sig.get(tags.get(t).get(j) - bb.getLow(j))++;}
+
+		// holes (the first and the last plane have tags because bb is the bounding box)
+		for (long int i = 1 ; i < len - 1 ; i++)
+		{
+			if (sig.get(i) == 0 && (hole == false || std::abs(i - mid) < hole_dist))
+			{
+				hole = true;
+				hole_dist = std::abs(i - mid);
+				d = j;
+				cut = bb.getLow(j) + i;
+			}
+		}
+
+		if (hole == true)
+		{continue;}
+
+		// inflection points
+		lap.resize(len);
+		for (long int i = 1 ; i < len - 1 ; i++)
+		{lap.get(i) = sig.get(i+1) - 2*sig.get(i) + sig.get(i-1);}
+
+		for (long int i = 1 ; i < len - 2 ; i++)
+		{
+			if ((lap.get(i) < 0 && lap.get(i+1) >= 0) || (lap.get(i) >= 0 && lap.get(i+1) < 0))
+			{
+				long int str = std::abs(lap.get(i+1) - lap.get(i));
+
+				if (i + 1 < (long int)min_side || len - i - 1 < (long int)min_side)
+				{continue;}
+
+				if (str > infl_str || (str == infl_str && std::abs(i + 1 - mid) < infl_dist))
+				{
+					infl_str = str;
+					infl_dist = std::abs(i + 1 - mid);
+					infl_d = j;
+					infl_cut = bb.getLow(j) + i + 1;
+				}
+			}
+		}
+	}
+
+	if (hole == true)
+	{return true;}
+
+	if (infl_str != 0)
+	{
+		d = infl_d;
+		cut = infl_cut;
+		return true;
+	}
+
+	// bisect the longest side
+	long int max_len = 0;
+	for (size_t j = 0 ; j < dim ; j++)
+	{
+		long int len = bb.getHigh(j) - bb.getLow(j) + 1;
+
+		if (len > max_len)
+		{
+			max_len = len;
+			d = j;
+		}
+	}
+
+	if (max_len < 2*(long int)min_side)
+	{return false;}
+
+	cut = bb.getLow(d) + max_len / 2;
+	return true;
+}
+
+/*! \brief Cluster a set of tagged points into boxes (Berger-Rigoutsos)
+ *
+ * A box is accepted when the ratio between tagged points and points of the box is at least eff,
+ * otherwise it is cut with br_find_cut and the two parts are processed again. Every box is shrunk
+ * to the bounding box of its tags
+ *
+ * \param tags tagged points (they are reordered)
+ * \param eff minimum efficiency of the boxes (0 < eff <= 1)
+ * \param min_side minimum side of the boxes
+ * \param boxes produced boxes
+ *
+ */
+template<unsigned int dim>
+void berger_rigoutsos(openfpm::vector<grid_key_dx<dim>> & tags, double eff, size_t min_side, openfpm::vector<Box<dim,long int>> & boxes)
+{
+	boxes.clear();
+
+	if (tags.size() == 0)
+	{return;}
+
+	// boxes to process as range of tags
+	openfpm::vector<std::pair<size_t,size_t>> stack;
+	stack.add(std::pair<size_t,size_t>(0,tags.size()));
+
+	while (stack.size() != 0)
+	{
+		size_t start = stack.last().first;
+		size_t stop = stack.last().second;
+		stack.remove(stack.size()-1);
+
+		// bounding box
+		Box<dim,long int> bb;
+		for (size_t j = 0 ; j < dim ; j++)
+		{
+			bb.setLow(j,tags.get(start).get(j));
+			bb.setHigh(j,tags.get(start).get(j));
+		}
+
+		for (size_t t = start + 1 ; t < stop ; t++)
+		{
+			for (size_t j = 0 ; j < dim ; j++)
+			{
+				bb.setLow(j,std::min(bb.getLow(j),(long int)tags.get(t).get(j)));
+				bb.setHigh(j,std::max(bb.getHigh(j),(long int)tags.get(t).get(j)));
+			}
+		}
+
+		double vol = 1.0;
+		for (size_t j = 0 ; j < dim ; j++)
+		{vol *= bb.getHigh(j) - bb.getLow(j) + 1;}
+
+		size_t d = 0;
+		long int cut = 0;
+
+		if ((double)(stop - start) / vol >= eff || br_find_cut(tags,start,stop,bb,min_side,d,cut) == false)
+		{
+			boxes.add(bb);
+			continue;
+		}
+
+		grid_key_dx<dim> * first = &tags.get(start);
+		grid_key_dx<dim> * last = first + (stop - start);
+
+		grid_key_dx<dim> * middle = std::partition(first,last,[&](const grid_key_dx<dim> & k){return k.get(d) < cut;});
+
+		size_t split = start + (middle - first);
+
+		stack.add(std::pair<size_t,size_t>(start,split));
+		stack.add(std::pair<size_t,size_t>(split,stop));
+	}
+}
+
+/*! \brief Load balancing model for the regridding
+ *
+ * The points covered by the refined boxes cost 2^dim more (the points of the finer level)
+ *
+ */
+template<unsigned int dim, typename St>
+struct ModelAMRRegrid
+{
+	//! refined boxes in physical coordinates
+	openfpm::vector<Box<dim,St>> ref;
+
+	/*! \brief Computational cost of a point
+	 *
+	 * \param p point
+	 *
+	 * \return the additional cost of the point
+	 *
+	 */
+	size_t resolution(const Point<dim,St> & p)
+	{
+		for (size_t i = 0 ; i < ref.size() ; i++)
+		{
+			if (ref.get(i).isInside(p) == true)
+			{return 1 << dim;}
+		}
+
+		return 0;
+	}
+
+	double distributionTol()
+	{
+		return 1.01;
+	}
+};
+
+#endif /* AMR_REGRID_HPP_ */
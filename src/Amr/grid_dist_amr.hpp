@@ -12,6 +12,8 @@
 
 #include "Grid/grid_dist_id.hpp"
 #include "Amr/grid_dist_amr_key_iterator.hpp"
+#include "Amr/amr_regrid.hpp"
+#include <unordered_map>
 
 #ifdef __NVCC__
 #include "SparseGridGpu/SparseGridGpu.hpp"
@@ -169,6 +171,62 @@ class grid_dist_amr<dim,St,T,AMR_IMPL_TRIVIAL,Decomposition,Memory,device_grid>
 	//! background level
 	T bck;
 
+	//! For each level the boxes (in grid units of the level) refined by the last regrid
+	openfpm::vector<openfpm::vector<Box<dim,long int>>> rg_box;
+
+	/*! \brief Check if a point is inside one of the boxes
+	 *
+	 * \param bx boxes
+	 * \param gk point
+	 *
+	 * \return true if the point is inside one of the boxes
+	 *
+	 */
+	static bool inside_boxes(const openfpm::vector<Box<dim,long int>> & bx, const grid_key_dx<dim> & gk)
+	{
+		for (size_t i = 0 ; i < bx.size() ; i++)
+		{
+			size_t j = 0;
+
+			for ( ; j < dim ; j++)
+			{
+				if (gk.get(j) < bx.get(i).getLow(j) || gk.get(j) > bx.get(i).getHigh(j))
+				{break;}
+			}
+
+			if (j == dim)
+			{return true;}
+		}
+
+		return false;
+	}
+
+	/*! \brief Gather the boxes of all the processors
+	 *
+	 * \param boxes boxes of this processor
+	 * \param boxes_g boxes of all the processors
+	 *
+	 */
+	void gather_boxes(openfpm::vector<Box<dim,long int>> & boxes, openfpm::vector<Box<dim,long int>> & boxes_g)
+	{
+		auto & v_cl = create_vcluster();
+
+		boxes_g.clear();
+
+		v_cl.SGather(boxes,boxes_g,0);
+		v_cl.execute();
+
+		size_t size = boxes_g.size();
+
+		v_cl.max(size);
+		v_cl.execute();
+
+		boxes_g.resize(size);
+
+		v_cl.Bcast(boxes_g,0);
+		v_cl.execute();
+	}
+
 	/*! \brief Initialize the others levels
 	 *
 	 * \param n_grid_dist_id<dim,St,T,Decomposition,Memory,device_grid>lvl number of levels
@@ -754,15 +812,41 @@ public:
 	//////////////////////////////////////
 
 	/*! \brief It synchronize the ghost parts
+	 *
+	 * The exchange of all the levels is fused. All the levels pack their ghost and synchronize the
+	 * local ghost, then the messages of all the levels directed to the same processor are packed in one
+	 * message, so one communication round is done for all the levels (dense or sparse)
 	 *
 	 * \tparam prp... Properties to synchronize
 	 *
+	 * \param opt options
+	 *
 	 */
 	template<int... prp> void ghost_get(size_t opt = 0)
 	{
+		if (opt & RUN_ON_DEVICE)
+		{
+			for (size_t i = 0 ; i < gd_array.size() ; i++)
+			{
+				gd_array.get(i).template ghost_get<prp...>(opt);
+			}
+
+			return;
+		}
+
+		openfpm::vector<grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid> *> grids;
+
 		for (size_t i = 0 ; i < gd_array.size() ; i++)
 		{
-			gd_array.get(i).template ghost_get<prp...>(opt);
+			gd_array.get(i).template ghost_get_start<prp...>(opt,true);
+			grids.add(&gd_array.get(i));
+		}
+
+		grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid>::fused_sendrecv(grids);
+
+		for (size_t i = 0 ; i < gd_array.size() ; i++)
+		{
+			gd_array.get(i).template ghost_get_finish<prp...>();
 		}
 	}
 
@@ -771,9 +855,31 @@ public:
 	 */
 	void map(size_t opt = 0)
 	{
+		if (opt & RUN_ON_DEVICE)
+		{
+			for (size_t i = 0 ; i < gd_array.size() ; i++)
+			{
+				gd_array.get(i).map();
+			}
+
+			recalculate_mvoff();
+			return;
+		}
+
+		// the parts of all the levels are exchanged in one communication round
+		openfpm::vector<grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid> *> grids;
+
+		for (size_t i = 0 ; i < gd_array.size() ; i++)
+		{
+			gd_array.get(i).map_start(opt,true);
+			grids.add(&gd_array.get(i));
+		}
+
+		grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid>::fused_sendrecv(grids);
+
 		for (size_t i = 0 ; i < gd_array.size() ; i++)
 		{
-			gd_array.get(i).map();
+			gd_array.get(i).map_finish();
 		}
 
 		recalculate_mvoff();
@@ -786,10 +892,197 @@ public:
 	 */
 	template<template<typename,typename> class op,int... prp> void ghost_put()
 	{
+		// the ghost of all the levels is exchanged in one communication round (see ghost_get)
+		openfpm::vector<grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid> *> grids;
+
 		for (size_t i = 0 ; i < gd_array.size() ; i++)
 		{
-			gd_array.get(i).template ghost_put<op,prp...>();
+			gd_array.get(i).template ghost_put_start<op,prp...>(true);
+			grids.add(&gd_array.get(i));
+		}
+
+		grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid>::fused_sendrecv(grids);
+
+		for (size_t i = 0 ; i < gd_array.size() ; i++)
+		{
+			gd_array.get(i).template ghost_put_finish<op,prp...>();
+		}
+	}
+
+	/*! \brief Rebuild the level lvl+1 where the level lvl require refinement
+	 *
+	 * The points of the level lvl are tagged with tag, the tagged points are clustered
+	 * in boxes with the Berger-Rigoutsos algorithm and the boxes are enlarged by buffer points.
+	 * The enlarged boxes are exchanged across processors, because the buffer can fall in the
+	 * domain of a neighborhood processor. The points of the level lvl+1 already refined (the inserted
+	 * points for sparse levels, the boxes of the previous regrid for dense levels) and covered by the
+	 * new boxes are kept, the other points of the level lvl+1 are removed (in case of sparse levels),
+	 * interp fill the new points from the coarse level. Optionally the decomposition is
+	 * rebalanced taking into account the new refined regions and the levels are migrated
+	 *
+	 * \snippet grid_dist_amr_unit_tests.cpp amr regrid
+	 *
+	 * \note the clustering is done on the tags of each processor, so the clustered boxes do not cross
+	 *       the processor domains (only their buffer does), the boxes are not extended across periodic boundaries
+	 *
+	 * \param lvl level to tag (the level lvl+1 is rebuilt)
+	 * \param tag tag(key) return true if the point key (grid_dist_amr_key) of the level lvl require refinement
+	 * \param interp interp(key_fine,key_coarse) fill the new point key_fine, key_coarse is the
+	 *        point on the level lvl that contain it
+	 * \param eff minimum ratio of tagged points in every box
+	 * \param buffer number of points (of level lvl) added around every box
+	 * \param min_side minimum side of the boxes
+	 * \param rebalance rebalance the decomposition and migrate the levels
+	 *
+	 * \return the number of boxes on this processor
+	 *
+	 */
+	template<typename tag_f, typename interp_f>
+	size_t regrid(size_t lvl, tag_f tag, interp_f interp, double eff = 0.7, size_t buffer = 1, size_t min_side = 2, bool rebalance = false)
+	{
+		if (lvl + 1 >= gd_array.size())
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error: level " << lvl << " has not a finer level to regrid" << std::endl;
+			return 0;
+		}
+
+		// tag
+		openfpm::vector<grid_key_dx<dim>> tags;
+
+		auto it = gd_array.get(lvl).getDomainIterator();
+
+		while (it.isNext())
+		{
+			auto key = it.get();
+
+			if (tag(getAMRKey(lvl,key)) == true)
+			{tags.add(it.getGKey(key));}
+
+			++it;
 		}
+
+		// cluster
+		openfpm::vector<Box<dim,long int>> boxes;
+		berger_rigoutsos(tags,eff,min_side,boxes);
+
+		const grid_sm<dim,void> & gc = gd_array.get(lvl).getGridInfoVoid();
+		const grid_sm<dim,void> & gf = gd_array.get(lvl+1).getGridInfoVoid();
+
+		for (size_t i = 0 ; i < boxes.size() ; i++)
+		{
+			Box<dim,long int> & b = boxes.get(i);
+
+			for (size_t j = 0 ; j < dim ; j++)
+			{
+				b.setLow(j,std::max(b.getLow(j) - (long int)buffer,0l));
+				b.setHigh(j,std::min(b.getHigh(j) + (long int)buffer,(long int)gc.size(j) - 1));
+			}
+		}
+
+		// the buffer of the boxes can fall in the domain of other processors
+		openfpm::vector<Box<dim,long int>> boxes_g;
+		gather_boxes(boxes,boxes_g);
+
+		openfpm::vector<Box<dim,long int>> boxes_f;
+
+		for (size_t i = 0 ; i < boxes_g.size() ; i++)
+		{
+			Box<dim,long int> & b = boxes_g.get(i);
+			Box<dim,long int> bf;
+
+			for (size_t j = 0 ; j < dim ; j++)
+			{
+				bf.setLow(j,2*b.getLow(j));
+				bf.setHigh(j,std::min(2*b.getHigh(j) + 1,(long int)gf.size(j) - 1));
+			}
+
+			boxes_f.add(bf);
+		}
+
+		if (rg_box.size() < gd_array.size())
+		{rg_box.resize(gd_array.size());}
+
+		// save the points of the finer level already refined and covered by the new boxes
+		openfpm::vector<T> old_val;
+		std::unordered_map<size_t,size_t> old_id;
+
+		auto ito = gd_array.get(lvl+1).getDomainIterator();
+
+		while (ito.isNext())
+		{
+			auto key = ito.get();
+			auto gkey = ito.getGKey(key);
+
+			if ((device_grid::isCompressed() == true || inside_boxes(rg_box.get(lvl+1),gkey) == true) &&
+				inside_boxes(boxes_f,gkey) == true)
+			{
+				old_id[gf.LinId(gkey)] = old_val.size();
+				old_val.add();
+				old_val.get(old_val.size()-1) = gd_array.get(lvl+1).get_loc_grid(key.getSub()).get_o(key.getKey());
+			}
+
+			++ito;
+		}
+
+		// rebuild the finer level
+		gd_array.get(lvl+1).clear();
+
+		for (size_t i = 0 ; i < boxes_f.size() ; i++)
+		{
+			grid_key_dx<dim> start = boxes_f.get(i).getKP1();
+			grid_key_dx<dim> stop = boxes_f.get(i).getKP2();
+
+			auto itf = gd_array.get(lvl+1).getGridIterator(start,stop);
+
+			while (itf.isNext())
+			{
+				auto key_d = itf.get_dist();
+				auto fnd = old_id.find(gf.LinId(itf.get()));
+
+				if (fnd != old_id.end())
+				{
+					gd_array.get(lvl+1).get_loc_grid(key_d.getSub()).insert_o(key_d.getKey()) = old_val.get(fnd->second);
+				}
+				else
+				{
+					auto key_f = getAMRKey(lvl+1,key_d);
+					auto key_c = key_f;
+					moveLvlUp(key_c);
+
+					interp(key_f,key_c);
+				}
+
+				++itf;
+			}
+		}
+
+		rg_box.get(lvl+1).swap(boxes_f);
+
+		if (rebalance == true)
+		{
+			ModelAMRRegrid<dim,St> md;
+			Point<dim,St> sp = getSpacing(lvl);
+
+			for (size_t i = 0 ; i < boxes.size() ; i++)
+			{
+				Box<dim,St> bp;
+
+				for (size_t j = 0 ; j < dim ; j++)
+				{
+					bp.setLow(j,domain.getLow(j) + boxes.get(i).getLow(j)*sp.get(j));
+					bp.setHigh(j,domain.getLow(j) + (boxes.get(i).getHigh(j) + 1)*sp.get(j));
+				}
+
+				md.ref.add(bp);
+			}
+
+			addComputationCosts(md);
+			getDecomposition().refine(1);
+
+			map();
+		}
+
+		return boxes.size();
 	}
 
 	/*! \brief Return the number of inserted points on a particular level
@@ -787,6 +787,139 @@ void Test3D_ghost_put(grid_amr & g_dist_amr, long int k)
 
 
 
+template<typename grid_amr>
+void Test3D_amr_fused_vs_level(grid_amr & amr_g, long int k)
+{
+	size_t sz[3] = {(size_t)k,(size_t)k,(size_t)k};
+
+	amr_g.initLevels(3,sz);
+
+	// property 0 is synchronized with the fused exchange of all the levels, property 1 level by level
+	for (size_t lvl = 0 ; lvl < amr_g.getNLvl() ; lvl++)
+	{
+		auto it = amr_g.getDomainGhostIterator(lvl);
+
+		while (it.isNext())
+		{
+			auto key = it.get();
+
+			amr_g.template get<0>(lvl,key) = -1;
+			amr_g.template get<1>(lvl,key) = -1;
+
+			++it;
+		}
+
+		auto dom = amr_g.getGridIterator(lvl);
+
+		while (dom.isNext())
+		{
+			auto key = dom.get_dist();
+			auto gkey = dom.get();
+
+			long int v = gkey.get(0) + 100*gkey.get(1) + 10000*gkey.get(2) + 1000000*lvl;
+
+			amr_g.template insert<0>(lvl,key) = v;
+			amr_g.template insert<1>(lvl,key) = v;
+
+			++dom;
+		}
+	}
+
+	amr_g.template ghost_get<0>();
+
+	for (size_t lvl = 0 ; lvl < amr_g.getNLvl() ; lvl++)
+	{amr_g.getDistGrid(lvl).template ghost_get<1>();}
+
+	bool match = true;
+	size_t n_ghost = 0;
+
+	for (size_t lvl = 0 ; lvl < amr_g.getNLvl() ; lvl++)
+	{
+		auto it = amr_g.getDomainGhostIterator(lvl);
+
+		while (it.isNext())
+		{
+			auto key = it.get();
+
+			match &= amr_g.template get<0>(lvl,key) == amr_g.template get<1>(lvl,key);
+			n_ghost++;
+
+			++it;
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+	BOOST_REQUIRE(n_ghost != 0);
+
+	// ghost_put
+	for (size_t lvl = 0 ; lvl < amr_g.getNLvl() ; lvl++)
+	{
+		auto it = amr_g.getDomainGhostIterator(lvl);
+
+		while (it.isNext())
+		{
+			auto key = it.get();
+
+			amr_g.template get<0>(lvl,key) = 1;
+			amr_g.template get<1>(lvl,key) = 1;
+
+			++it;
+		}
+	}
+
+	amr_g.template ghost_put<add_,0>();
+
+	for (size_t lvl = 0 ; lvl < amr_g.getNLvl() ; lvl++)
+	{amr_g.getDistGrid(lvl).template ghost_put<add_,1>();}
+
+	long int sum_before = 0;
+
+	for (size_t lvl = 0 ; lvl < amr_g.getNLvl() ; lvl++)
+	{
+		auto it = amr_g.getDomainIterator(lvl);
+
+		while (it.isNext())
+		{
+			auto key = it.get();
+
+			match &= amr_g.template get<0>(lvl,key) == amr_g.template get<1>(lvl,key);
+			sum_before += amr_g.template get<0>(lvl,key) * (lvl+1);
+
+			++it;
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+
+	// the fused map move every level without losing points
+	amr_g.map();
+
+	long int sum_after = 0;
+
+	for (size_t lvl = 0 ; lvl < amr_g.getNLvl() ; lvl++)
+	{
+		auto it = amr_g.getDomainIterator(lvl);
+
+		while (it.isNext())
+		{
+			auto key = it.get();
+
+			match &= amr_g.template get<0>(lvl,key) == amr_g.template get<1>(lvl,key);
+			sum_after += amr_g.template get<0>(lvl,key) * (lvl+1);
+
+			++it;
+		}
+	}
+
+	auto & v_cl = create_vcluster();
+	v_cl.sum(sum_before);
+	v_cl.sum(sum_after);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(match,true);
+	BOOST_REQUIRE_EQUAL(sum_before,sum_after);
+}
+
 BOOST_AUTO_TEST_CASE( grid_dist_amr_get_child_test_nop )
 {
 	// Domain
@@ -1022,4 +1155,159 @@ BOOST_AUTO_TEST_CASE( grid_dist_amr_ghost_put_create )
 	Test3D_ghost_put(sg_dist,k);
 }
 
+BOOST_AUTO_TEST_CASE( grid_dist_amr_regrid_test )
+{
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	Vcluster<> & v_cl = create_vcluster();
+
+	if ( v_cl.getProcessingUnits() > 8 )
+	{return;}
+
+	size_t g_sz[3] = {33,33,33};
+
+	Ghost<3,long int> g(1);
+	sgrid_dist_amr<3,float,aggregate<float>> amr_g(domain,g);
+
+	amr_g.initLevels(2,g_sz);
+
+	auto it = amr_g.getGridIterator(0);
+
+	while (it.isNext())
+	{
+		auto key = it.get_dist();
+		auto gkey = it.get();
+
+		amr_g.template insert<0>(amr_g.getAMRKey(0,key)) = gkey.get(0) + 100*gkey.get(1) + 10000*gkey.get(2);
+
+		++it;
+	}
+
+	amr_g.template ghost_get<0>();
+
+	// a point already refined, it must survive the regrid
+	grid_key_dx<3> mk({32,32,32});
+
+	auto itm = amr_g.getGridIterator(1,mk,mk);
+
+	while (itm.isNext())
+	{
+		amr_g.template insert<0>(amr_g.getAMRKey(1,itm.get_dist())) = 0.5;
+
+		++itm;
+	}
+
+	auto is_tagged = [](const grid_key_dx<3> & gk)
+	{
+		long int dx = gk.get(0) - 16;
+		long int dy = gk.get(1) - 16;
+		long int dz = gk.get(2) - 16;
+
+		return dx*dx + dy*dy + dz*dz < 6*6;
+	};
+
+	//! [amr regrid]
+
+	// refine around the center of the domain, the new points are injected from the coarse level
+	size_t n_box = amr_g.regrid(0,[&](const grid_dist_amr_key<3> & key)
+	                              {return is_tagged(amr_g.getGKey(key));},
+	                              [&](const grid_dist_amr_key<3> & key_f, const grid_dist_amr_key<3> & key_c)
+	                              {amr_g.template insert<0>(key_f) = amr_g.template get<0>(key_c);},
+	                              0.7,1);
+
+	//! [amr regrid]
+
+	bool match = true;
+	size_t n_fine = 0;
+
+	auto it2 = amr_g.getDomainIterator(1);
+
+	while (it2.isNext())
+	{
+		auto key = amr_g.getAMRKey(1,it2.get());
+		auto key_c = key;
+		amr_g.moveLvlUp(key_c);
+
+		if (amr_g.getGKey(key) == mk)
+		{match &= amr_g.template get<0>(key) == 0.5;}
+		else
+		{match &= amr_g.template get<0>(key) == amr_g.template get<0>(key_c);}
+
+		n_fine++;
+
+		++it2;
+	}
+
+	// every tagged point is refined
+	auto it3 = amr_g.getDomainIterator(0);
+
+	while (it3.isNext())
+	{
+		auto key = amr_g.getAMRKey(0,it3.get());
+
+		grid_key_dx<3> gk = amr_g.getGKey(key);
+
+		// every point in the buffer of a tagged point is refined, also when the tagged
+		// point is on another processor
+		bool near_tag = false;
+
+		for (long int i = -1 ; i <= 1 ; i++)
+		{
+			for (long int j = -1 ; j <= 1 ; j++)
+			{
+				for (long int k = -1 ; k <= 1 ; k++)
+				{
+					grid_key_dx<3> gn({gk.get(0)+i,gk.get(1)+j,gk.get(2)+k});
+					near_tag |= is_tagged(gn);
+				}
+			}
+		}
+
+		if (near_tag == true)
+		{
+			auto key_f = key;
+			amr_g.moveLvlDw(key_f);
+
+			match &= amr_g.existPoint(key_f);
+		}
+
+		++it3;
+	}
+
+	v_cl.sum(n_fine);
+	v_cl.sum(n_box);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(match,true);
+	BOOST_REQUIRE(n_box != 0);
+	BOOST_REQUIRE(n_fine != 0);
+	BOOST_REQUIRE(n_fine < 65*65*65 / 4);
+}
+
+BOOST_AUTO_TEST_CASE( grid_dist_amr_fused_exchange )
+{
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	Vcluster<> & v_cl = create_vcluster();
+
+	if ( v_cl.getProcessingUnits() > 32 )
+	{return;}
+
+	long int k = 13;
+
+	Ghost<3,long int> g(1);
+
+	periodicity<3> pr = {{PERIODIC,PERIODIC,PERIODIC}};
+
+	// dense levels
+	grid_dist_amr<3, float, aggregate<long int,long int>> g_dist(domain,g,pr);
+
+	Test3D_amr_fused_vs_level(g_dist,k);
+
+	// sparse levels
+	sgrid_dist_amr<3, float, aggregate<long int,long int>> sg_dist(domain,g,pr);
+
+	Test3D_amr_fused_vs_level(sg_dist,k);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
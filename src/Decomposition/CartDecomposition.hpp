@@ -236,6 +236,15 @@ protected:
 	//! set of Boxes produced by the decomposition optimizer
 	openfpm::vector<::Box<dim, size_t>> loc_boxes;
 
+	//! Owner of each sub-sub-domain when the sub-domains has been created
+	openfpm::vector<size_t> ss_owner;
+
+	//! refine and redecompose keep the sub-domains of the processors not affected by the new distribution
+	bool keep_sub = false;
+
+	//! algorithm used to merge the sub-sub-domains into sub-domains
+	dec_merge merge_type = dec_merge::WAVEFRONT;
+
 	/*! \brief It convert the box from the domain decomposition into sub-domain
 	 *
 	 * The decomposition box from the domain-decomposition contain the box in integer
@@ -402,7 +411,10 @@ public:
 		}
 
 		// optimize the decomposition or merge sub-sub-domain
-		d_o.template optimize<nm_v_sub_id, nm_v_proc_id>(dist.getGraph(), p_id, loc_boxes, box_nn_processor,ghe,bc);
+		if (merge_type == dec_merge::MAX_BOX)
+		{d_o.template optimize_max_box<nm_v_sub_id, nm_v_proc_id>(dist.getGraph(), p_id, loc_boxes, box_nn_processor,ghe,bc);}
+		else
+		{d_o.template optimize<nm_v_sub_id, nm_v_proc_id>(dist.getGraph(), p_id, loc_boxes, box_nn_processor,ghe,bc);}
 
 		// Initialize
 		if (loc_boxes.size() > 0)
@@ -437,6 +449,14 @@ public:
 			proc_box.enclose(loc_boxes.get(s));
 		}
 
+		createSubdomainsStructures();
+	}
+
+	/*! \brief Create the structures that depend on the sub-domains (neighborhood processors, fine_s, geo-cells)
+	 *
+	 */
+	void createSubdomainsStructures()
+	{
 		nn_prcs<dim,T,layout_base,Memory>::create(box_nn_processor, sub_domains);
 		nn_prcs<dim,T,layout_base,Memory>::applyBC(domain,ghost,bc);
 
@@ -450,6 +470,154 @@ public:
 		construct_fine_s();
 
 		Initialize_geo_cell_lists();
+
+		// store the owner of each sub-sub-domain
+		auto & gp = dist.getGraph();
+
+		ss_owner.resize(gp.getNVertex());
+		for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+		{ss_owner.get(i) = gp.template vertex_p<nm_v_proc_id>(i);}
+	}
+
+	/*! \brief Check if the local sub-domains are unchanged by the new distribution
+	 *
+	 * The sub-domains produced by dec_optimizer depend only on the sub-sub-domains owned by the
+	 * processor, and the list of neighborhood processors on the owners of the sub-sub-domains
+	 * within the ghost. If no sub-sub-domain that moved is owned (before or after) by this processor or
+	 * is within the ghost of the processor domain, the local sub-domains do not change
+	 *
+	 * \param moved sub-sub-domains that changed owner
+	 *
+	 * \return true if the local sub-domains can be kept
+	 *
+	 */
+	bool localSubdomainsUnchanged(const openfpm::vector<size_t> & moved)
+	{
+		size_t p_id = v_cl.getProcessUnitID();
+		auto & gp = dist.getGraph();
+
+		if (loc_boxes.size() == 0)
+		{return false;}
+
+		// processor domain enlarged by the ghost (decomposition grid units)
+		::Box<dim,long int> reach;
+		for (size_t i = 0 ; i < dim ; i++)
+		{
+			long int gl = static_cast<long int>(ghost.getLow(i)/spacing[i]) - 1;
+			long int gh = static_cast<long int>(ghost.getHigh(i)/spacing[i]) + 1;
+
+			reach.setLow(i,(long int)proc_box.getLow(i) + gl - 1);
+			reach.setHigh(i,(long int)proc_box.getHigh(i) + gh + 1);
+		}
+
+		for (size_t k = 0 ; k < moved.size() ; k++)
+		{
+			size_t v = moved.get(k);
+
+			if (ss_owner.get(v) == p_id || (size_t)gp.template vertex_p<nm_v_proc_id>(v) == p_id)
+			{return false;}
+
+			grid_key_dx<dim> key = gr_dist.InvLinId(v);
+
+			::Box<dim,long int> cell;
+			for (size_t i = 0 ; i < dim ; i++)
+			{
+				cell.setLow(i,key.get(i)*magn[i]);
+				cell.setHigh(i,(key.get(i)+1)*magn[i] - 1);
+			}
+
+			// with periodic boundary the ghost reach the cells across the domain, we check
+			// all the periodic images of the cell
+			size_t n_img = openfpm::math::pow(3,dim);
+
+			for (size_t c = 0 ; c < n_img ; c++)
+			{
+				::Box<dim,long int> cell_s = cell;
+				size_t cc = c;
+				bool valid = true;
+
+				for (size_t i = 0 ; i < dim ; i++)
+				{
+					long int sh = (long int)(cc % 3) - 1;
+					cc /= 3;
+
+					if (sh != 0 && bc[i] != PERIODIC)
+					{valid = false;break;}
+
+					cell_s.setLow(i,cell.getLow(i) + sh*(long int)gr.size(i));
+					cell_s.setHigh(i,cell.getHigh(i) + sh*(long int)gr.size(i));
+				}
+
+				::Box<dim,long int> inte;
+
+				if (valid == true && cell_s.Intersect(reach,inte) == true)
+				{return false;}
+			}
+		}
+
+		return true;
+	}
+
+	/*! \brief Update the decomposition after the distribution changed
+	 *
+	 * By default the decomposition is rebuilt from scratch. With setKeepSubdomains(true), if no sub-sub-domain
+	 * changed owner the decomposition is kept as it is, otherwise the processors whose local sub-domains are
+	 * not affected by the moved sub-sub-domains (see localSubdomainsUnchanged) keep their sub-domains and skip
+	 * dec_optimizer.
+	 *
+	 * \note only dec_optimizer is skipped, the neighborhood processors, fine_s, geo-cells and ghost boxes
+	 *       are recalculated on all the processors
+	 *
+	 */
+	void updateSubdomains()
+	{
+		auto & gp = dist.getGraph();
+
+		openfpm::vector<size_t> moved;
+		bool full = (keep_sub == false || ss_owner.size() != gp.getNVertex());
+
+		if (full == false)
+		{
+			for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+			{
+				if (ss_owner.get(i) != (size_t)gp.template vertex_p<nm_v_proc_id>(i))
+				{moved.add(i);}
+			}
+		}
+
+		// the graph is the same on all the processors, so the decision is, but we make it sure
+		size_t n_moved = (full == true)?gp.getNVertex():moved.size();
+		v_cl.max(n_moved);
+		v_cl.execute();
+
+		if (n_moved == 0)
+		{return;}
+
+		if (full == false && localSubdomainsUnchanged(moved) == true)
+		{
+			openfpm::vector<SpaceBox<dim, T>,Memory,layout_base> sub_domains_old = sub_domains;
+			openfpm::vector<openfpm::vector<long unsigned int> > box_nn_processor_old = box_nn_processor;
+			openfpm::vector<::Box<dim, size_t>> loc_boxes_old = loc_boxes;
+
+			reset();
+
+			sub_domains.swap(sub_domains_old);
+			box_nn_processor.swap(box_nn_processor_old);
+			loc_boxes.swap(loc_boxes_old);
+
+			initialize_fine_s(domain);
+			createSubdomainsStructures();
+		}
+		else
+		{
+			reset();
+			createSubdomains(v_cl,bc);
+		}
+
+		calculateGhostBoxes();
+
+		domain_nn_calculator_cart<dim>::reset();
+		domain_nn_calculator_cart<dim>::setParameters(proc_box);
 	}
 
 	/*! \brief Initialize geo_cell lists
@@ -1002,6 +1170,9 @@ public:
 		gr_dist = cart.gr_dist;
 		dist = cart.dist;
 		commCostSet = cart.commCostSet;
+		ss_owner = cart.ss_owner;
+		keep_sub = cart.keep_sub;
+		merge_type = cart.merge_type;
 		cd = cart.cd;
 		domain = cart.domain;
 		sub_domains_global = cart.sub_domains_global;
@@ -1083,6 +1254,9 @@ public:
 		gr_dist = cart.gr_dist;
 		dist = cart.dist;
 		commCostSet = cart.commCostSet;
+		ss_owner = cart.ss_owner;
+		keep_sub = cart.keep_sub;
+		merge_type = cart.merge_type;
 		cd = cart.cd;
 		gr_dist = cart.gr_dist;
 		dist = cart.dist;
@@ -1433,19 +1607,12 @@ public:
 	 */
 	void refine(size_t ts)
 	{
-		reset();
-
 		if (commCostSet == false)
 		{computeCommunicationAndMigrationCosts(ts);}
 
 		dist.refine();
 
-		createSubdomains(v_cl,bc);
-
-		calculateGhostBoxes();
-
-		domain_nn_calculator_cart<dim>::reset();
-		domain_nn_calculator_cart<dim>::setParameters(proc_box);
+		updateSubdomains();
 	}
 
 	/*! \brief Refine the decomposition, available only for ParMetis distribution, for Metis it is a null call
@@ -1455,19 +1622,39 @@ public:
 	 */
 	void redecompose(size_t ts)
 	{
-		reset();
-
 		if (commCostSet == false)
 		{computeCommunicationAndMigrationCosts(ts);}
 
 		dist.redecompose();
 
-		createSubdomains(v_cl,bc);
+		updateSubdomains();
+	}
 
-		calculateGhostBoxes();
+	/*! \brief Enable or disable in refine and redecompose the reuse of the sub-domains of the processors
+	 *         not affected by the new distribution (they skip dec_optimizer)
+	 *
+	 * Only dec_optimizer is skipped, the rest of the decomposition (neighborhood processors, fine_s,
+	 * geo-cells and ghost boxes) is recalculated on all the processors. When disabled every processor
+	 * recompute its sub-domains (default disabled)
+	 *
+	 * \param keep true to enable
+	 *
+	 */
+	void setKeepSubdomains(bool keep)
+	{
+		keep_sub = keep;
+	}
 
-		domain_nn_calculator_cart<dim>::reset();
-		domain_nn_calculator_cart<dim>::setParameters(proc_box);
+	/*! \brief Set the algorithm used to merge the sub-sub-domains into sub-domains
+	 *
+	 * It must be called before decompose (default dec_merge::WAVEFRONT)
+	 *
+	 * \param mt merging algorithm
+	 *
+	 */
+	void setSubdomainMerging(dec_merge mt)
+	{
+		merge_type = mt;
 	}
 
 	/*! \brief Refine the decomposition, available only for ParMetis distribution, for Metis it is a null call
@@ -1581,6 +1768,46 @@ public:
 		return sub_domains.size();
 	}
 
+	/*! \brief Get the surface of the local sub-domains in sub-sub-domain units
+	 *
+	 * It is proportional to the volume of ghost produced by the sub-domains
+	 *
+	 * \return the surface of the local sub-domains
+	 *
+	 */
+	size_t getSubdomainsSurface()
+	{
+		return dec_optimizer<dim, Graph_CSR<nm_v<dim>, nm_e>>::surface(loc_boxes);
+	}
+
+	/*! \brief Print the statistic of the sub-domains across processors
+	 *
+	 * It print on processor 0 the minimum, maximum and total number of sub-domains per processor, and the
+	 * total surface of the sub-domains
+	 *
+	 * \note It is collective
+	 *
+	 */
+	void printSubdomainsStat()
+	{
+		size_t n_min = getNSubDomain();
+		size_t n_max = n_min;
+		size_t n_tot = n_min;
+		size_t surf = getSubdomainsSurface();
+
+		v_cl.min(n_min);
+		v_cl.max(n_max);
+		v_cl.sum(n_tot);
+		v_cl.sum(surf);
+		v_cl.execute();
+
+		if (v_cl.getProcessUnitID() == 0)
+		{
+			std::cout << "Sub-domains per processor: min " << n_min << " max " << n_max << " avg " << (double)n_tot / v_cl.getProcessingUnits()
+			          << " total " << n_tot << " surface " << surf << std::endl;
+		}
+	}
+
 	/*! \brief Get the local sub-domain
 	 *
 	 * \param lc (each local processor can have more than one sub-domain)
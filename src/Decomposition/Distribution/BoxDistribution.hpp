@@ -14,6 +14,7 @@
 #include "Graph/map_graph.hpp"
 #include "Graph/CartesianGraphFactory.hpp"
 #include "VTKWriter/VTKWriter.hpp"
+#include "topology_map.hpp"
 
 #define BOX_DISTRIBUTION_ERROR_OBJECT std::runtime_error("Box distribution runtime error");
 
@@ -71,6 +72,9 @@ class BoxDistribution
 
         openfpm::vector<int> subsub_own;
 
+	//! Map the parts to the processors taking into account the nodes
+	topology_map topo;
+
 	/*! \brief Check that the sub-sub-domain id exist
 	 *
 	 * \param id sub-sub-domain id
@@ -262,11 +266,18 @@ public:
 
                     gp.vertex(i).template get<nm_v_proc_id>() = gr_proc.LinId(key_prc);
 
-                    if (gp.vertex(i).template get<nm_v_proc_id>() == v_cl.rank())
-                    {subsub_own.add(i);}
-
                     ++it;
                 }
+
+		// group on the same node the parts that communicate the most
+		topo.init(v_cl);
+		topo.remap(gp,v_cl);
+
+		for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+		{
+			if (gp.vertex(i).template get<nm_v_proc_id>() == v_cl.rank())
+			{subsub_own.add(i);}
+		}
 	}
 
 	/*! \brief Refine current decomposition
@@ -523,6 +534,7 @@ public:
 		this->domain = mt.domain;
 		this->gp = mt.gp;
 		this->subsub_own = mt.subsub_own;
+		this->topo = mt.topo;
 		return *this;
 	}
 
@@ -543,6 +555,7 @@ public:
 		this->domain = mt.domain;
 		this->gp.swap(mt.gp);
 		this->subsub_own.swap(mt.subsub_own);
+		this->topo = mt.topo;
 		return *this;
 	}
 
@@ -570,6 +583,16 @@ public:
 		return ret;
 	}
 
+	/*! \brief Enable or disable the topology aware mapping of the parts to the processors (default disabled)
+	 *
+	 * \param act true to enable
+	 *
+	 */
+	void setTopologyMapping(bool act)
+	{
+		topo.setActive(act);
+	}
+
 	/*! \brief Set the tolerance for each partition
 	 *
 	 * \param tol tolerance
@@ -482,6 +482,92 @@ BOOST_AUTO_TEST_CASE( Box_distribution_test)
 //	BOOST_REQUIRE_EQUAL(sizeof(ParMetisDistribution<3,float>),872ul);
 }
 
+BOOST_AUTO_TEST_CASE( topology_map_test)
+{
+	// 16x4 sub-sub-domains divided in 4 slabs along x, the part i is the slab i
+	size_t sz[2] = {16,4};
+	size_t bc[2] = {NON_PERIODIC,NON_PERIODIC};
+	Box<2, float> box( { 0.0, 0.0 }, { 1.0, 1.0 });
+	grid_sm<2, void> info(sz);
+
+	CartesianGraphFactory<2, Graph_CSR<nm_v<2>, nm_e>> g_factory;
+	Graph_CSR<nm_v<2>, nm_e> gp = g_factory.template construct<NO_EDGE, nm_v_id, float, 1, 0>(info.getSize(), box, bc);
+
+	grid_key_dx_iterator<2> it(info);
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+		size_t i = info.LinId(key);
+
+		gp.template vertex_p<nm_v_proc_id>(i) = key.get(0) / 4;
+
+		for (size_t s = 0 ; s < gp.getNChilds(i) ; s++)
+		{gp.getChildEdge(i,s).template get<nm_e::communication>() = 1;}
+
+		++it;
+	}
+
+	// The processors are placed round-robin on two nodes 0,2 on node 0 and 1,3 on node 1
+	openfpm::vector<size_t> nor;
+	nor.add(0);
+	nor.add(1);
+	nor.add(0);
+	nor.add(1);
+
+	// count the edges across nodes
+	auto cut = [&]()
+	{
+		size_t n_cut = 0;
+
+		for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+		{
+			for (size_t s = 0 ; s < gp.getNChilds(i) ; s++)
+			{
+				size_t p = gp.template vertex_p<nm_v_proc_id>(i);
+				size_t q = gp.template vertex_p<nm_v_proc_id>(gp.getChild(i,s));
+
+				n_cut += (nor.get(p) != nor.get(q));
+			}
+		}
+
+		return n_cut;
+	};
+
+	size_t cut_before = cut();
+
+	topology_map topo;
+	BOOST_REQUIRE_EQUAL(topo.isActive(),false);
+	topo.setActive(true);
+	topo.setNodes(nor);
+	topo.remap(gp);
+
+	// The slabs 0,1 are on node 0 and the slabs 2,3 on node 1, only one interface cross the nodes
+	BOOST_REQUIRE_EQUAL(cut_before,3*2*4ul);
+	BOOST_REQUIRE_EQUAL(cut(),2*4ul);
+
+	// the load of each processor does not change
+	openfpm::vector<size_t> load;
+	load.resize(4);
+
+	for (size_t i = 0 ; i < load.size() ; i++)
+	{load.get(i) = 0;}
+
+	for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+	{load.get(gp.template vertex_p<nm_v_proc_id>(i)) += 1;}
+
+	for (size_t i = 0 ; i < load.size() ; i++)
+	{BOOST_REQUIRE_EQUAL(load.get(i),16ul);}
+
+	// on a single node the mapping is the identity
+	nor.get(1) = 0;
+	nor.get(3) = 0;
+
+	openfpm::vector<size_t> perm;
+	topo.setNodes(nor);
+	BOOST_REQUIRE_EQUAL(topo.getPermutation(gp,perm),false);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif /* SRC_DECOMPOSITION_DISTRIBUTION_DISTRIBUTION_UNIT_TESTS_HPP_ */
@@ -10,6 +10,7 @@
 
 #include "SubdomainGraphNodes.hpp"
 #include "metis_util.hpp"
+#include "topology_map.hpp"
 
 #define METIS_DISTRIBUTION_ERROR_OBJECT std::runtime_error("Metis runtime error");
 
@@ -70,6 +71,9 @@ class MetisDistribution
 	//! received assignment
 	openfpm::vector<met_sub_w> recv_ass;
 
+	//! Map the parts to the processors taking into account the nodes
+	topology_map topo;
+
 	/*! \brief Check that the sub-sub-domain id exist
 	 *
 	 * \param id sub-sub-domain id
@@ -220,6 +224,9 @@ public:
 			check_valid(this,8);
 #endif
 
+		// Discover the nodes
+		topo.init(v_cl);
+
 		// Gather the sub-domain weight in one processor
 		recv_ass.clear();
 		v_cl.SGather(owner_cost_sub,recv_ass,0);
@@ -241,6 +248,9 @@ public:
 			// decompose
 			metis_graph.template decompose<nm_v_proc_id>();
 
+			// group on the same node the parts that communicate the most
+			topo.remap(gp);
+
 			if (recv_ass.size() != 0)
 			{
 				// we fill the assignment
@@ -576,6 +586,7 @@ public:
 		this->gp = mt.gp;
 		this->owner_cost_sub = mt.owner_cost_sub;
 		this->owner_scs = mt.owner_scs;
+		this->topo = mt.topo;
 		return *this;
 	}
 
@@ -597,6 +608,7 @@ public:
 		this->gp.swap(mt.gp);
 		this->owner_cost_sub.swap(mt.owner_cost_sub);
 		this->owner_scs.swap(mt.owner_scs);
+		this->topo = mt.topo;
 		return *this;
 	}
 
@@ -622,6 +634,16 @@ public:
 		return ret;
 	}
 
+	/*! \brief Enable or disable the topology aware mapping of the parts to the processors (default disabled)
+	 *
+	 * \param act true to enable
+	 *
+	 */
+	void setTopologyMapping(bool act)
+	{
+		topo.setActive(act);
+	}
+
 	/*! \brief Set the tolerance for each partition
 	 *
 	 * \param tol tolerance
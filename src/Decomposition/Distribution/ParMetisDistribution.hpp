@@ -12,6 +12,7 @@
 
 #include "SubdomainGraphNodes.hpp"
 #include "parmetis_util.hpp"
+#include "topology_map.hpp"
 #include "Graph/ids.hpp"
 #include "Graph/CartesianGraphFactory.hpp"
 
@@ -85,6 +86,9 @@ class ParMetisDistribution
 	//! Flag to check if weights are used on vertices
 	bool verticesGotWeights = false;
 
+	//! Map the parts to the processors taking into account the nodes
+	topology_map topo;
+
 	/*! \brief Update main graph ad subgraph with the received data of the partitions from the other processors
 	 *
 	 */
@@ -222,11 +226,42 @@ class ParMetisDistribution
 		return &(v->get(i).get(0));
 	}
 
+	/*! \brief Permute the parts so that heavily communicating parts are on the same node
+	 *
+	 * partitions must contain the partition of all the processors
+	 *
+	 */
+	void topologyRemap()
+	{
+		size_t Np = v_cl.getProcessingUnits();
+
+		// Set the new partition in the graph to calculate the communication across parts
+		for (size_t i = 0; i < Np; i++)
+		{
+			size_t k = 0;
+
+			for (rid l = vtxdist.get(i); k < partitions.get(i).size() && l < vtxdist.get(i + 1); k++, ++l)
+			{gp.template vertex_p<nm_v_proc_id>(m2g.find(l)->second.id) = partitions.get(i).get(k);}
+		}
+
+		openfpm::vector<size_t> perm;
+
+		if (topo.getPermutation(gp,perm,v_cl) == false)
+		{return;}
+
+		for (size_t i = 0; i < Np; i++)
+		{
+			for (size_t k = 0 ; k < partitions.get(i).size() ; k++)
+			{partitions.get(i).get(k) = perm.get(partitions.get(i).get(k));}
+		}
+	}
+
 	/*! \brief It update the full decomposition
 	 *
+	 * \param remap if true the parts are mapped to the processors taking into account the nodes
 	 *
 	 */
-	void postDecomposition()
+	void postDecomposition(bool remap = false)
 	{
 		//! Get the processor id
 		size_t p_id = v_cl.getProcessUnitID();
@@ -273,6 +308,9 @@ class ParMetisDistribution
 		else
 			v_cl.sendrecvMultipleMessagesNBX(prc.size(), &sz.get(0), &prc.get(0), &ptr.get(0), message_receive, &partitions,NONE);
 
+		if (remap == true)
+		{topologyRemap();}
+
 		// Update graphs with the received data
 		updateGraphs();
 	}
@@ -385,8 +423,12 @@ public:
 		//! Decompose
 		parmetis_graph.decompose(vtxdist);
 
-		// update after decomposition
-		postDecomposition();
+		// Discover the nodes
+		topo.init(v_cl);
+
+		// update after decomposition, refine and redecompose keep the mapping to
+		// avoid to migrate everything
+		postDecomposition(true);
 
 		is_distributed = true;
 	}
@@ -658,6 +700,7 @@ public:
 		sub_sub_owner = dist.sub_sub_owner;
 		m2g = dist.m2g;
 		parmetis_graph = dist.parmetis_graph;
+		topo = dist.topo;
 
 		return *this;
 	}
@@ -675,6 +718,7 @@ public:
 		sub_sub_owner.swap(dist.sub_sub_owner);
 		m2g.swap(dist.m2g);
 		parmetis_graph = dist.parmetis_graph;
+		topo = dist.topo;
 
 		return *this;
 	}
@@ -701,6 +745,16 @@ public:
 		return parmetis_graph.get_ndec();
 	}
 
+	/*! \brief Enable or disable the topology aware mapping of the parts to the processors (default disabled)
+	 *
+	 * \param act true to enable
+	 *
+	 */
+	void setTopologyMapping(bool act)
+	{
+		topo.setActive(act);
+	}
+
 	/*! \brief Set the tolerance for each partition
 	 *
 	 * \param tol tolerance
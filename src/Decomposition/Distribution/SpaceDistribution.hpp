@@ -11,6 +11,7 @@
 #include "util/mathutil.hpp"
 #include "NN/CellList/CellDecomposer.hpp"
 #include "Grid/grid_key_dx_iterator_hilbert.hpp"
+#include "topology_map.hpp"
 
 /*! \brief Class that distribute sub-sub-domains across processors using an hilbert curve
  *         to divide the space
@@ -35,6 +36,8 @@ class SpaceDistribution
 	//! Global sub-sub-domain graph
 	Graph_CSR<nm_v<dim>, nm_e> gp;
 
+	//! Map the parts to the processors taking into account the nodes
+	topology_map topo;
 
 public:
 
@@ -217,6 +220,10 @@ public:
 			++it2;
 		}
 
+		// group on the same node the parts that communicate the most
+		topo.init(v_cl);
+		topo.remap(gp,v_cl);
+
 		return;
 	}
 
@@ -366,6 +373,7 @@ public:
 		gr = dist.gr;
 		domain = dist.domain;
 		gp = dist.gp;
+		topo = dist.topo;
 
 		return *this;
 	}
@@ -376,10 +384,21 @@ public:
 		gr = dist.gr;
 		domain = dist.domain;
 		gp.swap(dist.gp);
+		topo = dist.topo;
 
 		return *this;
 	}
 
+	/*! \brief Enable or disable the topology aware mapping of the parts to the processors (default disabled)
+	 *
+	 * \param act true to enable
+	 *
+	 */
+	void setTopologyMapping(bool act)
+	{
+		topo.setActive(act);
+	}
+
 	/*! \brief It return the decomposition id
 	 *
 	 * It just return 0
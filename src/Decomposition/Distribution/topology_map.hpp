@@ -0,0 +1,354 @@
+/*
+ * topology_map.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef SRC_DECOMPOSITION_DISTRIBUTION_TOPOLOGY_MAP_HPP_
+#define SRC_DECOMPOSITION_DISTRIBUTION_TOPOLOGY_MAP_HPP_
+
+#include <mpi.h>
+#include <unordered_map>
+#include <queue>
+#include "Vector/map_vector.hpp"
+#include "SubdomainGraphNodes.hpp"
+
+/*! \brief Map the parts produced by a distribution to the processors taking into account the nodes
+ *
+ * The distributions assign the part i to the processor i. Processors on different nodes communicate
+ * through the network, so it is convenient that parts that communicate a lot are assigned to processors
+ * on the same node. After the partitioning this class calculate a permutation of the parts that group
+ * heavily communicating parts on the same node. The permutation does not change the load of the parts
+ * so the balance is unchanged.
+ *
+ * The nodes are discovered with MPI_Comm_split_type, on a single node the mapping is the identity.
+ * The mapping is disabled by default, it is enabled with setActive(true)
+ *
+ */
+class topology_map
+{
+	//! For each processor the node id (the smallest rank on the node)
+	openfpm::vector<size_t> node_of_rank;
+
+	//! Enable the topology mapping
+	bool active = false;
+
+	/*! \brief Calculate the communication between parts
+	 *
+	 * \param gp sub-sub-domain graph with the part assigned in nm_v_proc_id
+	 * \param Np number of parts
+	 * \param comm for each part the communication with the other parts
+	 *
+	 */
+	template<typename Graph>
+	static void part_communication(Graph & gp, size_t Np, std::vector<std::unordered_map<size_t,size_t>> & comm)
+	{
+		comm.clear();
+		comm.resize(Np);
+
+		for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+		{
+			size_t p = gp.template vertex_p<nm_v_proc_id>(i);
+
+			for (size_t s = 0 ; s < gp.getNChilds(i) ; s++)
+			{
+				size_t q = gp.template vertex_p<nm_v_proc_id>(gp.getChild(i,s));
+
+				if (p == q)
+				{continue;}
+
+				// if communication cost are not set every edge count as one
+				size_t w = gp.getChildEdge(i,s).template get<nm_e::communication>();
+				comm[p][q] += (w == 0)?1:w;
+			}
+		}
+	}
+
+	/*! \brief Group the processors by node
+	 *
+	 * \param node_prc for each node the processors on it
+	 *
+	 */
+	void group_nodes(openfpm::vector<openfpm::vector<size_t>> & node_prc) const
+	{
+		std::unordered_map<size_t,size_t> node_id;
+		node_prc.clear();
+
+		for (size_t i = 0 ; i < node_of_rank.size() ; i++)
+		{
+			auto fnd = node_id.find(node_of_rank.get(i));
+
+			if (fnd == node_id.end())
+			{
+				node_id[node_of_rank.get(i)] = node_prc.size();
+				node_prc.add();
+				node_prc.last().add(i);
+			}
+			else
+			{node_prc.get(fnd->second).add(i);}
+		}
+	}
+
+	/*! \brief Calculate the permutation from parts to processors
+	 *
+	 * The nodes are filled one by one. Every node start from the unassigned part with the smallest id
+	 * (partitioners tend to give close ids to close parts), and it is filled greedily with the unassigned
+	 * part that communicate the most with the parts already on the node (ties go to the smallest id).
+	 * The parts of a node are assigned to the processors of the node in increasing order.
+	 *
+	 * The part with the biggest gain is taken from a heap, outdated entries are skipped when popped,
+	 * so the cost is O(E log E) with E the number of communicating pairs of parts
+	 *
+	 * \param gp sub-sub-domain graph with the part assigned in nm_v_proc_id
+	 * \param node_prc for each node the processors on it
+	 * \param perm for each part the processor
+	 *
+	 */
+	template<typename Graph>
+	void calculate_permutation(Graph & gp, const openfpm::vector<openfpm::vector<size_t>> & node_prc, openfpm::vector<size_t> & perm)
+	{
+		size_t Np = node_of_rank.size();
+
+		std::vector<std::unordered_map<size_t,size_t>> comm;
+		part_communication(gp,Np,comm);
+
+		openfpm::vector<unsigned char> assigned;
+		openfpm::vector<size_t> gain;
+		openfpm::vector<size_t> touched;
+		assigned.resize(Np);
+		gain.resize(Np);
+		perm.resize(Np);
+
+		for (size_t i = 0 ; i < Np ; i++)
+		{
+			assigned.get(i) = 0;
+			gain.get(i) = 0;
+		}
+
+		// (gain,part) the biggest gain first, on equal gain the smallest part
+		auto cmp = [](const std::pair<size_t,size_t> & a, const std::pair<size_t,size_t> & b)
+		{return a.first < b.first || (a.first == b.first && a.second > b.second);};
+
+		size_t seed = 0;
+
+		for (size_t n = 0 ; n < node_prc.size() ; n++)
+		{
+			std::priority_queue<std::pair<size_t,size_t>,std::vector<std::pair<size_t,size_t>>,decltype(cmp)> heap(cmp);
+
+			for (size_t k = 0 ; k < node_prc.get(n).size() ; k++)
+			{
+				// discard the parts already assigned and the outdated gains
+				while (heap.size() != 0 && (assigned.get(heap.top().second) == 1 || gain.get(heap.top().second) != heap.top().first))
+				{heap.pop();}
+
+				size_t p;
+
+				if (heap.size() != 0)
+				{p = heap.top().second;}
+				else
+				{
+					// nothing communicate with the node, take the unassigned part with the smallest id
+					while (assigned.get(seed) == 1)
+					{seed++;}
+
+					p = seed;
+				}
+
+				assigned.get(p) = 1;
+				perm.get(p) = node_prc.get(n).get(k);
+
+				for (auto & c : comm[p])
+				{
+					if (assigned.get(c.first) == 1)
+					{continue;}
+
+					if (gain.get(c.first) == 0)
+					{touched.add(c.first);}
+
+					gain.get(c.first) += c.second;
+					heap.push(std::make_pair(gain.get(c.first),c.first));
+				}
+			}
+
+			// the gains are relative to the node
+			for (size_t i = 0 ; i < touched.size() ; i++)
+			{gain.get(touched.get(i)) = 0;}
+			touched.clear();
+		}
+	}
+
+	/*! \brief Relabel the parts in the graph
+	 *
+	 * \param gp sub-sub-domain graph with the part assigned in nm_v_proc_id
+	 * \param perm for each part the processor
+	 *
+	 */
+	template<typename Graph>
+	static void apply(Graph & gp, const openfpm::vector<size_t> & perm)
+	{
+		for (size_t i = 0 ; i < gp.getNVertex() ; i++)
+		{gp.template vertex_p<nm_v_proc_id>(i) = perm.get(gp.template vertex_p<nm_v_proc_id>(i));}
+	}
+
+public:
+
+	/*! \brief Enable or disable the topology mapping (default disabled)
+	 *
+	 * \param act true to enable
+	 *
+	 */
+	void setActive(bool act)
+	{
+		active = act;
+	}
+
+	/*! \brief Return true if the topology mapping is enabled
+	 *
+	 * \return true if enabled
+	 *
+	 */
+	bool isActive() const
+	{
+		return active;
+	}
+
+	/*! \brief Discover on which node each processor run
+	 *
+	 * \note It is collective on MPI_COMM_WORLD, it does nothing if already done
+	 *
+	 * \param v_cl Vcluster
+	 *
+	 */
+	void init(Vcluster<> & v_cl)
+	{
+		if (active == false || node_of_rank.size() == v_cl.size())
+		{return;}
+
+		MPI_Comm node_comm;
+		MPI_Comm_split_type(MPI_COMM_WORLD,MPI_COMM_TYPE_SHARED,v_cl.rank(),MPI_INFO_NULL,&node_comm);
+
+		// the node is identified by the smallest rank on it
+		int rank = v_cl.rank();
+		int node_id;
+		MPI_Allreduce(&rank,&node_id,1,MPI_INT,MPI_MIN,node_comm);
+		MPI_Comm_free(&node_comm);
+
+		openfpm::vector<int> nodes;
+		nodes.resize(v_cl.size());
+		MPI_Allgather(&node_id,1,MPI_INT,&nodes.get(0),1,MPI_INT,MPI_COMM_WORLD);
+
+		node_of_rank.resize(v_cl.size());
+		for (size_t i = 0 ; i < nodes.size() ; i++)
+		{node_of_rank.get(i) = nodes.get(i);}
+	}
+
+	/*! \brief Set the node of each processor
+	 *
+	 * It is used for testing, in general init discover it
+	 *
+	 * \param nor for each processor the node id
+	 *
+	 */
+	void setNodes(const openfpm::vector<size_t> & nor)
+	{
+		node_of_rank = nor;
+	}
+
+	/*! \brief Calculate the permutation from parts to processors on this processor
+	 *
+	 * \see calculate_permutation
+	 *
+	 * \param gp sub-sub-domain graph with the part assigned in nm_v_proc_id
+	 * \param perm for each part the processor
+	 *
+	 * \return false if the mapping is the identity (single node or disabled)
+	 *
+	 */
+	template<typename Graph>
+	bool getPermutation(Graph & gp, openfpm::vector<size_t> & perm)
+	{
+		openfpm::vector<openfpm::vector<size_t>> node_prc;
+		group_nodes(node_prc);
+
+		if (active == false || node_prc.size() <= 1)
+		{return false;}
+
+		calculate_permutation(gp,node_prc,perm);
+
+		return true;
+	}
+
+	/*! \brief Calculate the permutation from parts to processors
+	 *
+	 * The permutation is calculated by the processor 0 and broadcasted, so all the processors
+	 * get the same mapping
+	 *
+	 * \note It is collective when the mapping is not the identity
+	 *
+	 * \see calculate_permutation
+	 *
+	 * \param gp sub-sub-domain graph with the part assigned in nm_v_proc_id (it must be valid on processor 0)
+	 * \param perm for each part the processor
+	 * \param v_cl Vcluster
+	 *
+	 * \return false if the mapping is the identity (single node or disabled)
+	 *
+	 */
+	template<typename Graph>
+	bool getPermutation(Graph & gp, openfpm::vector<size_t> & perm, Vcluster<> & v_cl)
+	{
+		openfpm::vector<openfpm::vector<size_t>> node_prc;
+		group_nodes(node_prc);
+
+		if (active == false || node_prc.size() <= 1)
+		{return false;}
+
+		if (v_cl.rank() == 0)
+		{calculate_permutation(gp,node_prc,perm);}
+
+		perm.resize(node_of_rank.size());
+
+		v_cl.Bcast(perm,0);
+		v_cl.execute();
+
+		return true;
+	}
+
+	/*! \brief Apply the topology mapping to the parts assigned in the graph
+	 *
+	 * \param gp sub-sub-domain graph with the part assigned in nm_v_proc_id
+	 *
+	 */
+	template<typename Graph>
+	void remap(Graph & gp)
+	{
+		openfpm::vector<size_t> perm;
+
+		if (getPermutation(gp,perm) == false)
+		{return;}
+
+		apply(gp,perm);
+	}
+
+	/*! \brief Apply the topology mapping to the parts assigned in the graph
+	 *
+	 * The permutation is calculated by the processor 0 and broadcasted
+	 *
+	 * \param gp sub-sub-domain graph with the part assigned in nm_v_proc_id
+	 * \param v_cl Vcluster
+	 *
+	 */
+	template<typename Graph>
+	void remap(Graph & gp, Vcluster<> & v_cl)
+	{
+		openfpm::vector<size_t> perm;
+
+		if (getPermutation(gp,perm,v_cl) == false)
+		{return;}
+
+		apply(gp,perm);
+	}
+};
+
+#endif /* SRC_DECOMPOSITION_DISTRIBUTION_TOPOLOGY_MAP_HPP_ */
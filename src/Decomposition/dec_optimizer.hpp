@@ -46,6 +46,19 @@ struct is_typedef_and_data_same<true,wavefront<dim>>
  *
  */
 
+/*! \brief Algorithm used to merge the sub-sub-domains into sub-domains
+ *
+ * * WAVEFRONT expand the boxes from seed points with wavefronts (default)
+ * * MAX_BOX take greedily the biggest boxes and merge the boxes that share a full face, it
+ *   produce less boxes and less ghost surface on irregular partitions
+ *
+ */
+enum class dec_merge
+{
+	WAVEFRONT,
+	MAX_BOX
+};
+
 template <unsigned int dim, typename Graph>
 class dec_optimizer
 {
@@ -602,8 +615,230 @@ private:
 		}
 	}
 
+	/*! \brief Check if all the sub-sub-domains of a box belong to the processor and are not assigned
+	 *
+	 * \param graph graph
+	 * \param box box to check
+	 * \param pr_id processor id
+	 *
+	 * \return true if the box can be taken
+	 *
+	 */
+	template<unsigned int p_sub, unsigned int p_id> bool can_take(Graph & graph, const Box<dim,long int> & box, long int pr_id)
+	{
+		for (size_t i = 0 ; i < dim ; i++)
+		{
+			if (box.getLow(i) < 0 || box.getHigh(i) >= (long int)gh.size(i))
+			{return false;}
+		}
+
+		grid_key_dx<dim> k1 = box.getKP1();
+		grid_key_dx<dim> k2 = box.getKP2();
+
+		grid_key_dx_iterator_sub<dim> g_sub(gh,k1,k2);
+
+		while (g_sub.isNext())
+		{
+			size_t v = gh.LinId(g_sub.get());
+
+			if ((long int)graph.vertex(v).template get<p_id>() != pr_id || graph.vertex(v).template get<p_sub>() != -1)
+			{return false;}
+
+			++g_sub;
+		}
+
+		return true;
+	}
+
+	/*! \brief Grow a box from a seed sub-sub-domain
+	 *
+	 * For rot < dim the box is extended as much as possible along one direction at time starting
+	 * from the direction rot, for rot == dim the box is extended by one layer in all the directions
+	 * in turn until it cannot grow anymore
+	 *
+	 * \param graph graph
+	 * \param seed seed sub-sub-domain
+	 * \param pr_id processor id
+	 * \param rot growing strategy
+	 *
+	 * \return the box
+	 *
+	 */
+	template<unsigned int p_sub, unsigned int p_id> Box<dim,long int> grow_box(Graph & graph, const grid_key_dx<dim> & seed, long int pr_id, size_t rot)
+	{
+		Box<dim,long int> box;
+
+		for (size_t i = 0 ; i < dim ; i++)
+		{
+			box.setLow(i,seed.get(i));
+			box.setHigh(i,seed.get(i));
+		}
+
+		// try to add one layer of sub-sub-domains on one side of the box
+		auto extend = [&](size_t d, bool positive)
+		{
+			Box<dim,long int> slab = box;
+
+			if (positive == true)
+			{slab.setLow(d,box.getHigh(d)+1); slab.setHigh(d,box.getHigh(d)+1);}
+			else
+			{slab.setLow(d,box.getLow(d)-1); slab.setHigh(d,box.getLow(d)-1);}
+
+			if (can_take<p_sub,p_id>(graph,slab,pr_id) == false)
+			{return false;}
+
+			if (positive == true)
+			{box.setHigh(d,box.getHigh(d)+1);}
+			else
+			{box.setLow(d,box.getLow(d)-1);}
+
+			return true;
+		};
+
+		if (rot < dim)
+		{
+			for (size_t r = 0 ; r < dim ; r++)
+			{
+				size_t d = (rot + r) % dim;
+
+				while (extend(d,true) == true) {}
+				while (extend(d,false) == true) {}
+			}
+		}
+		else
+		{
+			bool grown = true;
+
+			while (grown == true)
+			{
+				grown = false;
+
+				for (size_t d = 0 ; d < dim ; d++)
+				{
+					grown |= extend(d,true);
+					grown |= extend(d,false);
+				}
+			}
+		}
+
+		return box;
+	}
+
+	/*! \brief Surface of a box in sub-sub-domain units
+	 *
+	 * \param box box (extremes included)
+	 *
+	 * \return the surface
+	 *
+	 */
+	template<typename T> static size_t box_surface(const Box<dim,T> & box)
+	{
+		size_t surf = 0;
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			size_t face = 1;
+			for (size_t e = 0 ; e < dim ; e++)
+			{
+				if (e != d)
+				{face *= box.getHigh(e) - box.getLow(e) + 1;}
+			}
+
+			surf += 2*face;
+		}
+
+		return surf;
+	}
+
+	/*! \brief Convert a box into sub-sub-domain coordinates
+	 *
+	 * \param box box to convert
+	 *
+	 * \return the converted box
+	 *
+	 */
+	static Box<dim,size_t> to_sub_box(const Box<dim,long int> & box)
+	{
+		Box<dim,size_t> sbox;
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			sbox.setLow(d,box.getLow(d));
+			sbox.setHigh(d,box.getHigh(d));
+		}
+
+		return sbox;
+	}
+
+	/*! \brief Merge the boxes that share a full face
+	 *
+	 * \param boxes boxes to merge
+	 *
+	 */
+	void merge_boxes(openfpm::vector<Box<dim,long int>> & boxes)
+	{
+		bool merged = true;
+
+		while (merged == true)
+		{
+			merged = false;
+
+			for (size_t i = 0 ; i < boxes.size() && merged == false ; i++)
+			{
+				for (size_t j = i + 1 ; j < boxes.size() && merged == false ; j++)
+				{
+					Box<dim,long int> & a = boxes.get(i);
+					Box<dim,long int> & b = boxes.get(j);
+
+					for (size_t d = 0 ; d < dim ; d++)
+					{
+						bool same = true;
+						for (size_t e = 0 ; e < dim ; e++)
+						{
+							if (e != d && (a.getLow(e) != b.getLow(e) || a.getHigh(e) != b.getHigh(e)))
+							{same = false;}
+						}
+
+						if (same == false)
+						{continue;}
+
+						if (a.getHigh(d) + 1 == b.getLow(d) || b.getHigh(d) + 1 == a.getLow(d))
+						{
+							a.setLow(d,std::min(a.getLow(d),b.getLow(d)));
+							a.setHigh(d,std::max(a.getHigh(d),b.getHigh(d)));
+
+							boxes.remove(j);
+							merged = true;
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
 public:
 
+	/*! \brief Return the surface of a set of boxes
+	 *
+	 * It is the surface of the sub-domains in sub-sub-domain units, proportional to the
+	 * ghost volume
+	 *
+	 * \param loc_boxes boxes
+	 *
+	 * \return the total surface
+	 *
+	 */
+	static size_t surface(const openfpm::vector<Box<dim,size_t>> & loc_boxes)
+	{
+		size_t surf = 0;
+
+		for (size_t i = 0 ; i < loc_boxes.size() ; i++)
+		{surf += box_surface(loc_boxes.get(i));}
+
+		return surf;
+	}
+
 	/*! \brief Constructor
 	 *
 	 * \param g Graph to simplify
@@ -696,6 +931,119 @@ public:
 		// Construct box box_nn_processor from the constructed domain
 		construct_box_nn_processor<p_id>(graph,box_nn_processor,loc_boxes,ghe,bc,pr_id);
 	}
+
+	/*! \brief optimize the graph taking greedily the biggest boxes
+	 *
+	 * At every step, from every corner sub-sub-domain of the processor not yet covered, boxes are grown with different
+	 * strategies and the biggest (with the smallest surface on tie) is taken. At the end the
+	 * boxes that share a full face are merged. Compared to the wavefront expansion it produce less and
+	 * fatter sub-domains on irregular partitions, so less ghost boxes and less ghost surface
+	 *
+	 * \tparam p_id property containing the decomposition
+	 * \tparam p_sub property to fill with the sub-domain decomposition
+	 *
+	 * \param graph we are processing
+	 * \param pr_id Processor id
+	 * \param loc_boxes list of sub-domain boxes
+	 * \param box_nn_processor for each sub-domain it list all the neighborhood processors
+	 * \param ghe ghost size
+	 * \param bc boundary conditions
+	 *
+	 */
+	template <unsigned int p_sub, unsigned int p_id> void optimize_max_box(Graph & graph, long int pr_id, openfpm::vector<Box<dim,size_t>> & loc_boxes, openfpm::vector< openfpm::vector<size_t> > & box_nn_processor, const Ghost<dim,long int> & ghe, const size_t (& bc)[dim])
+	{
+		// the sub-sub-domains of the processor, the boxes are searched only on them
+		openfpm::vector<grid_key_dx<dim>> own;
+
+		grid_key_dx_iterator<dim> g_it(gh);
+
+		while (g_it.isNext())
+		{
+			size_t v = gh.LinId(g_it.get());
+
+			graph.vertex(v).template get<p_sub>() = -1;
+
+			if ((long int)graph.vertex(v).template get<p_id>() == pr_id)
+			{own.add(g_it.get());}
+
+			++g_it;
+		}
+
+		openfpm::vector<Box<dim,long int>> boxes;
+
+		while (own.size() != 0)
+		{
+			Box<dim,long int> best;
+			size_t best_vol = 0;
+			size_t best_surf = 0;
+
+			for (size_t k = 0 ; k < own.size() ; k++)
+			{
+				grid_key_dx<dim> gk = own.get(k);
+
+				// only corners can be the low corner of a maximal box
+				bool corner = false;
+				for (size_t d = 0 ; d < dim ; d++)
+				{
+					Box<dim,long int> nb;
+					for (size_t e = 0 ; e < dim ; e++)
+					{nb.setLow(e,gk.get(e)); nb.setHigh(e,gk.get(e));}
+					nb.setLow(d,gk.get(d)-1); nb.setHigh(d,gk.get(d)-1);
+
+					corner |= !can_take<p_sub,p_id>(graph,nb,pr_id);
+				}
+
+				if (corner == false)
+				{continue;}
+
+				for (size_t rot = 0 ; rot <= dim ; rot++)
+				{
+					Box<dim,long int> box = grow_box<p_sub,p_id>(graph,gk,pr_id,rot);
+
+					size_t vol = 1;
+					for (size_t d = 0 ; d < dim ; d++)
+					{vol *= box.getHigh(d) - box.getLow(d) + 1;}
+
+					size_t surf = box_surface(box);
+
+					if (vol > best_vol || (vol == best_vol && surf < best_surf))
+					{
+						best = box;
+						best_vol = vol;
+						best_surf = surf;
+					}
+				}
+			}
+
+			if (best_vol == 0)
+			{break;}
+
+			boxes.add(best);
+			fill_domain<p_sub>(graph,to_sub_box(best),boxes.size()-1);
+
+			// remove the covered sub-sub-domains
+			size_t n_own = 0;
+			for (size_t k = 0 ; k < own.size() ; k++)
+			{
+				if (graph.vertex(gh.LinId(own.get(k))).template get<p_sub>() == -1)
+				{own.get(n_own++) = own.get(k);}
+			}
+
+			own.resize(n_own);
+		}
+
+		merge_boxes(boxes);
+
+		// enumerate the final sub-domains
+		for (size_t i = 0 ; i < boxes.size() ; i++)
+		{
+			loc_boxes.add(to_sub_box(boxes.get(i)));
+			fill_domain<p_sub>(graph,loc_boxes.last(),i);
+		}
+
+		// Construct box box_nn_processor from the constructed domain
+		construct_box_nn_processor<p_id>(graph,box_nn_processor,loc_boxes,ghe,bc,pr_id);
+	}
 };
 
 #endif
@@ -9,6 +9,7 @@
 #define SRC_DECOMPOSITION_NN_PROCESSOR_HPP_
 
 #include "common.hpp"
+#include "util/neighbor_exchange.hpp"
 #include <unordered_map>
 
 /*! \brief This class store the adjacent processors and the adjacent sub_domains
@@ -28,6 +29,12 @@ class nn_prcs
 	//! List of adjacent processors
 	openfpm::vector<size_t> nn_processors;
 
+	//! List of the processors that have the local processor as adjacent processor
+	openfpm::vector<size_t> nn_sources;
+
+	//! Neighborhood collectives with the processors in nn_processors and nn_sources
+	neighbor_exchange nn_ex;
+
 	//! for each near processor store the sub-domains of the near processors
 	std::unordered_map<size_t, N_box<dim,T>> nn_processor_subdomains;
 
@@ -141,6 +148,7 @@ class nn_prcs
 		// cast the pointer
 		nn_prcs<dim,T,layout_base,Memory> * cd = static_cast< nn_prcs<dim,T,layout_base,Memory> *>(ptr);
 
+		cd->nn_sources.add(i);
 		cd->nn_processor_subdomains[i].bx.resize(msg_i / sizeof(::Box<dim,T>) );
 
 		// Return the receive pointer
@@ -324,6 +332,8 @@ public:
 	nn_prcs<dim,T,layout_base,Memory> & operator=(const nn_prcs<dim,T,layout_base,Memory> & nnp)
 	{
 		nn_processors = nnp.nn_processors;
+		nn_sources = nnp.nn_sources;
+		nn_ex = nnp.nn_ex;
 		nn_processor_subdomains = nnp.nn_processor_subdomains;
 		proc_adj_box = nnp.proc_adj_box;
 		boxes = nnp.boxes;
@@ -341,6 +351,8 @@ public:
 	nn_prcs<dim,T,layout_base,Memory> & operator=(nn_prcs<dim,T,layout_base,Memory> && nnp)
 	{
 		nn_processors.swap(nnp.nn_processors);
+		nn_sources.swap(nnp.nn_sources);
+		nn_ex = nnp.nn_ex;
 		nn_processor_subdomains.swap(nnp.nn_processor_subdomains);
 		proc_adj_box.swap(nnp.proc_adj_box);
 		boxes = nnp.boxes;
@@ -359,6 +371,8 @@ public:
 	nn_prcs<dim,T,layout_base,Memory> & operator=(const nn_prcs<dim,T,layout_base2,Memory2> & nnp)
 	{
 		nn_processors = nnp.private_get_nn_processors();
+		nn_sources = nnp.private_get_nn_sources();
+		nn_ex.setNeighborhood(nn_sources,nn_processors);
 		nn_processor_subdomains = nnp.private_get_nn_processor_subdomains();
 		proc_adj_box = nnp.private_get_proc_adj_box();
 		boxes = nnp.private_get_boxes();
@@ -376,6 +390,16 @@ public:
 		return nn_processors;
 	}
 
+	/*! \brief Return the internal nn_sources
+	 *
+	 * \return the internal nn_sources
+	 *
+	 */
+	openfpm::vector<size_t> & private_get_nn_sources()
+	{
+		return nn_sources;
+	}
+
 	/*! \brief Return the internal nn_processor_subdomains
 	 *
 	 * \return the internal nn_processor_subdomains
@@ -417,6 +441,8 @@ public:
 	nn_prcs<dim,T,layout_base,Memory> & operator=(nn_prcs<dim,T,layout_base2,Memory2> && nnp)
 	{
 		nn_processors.swap(nnp.private_get_nn_processors());
+		nn_sources.swap(nnp.private_get_nn_sources());
+		nn_ex.setNeighborhood(nn_sources,nn_processors);
 		nn_processor_subdomains.swap(nnp.private_get_nn_processor_subdomains());
 		proc_adj_box.swap(nnp.private_get_proc_adj_box());
 		boxes = nnp.private_get_boxes();
@@ -489,8 +515,13 @@ public:
 		nn_processor_subdomains.reserve(nn_processors.size());
 
 		// Get the sub-domains of the near processors
+		nn_sources.clear();
 		v_cl.sendrecvMultipleMessagesNBX(nn_processors,boxes,nn_prcs<dim,T,layout_base,Memory>::message_alloc, this ,NEED_ALL_SIZE);
 
+		// the processors that sent us their sub-domains are the one that can send us particles
+		std::sort(nn_sources.begin(), nn_sources.end());
+		nn_ex.setNeighborhood(nn_sources,nn_processors);
+
 		// Add to all the received sub-domains the information that they live in the central sector
 		for ( auto it = nn_processor_subdomains.begin(); it != nn_processor_subdomains.end(); ++it )
 		{
@@ -520,6 +551,20 @@ public:
 		return nn_processors.size();
 	}
 
+	/*! \brief Get the neighborhood exchange of the adjacent processors
+	 *
+	 * It exchange messages with MPI neighborhood collectives on a graph communicator that connect the
+	 * local processor with the near processors and with the processors that have the local processor
+	 * as near processor
+	 *
+	 * \return the neighborhood exchange
+	 *
+	 */
+	inline neighbor_exchange & getNeighborExchange()
+	{
+		return nn_ex;
+	}
+
 	/*! \brief Return the processor id of the near processor list at place id
 	 *
 	 * \param id
@@ -746,6 +791,8 @@ public:
 	void reset()
 	{
 		nn_processors.clear();
+		nn_sources.clear();
+		nn_ex.setNeighborhood(nn_sources,nn_processors);
 		nn_processor_subdomains.clear();
 		nn_processor_subdomains_tmp.clear();
 		proc_adj_box.clear();
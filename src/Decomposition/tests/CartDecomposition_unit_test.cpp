@@ -689,5 +689,165 @@ BOOST_AUTO_TEST_CASE( CartDecomposition_nsub_algo_functions_test)
 	}
 }
 
+BOOST_AUTO_TEST_CASE( CartDecomposition_keep_subdomains_refine_test)
+{
+	// Vcluster
+	Vcluster<> & vcl = create_vcluster();
+
+	// Physical domain
+	Box<3, float> box( { 0.0, 0.0, 0.0 }, { 1.0, 1.0, 1.0 });
+	size_t div[3];
+
+	size_t n_proc = vcl.getProcessingUnits();
+	size_t n_sub = n_proc * SUB_UNIT_FACTOR;
+
+	for (int i = 0; i < 3; i++)
+	{div[i] = openfpm::math::round_big_2(pow(n_sub,1.0/3));}
+
+	Ghost<3, float> g(0.01);
+
+	// non periodic and periodic
+	for (size_t pr = 0 ; pr < 2 ; pr++)
+	{
+		size_t bc[] = { NON_PERIODIC, NON_PERIODIC, NON_PERIODIC };
+
+		if (pr == 1)
+		{bc[0] = PERIODIC;bc[1] = PERIODIC;bc[2] = PERIODIC;}
+
+		// dec keep the sub-domains of the processors not affected, dec_full recompute everything
+		CartDecomposition<3, float> dec(vcl);
+		CartDecomposition<3, float> dec_full(vcl);
+		dec.setKeepSubdomains(true);
+		dec_full.setKeepSubdomains(false);
+
+		dec.setParameters(div,box,bc,g);
+		dec.decompose();
+
+		dec_full.setParameters(div,box,bc,g);
+		dec_full.decompose();
+
+		// refine without changes in the costs and with a heavy corner
+		for (size_t s = 0 ; s < 2 ; s++)
+		{
+			CartDecomposition<3, float> * decs[2] = {&dec,&dec_full};
+
+			for (size_t d = 0 ; d < 2 ; d++)
+			{
+				auto & dist = decs[d]->getDistribution();
+
+				Point<3,float> p;
+				for (size_t i = 0; i < dist.getNOwnerSubSubDomains() ; i++)
+				{
+					dist.getSubSubDomainPos(i,p);
+
+					size_t cost = (s == 1 && p.get(0) < 0.25 && p.get(1) < 0.25)?4:1;
+					decs[d]->setSubSubDomainComputationCost(dist.getOwnerSubSubDomain(i),cost);
+				}
+
+				decs[d]->computeCommunicationAndMigrationCosts(1);
+				decs[d]->refine(1);
+			}
+
+			bool val = dec.check_consistency();
+			BOOST_REQUIRE_EQUAL(val,true);
+
+			// keeping the sub-domains produce the same decomposition
+			bool ret = dec.is_equal(dec_full);
+			BOOST_REQUIRE_EQUAL(ret,true);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( CartDecomposition_max_box_merging_test)
+{
+	// Vcluster
+	Vcluster<> & vcl = create_vcluster();
+
+	// Physical domain
+	Box<3, float> box( { 0.0, 0.0, 0.0 }, { 1.0, 1.0, 1.0 });
+	size_t div[3];
+
+	size_t n_proc = vcl.getProcessingUnits();
+	size_t n_sub = n_proc * SUB_UNIT_FACTOR;
+
+	for (int i = 0; i < 3; i++)
+	{div[i] = openfpm::math::round_big_2(pow(n_sub,1.0/3));}
+
+	Ghost<3, float> g(0.01);
+	size_t bc[] = { PERIODIC, PERIODIC, PERIODIC };
+
+	//! [max box merging]
+
+	CartDecomposition<3, float> dec(vcl);
+	dec.setSubdomainMerging(dec_merge::MAX_BOX);
+	dec.setParameters(div,box,bc,g);
+	dec.decompose();
+
+	//! [max box merging]
+
+	CartDecomposition<3, float> dec_wf(vcl);
+	dec_wf.setParameters(div,box,bc,g);
+	dec_wf.decompose();
+
+	bool val = dec.check_consistency();
+	BOOST_REQUIRE_EQUAL(val,true);
+
+	// the sub-domains cover all the owned sub-sub-domains
+	float vol = 0.0;
+	for (size_t i = 0 ; i < dec.getNSubDomain() ; i++)
+	{vol += dec.getSubDomain(i).getVolume();}
+
+	float vol_ss = dec.getDistribution().getNOwnerSubSubDomains() / (float)(div[0]*div[1]*div[2]);
+	BOOST_REQUIRE_CLOSE(vol,vol_ss,0.01);
+
+	// every internal ghost box is seen by ghost_processorID
+	for (size_t i = 0; i < dec.getNIGhostBox(); i++)
+	{
+		SpaceBox<3,float> b = dec.getIGhostBox(i);
+		size_t proc = dec.getIGhostBoxProcessor(i);
+
+		Point<3,float> p = b.rnd();
+
+		const openfpm::vector<size_t> & pr = dec.ghost_processorID<CartDecomposition<3,float>::processor_id>(p);
+
+		bool found = false;
+		for (size_t j = 0; j < pr.size(); j++)
+		{
+			if (pr.get(j) == proc)
+			{found = true; break;}
+		}
+
+		BOOST_REQUIRE_EQUAL(found,true);
+	}
+
+	// the sub-domains do not overlap, together with the volume check they cover exactly
+	// the owned sub-sub-domains
+	for (size_t i = 0 ; i < dec.getNSubDomain() ; i++)
+	{
+		for (size_t j = i + 1 ; j < dec.getNSubDomain() ; j++)
+		{
+			Box<3,float> inte;
+
+			if (dec.getSubDomain(i).Intersect(dec.getSubDomain(j),inte) == true)
+			{BOOST_REQUIRE_SMALL(inte.getVolume(),1e-6f);}
+		}
+	}
+
+	// every point of the sub-domains is owned by this processor, and is in the same place
+	// with the wavefront merging
+	for (size_t i = 0 ; i < dec.getNSubDomain() ; i++)
+	{
+		SpaceBox<3,float> sb = dec.getSubDomain(i);
+
+		for (size_t k = 0 ; k < 16 ; k++)
+		{
+			Point<3,float> p = sb.rnd();
+
+			BOOST_REQUIRE_EQUAL(dec.processorID(p),vcl.getProcessUnitID());
+			BOOST_REQUIRE_EQUAL(dec_wf.processorID(p),vcl.getProcessUnitID());
+		}
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,230 @@
+/*
+ * grid_dist_bulk_insert.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef GRID_DIST_BULK_INSERT_HPP_
+#define GRID_DIST_BULK_INSERT_HPP_
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include "util/common.hpp"
+#include "Grid/grid_key.hpp"
+#include "util/for_each_parallel.hpp"
+
+//! Edge (in points) of the blocks used to group the inserted points when the local grid is not chunked
+#define BULK_INSERT_BLOCK 8
+
+/*! \brief Edge of the blocks used to group the inserted points
+ *
+ * For a grid without chunks (dense) the edge is BULK_INSERT_BLOCK
+ *
+ */
+template<typename grid_type, typename Sfinae = void>
+struct bulk_insert_block
+{
+	/*! \brief Get the edge of the block in every direction
+	 *
+	 * \param edge edge of the block
+	 *
+	 */
+	template<unsigned int dim>
+	static void get(size_t (& edge)[dim])
+	{
+		for (size_t j = 0 ; j < dim ; j++)
+		{edge[j] = BULK_INSERT_BLOCK;}
+	}
+};
+
+/*! \brief Edge of the blocks used to group the inserted points
+ *
+ * For a sparse grid the blocks are the chunks of the grid
+ *
+ */
+template<typename grid_type>
+struct bulk_insert_block<grid_type,typename Void<typename grid_type::chunking_type>::type>
+{
+	//! functor that copy the chunk edge of every direction
+	template<unsigned int dim>
+	struct chunk_edge
+	{
+		//! edge of the block
+		size_t (& edge)[dim];
+
+		//! constructor
+		chunk_edge(size_t (& edge)[dim])
+		:edge(edge)
+		{}
+
+		//! copy the edge of the direction T
+		template<typename T>
+		void operator()(T& t) const
+		{
+			edge[T::value] = boost::mpl::at<typename grid_type::chunking_type,boost::mpl::int_<T::value>>::type::value;
+		}
+	};
+
+	/*! \brief Get the edge of the block in every direction
+	 *
+	 * \param edge edge of the block
+	 *
+	 */
+	template<unsigned int dim>
+	static void get(size_t (& edge)[dim])
+	{
+		chunk_edge<dim> ce(edge);
+		boost::mpl::for_each_ref<boost::mpl::range_c<int,0,dim>>(ce);
+	}
+};
+
+/*! \brief Call a lambda passing the coordinates of a key as separate int arguments
+ *
+ * f(k.get(0),k.get(1),...) or f(data,k.get(0),k.get(1),...)
+ *
+ */
+template<unsigned int dim>
+struct bulk_insert_call
+{
+	//! call f(i,j,k,...)
+	template<typename lambda_t, size_t ... I>
+	static inline auto call(lambda_t & f, const grid_key_dx<dim> & k, std::index_sequence<I...>) -> decltype(f((int)k.get(I)...))
+	{
+		return f((int)k.get(I)...);
+	}
+
+	//! call f(data,i,j,k,...)
+	template<typename lambda_t, typename data_type, size_t ... I>
+	static inline void call_data(lambda_t & f, data_type && data, const grid_key_dx<dim> & k, std::index_sequence<I...>)
+	{
+		f(data,(int)k.get(I)...);
+	}
+};
+
+/*! \brief Insert in bulk the points of a box of a local (sparse) grid
+ *
+ * The insertion is done in two passes
+ *
+ * * The local grid is divided in blocks aligned to the chunks of the sparse grid (see bulk_insert_block),
+ *   the blocks overlapping the box are distributed across threads. Every thread evaluate f1 on the
+ *   points of its blocks and collect the points to insert into a per-thread buffer. Every point is
+ *   identified by the id of its block and its offset inside the block
+ * * The buffers are inserted in the local grid one after the other. A block is processed by one thread,
+ *   so the points of a chunk are consecutive in one buffer: the chunk is allocated once and its points
+ *   are inserted one after another. f2 is called on the inserted point
+ *
+ * Every point of the box is visited once, so no point is inserted twice
+ *
+ * \param lg local grid
+ * \param bx box to process (local coordinates)
+ * \param origin origin of the local grid in global coordinates
+ * \param f1 f1(i,j,k,...) return true if the point (global coordinates) must be inserted
+ * \param f2 f2(data,i,j,k,...) set the properties of the inserted point
+ *
+ * \return the number of inserted points
+ *
+ */
+template<unsigned int dim, typename grid_type, typename lambda_t1, typename lambda_t2>
+size_t bulk_insert_box(grid_type & lg, const Box<dim,long int> & bx, const grid_key_dx<dim> & origin, lambda_t1 & f1, lambda_t2 & f2)
+{
+	size_t n_blk[dim];
+	size_t blk_sz[dim];
+	long int blk_low[dim];
+	size_t blk_vol = 1;
+
+	bulk_insert_block<grid_type>::get(blk_sz);
+
+	for (size_t j = 0 ; j < dim ; j++)
+	{
+		long int e = blk_sz[j];
+
+		// first and last block (aligned to the chunks) that overlap the box
+		long int b_low = (bx.getLow(j) >= 0)?bx.getLow(j) / e:-((-bx.getLow(j) + e - 1) / e);
+		long int b_high = (bx.getHigh(j) >= 0)?bx.getHigh(j) / e:-((-bx.getHigh(j) + e - 1) / e);
+
+		blk_low[j] = b_low * e;
+		n_blk[j] = b_high - b_low + 1;
+		blk_vol *= blk_sz[j];
+	}
+
+	grid_sm<dim,void> blocks(n_blk);
+	grid_sm<dim,void> in_blk(blk_sz);
+
+	// point key inside the local grid from (block id, offset)
+	auto to_key = [&](size_t c)
+	{
+		grid_key_dx<dim> bk = blocks.InvLinId(c / blk_vol);
+		grid_key_dx<dim> ok = in_blk.InvLinId(c % blk_vol);
+
+		grid_key_dx<dim> k;
+		for (size_t j = 0 ; j < dim ; j++)
+		{k.set_d(j,blk_low[j] + bk.get(j)*blk_sz[j] + ok.get(j));}
+
+		return k;
+	};
+
+	std::vector<std::vector<size_t>> buf(pdata_threads_number());
+
+	// collect pass
+	auto fc = [&](size_t b, int thr)
+	{
+		grid_key_dx<dim> bk = blocks.InvLinId(b);
+
+		grid_key_dx<dim> start;
+		grid_key_dx<dim> stop;
+
+		// part of the block inside the box
+		for (size_t j = 0 ; j < dim ; j++)
+		{
+			long int b_start = blk_low[j] + bk.get(j)*blk_sz[j];
+
+			start.set_d(j,std::max(bx.getLow(j) - b_start,0l));
+			stop.set_d(j,std::min(bx.getHigh(j) - b_start,(long int)blk_sz[j] - 1));
+		}
+
+		grid_key_dx_iterator_sub<dim> it(in_blk,start,stop);
+
+		while (it.isNext())
+		{
+			size_t c = b*blk_vol + in_blk.LinId(it.get());
+			grid_key_dx<dim> k = to_key(c);
+
+			grid_key_dx<dim> gk;
+			for (size_t j = 0 ; j < dim ; j++)
+			{gk.set_d(j,k.get(j) + origin.get(j));}
+
+			if (bulk_insert_call<dim>::call(f1,gk,std::make_index_sequence<dim>()) == true)
+			{buf[thr].push_back(c);}
+
+			++it;
+		}
+	};
+
+	parallel_work_items(blocks.size(),fc);
+
+	// insertion pass
+	size_t n_ins = 0;
+
+	for (size_t t = 0 ; t < buf.size() ; t++)
+	{
+		for (size_t p = 0 ; p < buf[t].size() ; p++)
+		{
+			grid_key_dx<dim> k = to_key(buf[t][p]);
+
+			grid_key_dx<dim> gk;
+			for (size_t j = 0 ; j < dim ; j++)
+			{gk.set_d(j,k.get(j) + origin.get(j));}
+
+			bulk_insert_call<dim>::call_data(f2,lg.insert_o(k),gk,std::make_index_sequence<dim>());
+		}
+
+		n_ins += buf[t].size();
+		std::vector<size_t>().swap(buf[t]);
+	}
+
+	return n_ins;
+}
+
+#endif /* GRID_DIST_BULK_INSERT_HPP_ */
@@ -0,0 +1,262 @@
+/*
+ * grid_dist_conv_n.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef GRID_DIST_CONV_N_HPP_
+#define GRID_DIST_CONV_N_HPP_
+
+#include "Grid/grid_key.hpp"
+#include "util/for_each_parallel.hpp"
+
+/*! \brief Get the address of the property p of the point 0 of a local grid, for each property
+ *
+ * \tparam grid_type type of the local grid
+ * \tparam n_prp number of properties
+ *
+ */
+template<typename grid_type, unsigned int n_prp>
+struct conv_n_base
+{
+	//! local grid
+	grid_type & lg;
+
+	//! point 0
+	grid_key_dx<grid_type::dims> k0;
+
+	//! address of each property on the point 0
+	char * (& base)[n_prp];
+
+	//! constructor
+	conv_n_base(grid_type & lg, char * (& base)[n_prp])
+	:lg(lg),base(base)
+	{
+		k0.zero();
+	}
+
+	//! It call the functor for each property
+	template<typename T>
+	inline void operator()(T& t)
+	{
+		base[T::value] = (char *)&lg.template get<T::value>(k0);
+	}
+};
+
+/*! \brief Stencil seen by the lambda of grid_dist_id::conv_n
+ *
+ * It give access to every property of the local grid around the point where the stencil is applied.
+ * The properties are accessed with raw pointers: the address of a property is the address on the
+ * point 0 plus the linear id of the point times the size of a point (linear layout)
+ *
+ * \code
+ *
+ * g_dist.conv_n<1>(start,stop,[](auto & s)
+ * {
+ *   s.template get<3>() = s.template get<0>(1,0,0) + s.template get<0>(-1,0,0);
+ *   s.template get<4>() = s.template get<1>(0,1,0) + s.template get<1>(0,-1,0);
+ * });
+ *
+ * \endcode
+ *
+ * \tparam dim dimensionality
+ * \tparam stencil_size maximum offset allowed
+ * \tparam grid_type type of the local grid
+ * \tparam n_prp number of properties
+ *
+ */
+template<unsigned int dim, unsigned int stencil_size, typename grid_type, unsigned int n_prp>
+struct conv_n_stencil
+{
+	//! address of each property on the point 0
+	char * base[n_prp];
+
+	//! size of a point in byte
+	long int esz;
+
+	//! stride in points of each dimension
+	long int str[dim];
+
+	//! linear id of the point where the stencil is applied
+	long int lin;
+
+	//! linear id of the first point of the row
+	long int lin_row;
+
+	//! first point of the row (local coordinates)
+	grid_key_dx<dim> row;
+
+	//! origin of the local grid in global coordinates
+	grid_key_dx<dim> origin;
+
+	//! local grid
+	grid_type & lg;
+
+	/*! \brief Constructor
+	 *
+	 * \param lg local grid
+	 * \param origin origin of the local grid in global coordinates
+	 *
+	 */
+	conv_n_stencil(grid_type & lg, const grid_key_dx<dim> & origin)
+	:origin(origin),lg(lg)
+	{
+		conv_n_base<grid_type,n_prp> cb(lg,base);
+		boost::mpl::for_each_ref<boost::mpl::range_c<int,0,n_prp>>(cb);
+
+		auto & gs = lg.getGrid();
+
+		str[0] = 1;
+		for (size_t i = 1 ; i < dim ; i++)
+		{str[i] = str[i-1] * gs.size(i-1);}
+
+		esz = 0;
+		if (gs.size() > 1)
+		{
+			grid_key_dx<dim> k1 = gs.InvLinId(1);
+			esz = (char *)&lg.template get<0>(k1) - base[0];
+		}
+	}
+
+	/*! \brief Set the row of points processed
+	 *
+	 * \param k first point of the row (local coordinates)
+	 *
+	 */
+	inline void setRow(const grid_key_dx<dim> & k)
+	{
+		row = k;
+		lin_row = 0;
+		for (size_t i = 0 ; i < dim ; i++)
+		{lin_row += k.get(i) * str[i];}
+
+		lin = lin_row;
+	}
+
+	/*! \brief Get the property p on the point where the stencil is applied
+	 *
+	 * \return the property p
+	 *
+	 */
+	template<unsigned int p>
+	inline auto get() -> decltype(lg.template get<p>(row))
+	{
+		typedef typename std::remove_reference<decltype(lg.template get<p>(row))>::type prp_type;
+
+		return *(prp_type *)(base[p] + lin*esz);
+	}
+
+	/*! \brief Get the property p on a point of the stencil
+	 *
+	 * \param off offset for each dimension
+	 *
+	 * \return the property p
+	 *
+	 */
+	template<unsigned int p, typename ... offT>
+	inline auto get(offT ... off) -> decltype(lg.template get<p>(row))
+	{
+		static_assert(sizeof...(off) == dim, "conv_n_stencil: the number of offsets must be equal to the dimensionality");
+
+		typedef typename std::remove_reference<decltype(lg.template get<p>(row))>::type prp_type;
+
+		long int o[dim] = {(long int)off ...};
+
+		long int l = lin;
+		for (size_t i = 0 ; i < dim ; i++)
+		{
+#ifdef SE_CLASS1
+			if (o[i] > (long int)stencil_size || o[i] < -(long int)stencil_size)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " Error the offset " << o[i] << " is bigger than the stencil size " << stencil_size << std::endl;}
+#endif
+			l += o[i] * str[i];
+		}
+
+		return *(prp_type *)(base[p] + l*esz);
+	}
+
+	/*! \brief Return the point where the stencil is applied in global coordinates
+	 *
+	 * \return the point in global coordinates
+	 *
+	 */
+	inline grid_key_dx<dim> getGKey() const
+	{
+		grid_key_dx<dim> k;
+
+		k.set_d(0,row.get(0) + lin - lin_row + origin.get(0));
+		for (size_t i = 1 ; i < dim ; i++)
+		{k.set_d(i,row.get(i) + origin.get(i));}
+
+		return k;
+	}
+};
+
+/*! \brief Apply a stencil lambda on all the points of a box of a dense local grid with linear layout
+ *
+ * The box is divided in tiles of blk points along every dimension except the first (contiguous
+ * in memory) so that the neighborhood of a tile stay in cache for all the properties. The
+ * tiles are processed in parallel, inside a tile the points of a row along the first dimension
+ * are visited with a plain loop on the linear id
+ *
+ * \tparam dim dimensionality
+ * \tparam stencil_size maximum offset of the stencil
+ * \tparam n_prp number of properties
+ *
+ * \param lg local grid
+ * \param bx box to process (local coordinates)
+ * \param origin origin of the local grid in global coordinates
+ * \param func lambda to apply
+ * \param blk tile size
+ *
+ */
+template<unsigned int dim, unsigned int stencil_size, unsigned int n_prp, typename grid_type, typename lambda_f>
+void conv_n_box(grid_type & lg, const Box<dim,long int> & bx, const grid_key_dx<dim> & origin, lambda_f & func, size_t blk)
+{
+	size_t n_tile[dim];
+
+	n_tile[0] = 1;
+	for (size_t j = 1 ; j < dim ; j++)
+	{n_tile[j] = (bx.getHigh(j) - bx.getLow(j) + blk) / blk;}
+
+	grid_sm<dim,void> tiles(n_tile);
+
+	long int n_x = bx.getHigh(0) - bx.getLow(0) + 1;
+
+	auto ft = [&](size_t t, int thr)
+	{
+		grid_key_dx<dim> tk = tiles.InvLinId(t);
+
+		grid_key_dx<dim> start;
+		grid_key_dx<dim> stop;
+
+		// the rows start on the first point along the first dimension
+		start.set_d(0,bx.getLow(0));
+		stop.set_d(0,bx.getLow(0));
+
+		for (size_t j = 1 ; j < dim ; j++)
+		{
+			start.set_d(j,bx.getLow(j) + tk.get(j)*blk);
+			stop.set_d(j,std::min(start.get(j) + (long int)blk - 1,bx.getHigh(j)));
+		}
+
+		conv_n_stencil<dim,stencil_size,grid_type,n_prp> st(lg,origin);
+
+		grid_key_dx_iterator_sub<dim> it(lg.getGrid(),start,stop);
+
+		while (it.isNext())
+		{
+			st.setRow(it.get());
+
+			for (long int x = 0 ; x < n_x ; x++, st.lin++)
+			{func(st);}
+
+			++it;
+		}
+	};
+
+	parallel_work_items(tiles.size(),ft);
+}
+
+#endif /* GRID_DIST_CONV_N_HPP_ */
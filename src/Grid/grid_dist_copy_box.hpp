@@ -0,0 +1,155 @@
+/*
+ * grid_dist_copy_box.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef GRID_DIST_COPY_BOX_HPP_
+#define GRID_DIST_COPY_BOX_HPP_
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "Grid/map_grid.hpp"
+#include "Space/Shape/Box.hpp"
+
+/*! \brief Copy a box of a dense local grid into a box of the same size of another dense local grid with memcpy
+ *
+ * The local grids are linearized with the first coordinate as the fastest, a row of the box is contiguous
+ * in memory. The leading directions fully covered by the box in both grids are merged with the row, so that
+ * a box covering an entire grid is copied with one memcpy
+ *
+ * \param dst destination grid
+ * \param src source grid
+ * \param bx_src box in src
+ * \param bx_dst box in dst
+ * \param el_sz size of an element
+ *
+ */
+template<unsigned int dim, typename grid_dst_type, typename grid_src_type>
+void grid_copy_box_memcpy(grid_dst_type & dst, grid_src_type & src, const Box<dim,long int> & bx_src, const Box<dim,long int> & bx_dst, size_t el_sz)
+{
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		if (bx_src.getHigh(i) < bx_src.getLow(i))
+		{return;}
+	}
+
+	auto & gs = src.getGrid();
+	auto & gd = dst.getGrid();
+
+	// number of contiguous elements copied with one memcpy
+	size_t chunk = 1;
+	unsigned int cd = 0;
+	while (cd < dim)
+	{
+		size_t len = bx_src.getHigh(cd) - bx_src.getLow(cd) + 1;
+		chunk *= len;
+		cd++;
+
+		if (len != gs.size(cd-1) || len != gd.size(cd-1))
+		{break;}
+	}
+
+	char * ps = static_cast<char *>(src.getPointer());
+	char * pd = static_cast<char *>(dst.getPointer());
+
+	grid_key_dx<dim> ks = bx_src.getKP1();
+	grid_key_dx<dim> kd = bx_dst.getKP1();
+
+	while (true)
+	{
+		memcpy(pd + gd.LinId(kd)*el_sz, ps + gs.LinId(ks)*el_sz, chunk*el_sz);
+
+		// next chunk
+		unsigned int d = cd;
+		for ( ; d < dim ; d++)
+		{
+			if (ks.get(d) < bx_src.getHigh(d))
+			{
+				ks.set_d(d,ks.get(d) + 1);
+				kd.set_d(d,kd.get(d) + 1);
+				break;
+			}
+
+			ks.set_d(d,bx_src.getLow(d));
+			kd.set_d(d,bx_dst.getLow(d));
+		}
+
+		if (d == dim)
+		{break;}
+	}
+}
+
+/*! \brief Copy a box of a local grid into another local grid
+ *
+ * Generic (sparse or device) grids use copy_to
+ *
+ */
+template<bool is_dense_host>
+struct grid_copy_box_impl
+{
+	template<typename T, unsigned int dim, typename grid_dst_type, typename grid_src_type>
+	static void copy(grid_dst_type & dst, grid_src_type & src, const Box<dim,long int> & bx_src, const Box<dim,long int> & bx_dst, size_t opt)
+	{
+		dst.copy_to(src,bx_src,bx_dst);
+	}
+};
+
+/*! \brief Copy a box of a local grid into another local grid
+ *
+ * Dense grids in host memory with properties without pointers are copied with memcpy
+ *
+ */
+template<>
+struct grid_copy_box_impl<true>
+{
+	template<typename T, unsigned int dim, typename grid_dst_type, typename grid_src_type>
+	static void copy(grid_dst_type & dst, grid_src_type & src, const Box<dim,long int> & bx_src, const Box<dim,long int> & bx_dst, size_t opt)
+	{
+		if (T::noPointers() == true && !(opt & RUN_ON_DEVICE))
+		{grid_copy_box_memcpy(dst,src,bx_src,bx_dst,sizeof(T));}
+		else
+		{dst.copy_to(src,bx_src,bx_dst);}
+	}
+};
+
+/*! \brief Check if a local grid can be copied with grid_copy_box_memcpy
+ *
+ * The grid must be dense, in host memory, with interleaved properties (no structure of arrays) and linearized
+ * with grid_sm (no block or morton linearization)
+ *
+ */
+template<unsigned int dim, typename device_grid, typename Memory>
+struct grid_copy_box_dense
+{
+	//! linearizer of the grid
+	typedef typename std::remove_const<typename std::remove_reference<decltype(std::declval<device_grid>().getGrid())>::type>::type linearizer;
+
+	//! true if the grid can be copied with memcpy
+	static const bool value = device_grid::isCompressed() == false &&
+							  std::is_same<Memory,HeapMemory>::value &&
+							  is_layout_inte<typename device_grid::layout_base_>::value == false &&
+							  std::is_same<linearizer,grid_sm<dim,void>>::value;
+};
+
+/*! \brief Copy a box of a local grid into a box of the same size of another local grid
+ *
+ * \tparam T type of the grid element
+ * \tparam Memory memory of the distributed grid
+ *
+ * \param dst destination grid
+ * \param src source grid
+ * \param bx_src box in src
+ * \param bx_dst box in dst
+ * \param opt options of the operation (RUN_ON_DEVICE)
+ *
+ */
+template<typename T, typename Memory, unsigned int dim, typename device_grid>
+void grid_copy_box(device_grid & dst, device_grid & src, const Box<dim,long int> & bx_src, const Box<dim,long int> & bx_dst, size_t opt)
+{
+	grid_copy_box_impl<grid_copy_box_dense<dim,device_grid,Memory>::value>::template copy<T>(dst,src,bx_src,bx_dst,opt);
+}
+
+#endif /* GRID_DIST_COPY_BOX_HPP_ */
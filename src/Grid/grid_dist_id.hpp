@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <unordered_map>
+#include <fstream>
 #include "Grid/map_grid.hpp"
 #include "VCluster/VCluster.hpp"
 #include "Space/SpaceBox.hpp"
@@ -27,6 +28,9 @@
 #include "HDF5_wr/HDF5_wr.hpp"
 #include "SparseGrid/SparseGrid.hpp"
 #include "lib/pdata.hpp"
+#include "util/for_each_parallel.hpp"
+#include "grid_dist_conv_n.hpp"
+#include "grid_dist_bulk_insert.hpp"
 #ifdef __NVCC__
 #include "cuda/grid_dist_id_kernels.cuh"
 #include "Grid/cuda/grid_dist_id_iterator_gpu.cuh"
@@ -59,6 +63,36 @@ struct Box_fix
 	size_t r_sub;
 };
 
+//! Part of a received internal ghost box required by a reduced ghost extent, sent back to the owner
+template<unsigned int dim>
+struct Box_clip
+{
+	//! Global id of the internal ghost box
+	size_t g_id;
+	//! points to remove on the low side of every direction
+	long int lo[dim];
+	//! points to remove on the high side of every direction
+	long int hi[dim];
+	//! the reduced ghost does not need any point of the box
+	bool empty;
+};
+
+//! Internal and external ghost boxes of a grid clipped to a reduced ghost extent
+template<unsigned int dim>
+struct ghost_ext_class
+{
+	//! reduced ghost extent
+	Ghost<dim,long int> g;
+	//! internal ghost boxes clipped to the reduced extent
+	openfpm::vector<ip_box_grid<dim>> ig_box;
+	//! external ghost boxes clipped to the reduced extent
+	openfpm::vector<ep_box_grid<dim>> eg_box;
+	//! external ghost box links for the clipped external ghost boxes
+	openfpm::vector<e_box_multi<dim>> eb_gid_list;
+	//! indicate if the clipped boxes has been calculated
+	bool init = false;
+};
+
 #define NO_GDB_EXT_SWITCH 0x1000
 
 template<bool is_sparse>
@@ -70,6 +104,22 @@ struct device_grid_copy
 		dg.insert_o(key_dst) = lg.get_o(key);
 	}
 
+	/*! \brief Copy a box of lg into a box of dg of the same size
+	 *
+	 * For dense grids the copy is done with block copies of the box
+	 *
+	 * \param dg destination grid
+	 * \param lg source grid
+	 * \param bx_src box in lg
+	 * \param bx_dst box in dg
+	 *
+	 */
+	template<typename T, typename Memory, unsigned int dim, typename spg_type, typename lg_type>
+	static void copy_box(spg_type & dg, lg_type & lg, const Box<dim,long int> & bx_src, const Box<dim,long int> & bx_dst)
+	{
+		grid_copy_box<T,Memory>(dg,lg,bx_src,bx_dst,0);
+	}
+
 	template<typename gdb_ext_type, typename loc_grid_type>
 	static void pre_load(gdb_ext_type & gdb_ext_old, loc_grid_type & loc_grid_old, gdb_ext_type & gdb_ext, loc_grid_type & loc_grid) 
 	{
@@ -103,6 +153,42 @@ struct copy_all_prop_sparse
 	}
 };
 
+/*! \brief this class is a functor for "for_each" algorithm
+ *
+ * It copy all the properties from one encapsulated object to another with
+ * the same properties (the two objects can come from different data-structures)
+ *
+ */
+template<typename T_type, typename e_src, typename e_dst>
+struct copy_all_prop_encap
+{
+	//! encapsulated source object
+	e_src & src;
+
+	//! encapsulated destination object
+	e_dst & dst;
+
+	/*! \brief constructor
+	 *
+	 * \param src source encapsulated object
+	 * \param dst destination encapsulated object
+	 *
+	 */
+	inline copy_all_prop_encap(e_src & src, e_dst & dst)
+	:src(src),dst(dst)
+	{
+	};
+
+	//! It call the copy function for each property
+	template<typename T>
+	inline void operator()(T& t) const
+	{
+		typedef typename boost::mpl::at<typename T_type::type,boost::mpl::int_<T::value>>::type copy_rtype;
+
+		meta_copy<copy_rtype>::meta_copy_(src.template get<T::value>(),dst.template get<T::value>());
+	}
+};
+
 template<typename T>
 struct variadic_caller
 {};
@@ -111,17 +197,26 @@ template<int ... prp>
 struct variadic_caller<index_tuple_sq<prp ...>>
 {
 	template<typename this_type, typename dec_type, typename cd_sm_type, typename loc_grid_type, typename gdb_ext_type>
-	static void call(this_type * this_,
-					 dec_type & dec, 
-					 cd_sm_type & cd_sm,
-					 loc_grid_type & loc_grid, 
-					 loc_grid_type & loc_grid_old, 
-					 gdb_ext_type & gdb_ext, 
-					 gdb_ext_type & gdb_ext_old, 
-					 gdb_ext_type & gdb_ext_global, 
-					 size_t opt)
-	{
-		this_->template map_<prp ...>(dec,cd_sm,loc_grid,loc_grid_old,gdb_ext,gdb_ext_old,gdb_ext_global,opt);
+	static void call_start(this_type * this_,
+						   dec_type & dec,
+						   cd_sm_type & cd_sm,
+						   loc_grid_type & loc_grid,
+						   loc_grid_type & loc_grid_old,
+						   gdb_ext_type & gdb_ext,
+						   gdb_ext_type & gdb_ext_old,
+						   gdb_ext_type & gdb_ext_global,
+						   size_t opt,
+						   bool fused)
+	{
+		this_->template map_start_<prp ...>(dec,cd_sm,loc_grid,loc_grid_old,gdb_ext,gdb_ext_old,gdb_ext_global,opt,fused);
+	}
+
+	template<typename this_type, typename loc_grid_type, typename gdb_ext_type>
+	static void call_finish(this_type * this_,
+							loc_grid_type & loc_grid,
+							gdb_ext_type & gdb_ext)
+	{
+		this_->template map_finish_<prp ...>(loc_grid,gdb_ext);
 	}
 };
 
@@ -155,6 +250,32 @@ struct device_grid_copy<true>
 		boost::mpl::for_each_ref< boost::mpl::range_c<int,0,decltype(block_data_dst)::max_prop> >(cp);
 	}
 
+	/*! \brief Copy the existing points of a box of lg into a box of dg of the same size
+	 *
+	 * \param dg destination grid
+	 * \param lg source grid
+	 * \param bx_src box in lg
+	 * \param bx_dst box in dg
+	 *
+	 */
+	template<typename T, typename Memory, unsigned int dim, typename spg_type, typename lg_type>
+	static void copy_box(spg_type & dg, lg_type & lg, const Box<dim,long int> & bx_src, const Box<dim,long int> & bx_dst)
+	{
+		auto it_src = lg.getIterator(bx_src.getKP1(),bx_src.getKP2());
+
+		while (it_src.isNext())
+		{
+			auto key = it_src.get();
+			grid_key_dx<dim> key_dst;
+
+			for (int j = 0 ; j < dim ; j++)
+			{key_dst.set_d(j,key.get(j) + bx_dst.getLow(j) - bx_src.getLow(j));}
+
+			assign(key,key_dst,dg,lg);
+
+			++it_src;
+		}
+	}
 
 
     template<typename gdb_ext_type, typename loc_grid_type>
@@ -331,6 +452,27 @@ class grid_dist_id : public grid_dist_id_comm<dim,St,T,Decomposition,Memory,devi
 	//! properties names
 	openfpm::vector<std::string> prp_names;
 
+	//! Number of processors that aggregate and write the output (0 = each processor write its own file)
+	size_t n_out_agg = 0;
+
+	//! Stencil radius in deep halo mode (0 = deep halo disabled)
+	size_t dh_radius = 0;
+
+	//! Number of sweeps for each ghost_get in deep halo mode
+	size_t dh_k = 1;
+
+	//! Number of sweeps done after the last ghost_get in deep halo mode
+	size_t dh_sweep = 0;
+
+	//! Background values saved by map_start
+	T map_bv;
+
+	//! Reduced ghost extents used by the properties
+	openfpm::vector<ghost_ext_class<dim>> gh_ext;
+
+	//! For each property the reduced ghost extent in gh_ext (-1 the full ghost), empty if no property has a reduced ghost
+	openfpm::vector<long int> prp_ext;
+
 	//! It map a global ghost id (g_id) to the external ghost box information
 	//! It is unique across all the near processor
 	std::unordered_map<size_t,size_t> g_id_to_external_ghost_box;
@@ -824,6 +966,301 @@ class grid_dist_id : public grid_dist_id_comm<dim,St,T,Decomposition,Memory,devi
 		init_e_g_box = true;
 	}
 
+	/*! \brief Create the internal and external ghost boxes clipped to a reduced ghost extent
+	 *
+	 * For every received internal ghost box the processor calculate the part required by the
+	 * reduced extent (the union of its external ghost boxes inside the linked sub-domains enlarged
+	 * by the reduced ghost) and send back to the owner how many points to remove on every side.
+	 * The clipping is expressed in points, so it does not depend on the periodic shift of the box
+	 *
+	 * \param c id of the reduced ghost extent in gh_ext
+	 *
+	 */
+	void create_ghost_ext(size_t c)
+	{
+		auto & ge = gh_ext.get(c);
+
+		if (ge.init == true)	return;
+
+		// the clipped lists start as a copy of the full one
+		ge.ig_box = ig_box;
+		ge.eg_box = eg_box;
+		ge.eb_gid_list = eb_gid_list;
+
+		openfpm::vector<size_t> prc;
+		openfpm::vector<size_t> prc_recv;
+		openfpm::vector<size_t> sz_recv;
+		openfpm::vector<openfpm::vector<Box_clip<dim>>> clip_send(dec.getNNProcessors());
+		openfpm::vector<openfpm::vector<Box_clip<dim>>> clip_recv;
+
+		for (size_t i = 0 ; i < dec.getNNProcessors() ; i++)
+		{
+			prc.add(dec.IDtoProc(i));
+			ge.eg_box.get(i).recv_pnt = 0;
+			ge.eg_box.get(i).n_r_box = 0;
+		}
+
+		// For each received internal ghost box
+		for (size_t i = 0 ; i < eb_gid_list.size() ; i++)
+		{
+			size_t ei = eb_gid_list.get(i).e_id;
+			size_t fm = eb_gid_list.get(i).full_match;
+			const openfpm::vector<size_t> & ebl = eb_gid_list.get(i).eb_list;
+
+			const Box<dim,long int> & full = eg_box.get(ei).bid.get(fm).g_e_box;
+
+			Box<dim,long int> clp;
+			bool empty = true;
+
+			for (size_t k = 0 ; k < ebl.size() ; k++)
+			{
+				const e_box_id<dim> & eb = eg_box.get(ei).bid.get(ebl.get(k));
+				const GBoxes<dim> & gb = gdb_ext.get(eb.sub);
+
+				Box<dim,long int> req = eb.g_e_box;
+
+				// an unlinked grid does not have a domain, it require the full box
+				if (gb.Dbox.isValid() == true)
+				{
+					Box<dim,long int> dom;
+					for (size_t s = 0 ; s < dim ; s++)
+					{
+						dom.setLow(s,gb.Dbox.getLow(s) + gb.origin.get(s) + ge.g.getLow(s));
+						dom.setHigh(s,gb.Dbox.getHigh(s) + gb.origin.get(s) + ge.g.getHigh(s));
+					}
+
+					if (eb.g_e_box.Intersect(dom,req) == false)
+					{continue;}
+				}
+
+				if (empty == true)
+				{
+					clp = req;
+					empty = false;
+					continue;
+				}
+
+				for (size_t s = 0 ; s < dim ; s++)
+				{
+					clp.setLow(s,std::min(clp.getLow(s),req.getLow(s)));
+					clp.setHigh(s,std::max(clp.getHigh(s),req.getHigh(s)));
+				}
+			}
+
+			Box_clip<dim> bc;
+			bc.g_id = eg_box.get(ei).bid.get(fm).g_id;
+			bc.empty = empty;
+
+			for (size_t s = 0 ; s < dim ; s++)
+			{
+				bc.lo[s] = (empty == true)?0:clp.getLow(s) - full.getLow(s);
+				bc.hi[s] = (empty == true)?0:full.getHigh(s) - clp.getHigh(s);
+			}
+
+			clip_send.get(ei).add(bc);
+
+			// clip the external ghost boxes linked to the received box
+			openfpm::vector<size_t> & ebl_c = ge.eb_gid_list.get(i).eb_list;
+			ebl_c.clear();
+
+			if (empty == true)
+			{continue;}
+
+			ge.eg_box.get(ei).recv_pnt += clp.getVolumeKey();
+			ge.eg_box.get(ei).n_r_box++;
+
+			for (size_t k = 0 ; k < ebl.size() ; k++)
+			{
+				e_box_id<dim> & eb = ge.eg_box.get(ei).bid.get(ebl.get(k));
+
+				Box<dim,long int> cb;
+				if (eb.g_e_box.Intersect(clp,cb) == false)
+				{continue;}
+
+				for (size_t s = 0 ; s < dim ; s++)
+				{
+					long int dl = cb.getLow(s) - eb.g_e_box.getLow(s);
+					long int dh = eb.g_e_box.getHigh(s) - cb.getHigh(s);
+
+					eb.l_e_box.setLow(s,eb.l_e_box.getLow(s) + dl);
+					eb.l_e_box.setHigh(s,eb.l_e_box.getHigh(s) - dh);
+
+					// lr_e_box is used only for the boxes that are not the full match
+					if (ebl.get(k) != fm)
+					{
+						eb.lr_e_box.setLow(s,eb.lr_e_box.getLow(s) + dl);
+						eb.lr_e_box.setHigh(s,eb.lr_e_box.getHigh(s) - dh);
+					}
+				}
+				eb.g_e_box = cb;
+
+				ebl_c.add(ebl.get(k));
+			}
+		}
+
+		v_cl.SSendRecv(clip_send,clip_recv,prc,prc_recv,sz_recv);
+
+		// clip the internal ghost boxes
+		for (size_t i = 0 ; i < clip_recv.size() ; i++)
+		{
+			size_t p_id = dec.ProctoID(prc_recv.get(i));
+
+			for (size_t j = 0 ; j < clip_recv.get(i).size() ; j++)
+			{
+				const Box_clip<dim> & bc = clip_recv.get(i).get(j);
+
+				auto key = g_id_to_internal_ghost_box.get(p_id).find(bc.g_id);
+
+				if (key == g_id_to_internal_ghost_box.get(p_id).end())
+				{
+					std::cerr << __FILE__ << ":" << __LINE__ << " Error, the processor " << prc_recv.get(i) << " clipped an internal ghost box that does not exist" << std::endl;
+					continue;
+				}
+
+				Box<dim,long int> & bx = ge.ig_box.get(p_id).bid.get(key->second).box;
+
+				// an invalid box is not sent
+				if (bc.empty == true)
+				{
+					bx.setHigh(0,bx.getLow(0) - 1);
+					continue;
+				}
+
+				for (size_t s = 0 ; s < dim ; s++)
+				{
+					bx.setLow(s,bx.getLow(s) + bc.lo[s]);
+					bx.setHigh(s,bx.getHigh(s) - bc.hi[s]);
+				}
+			}
+		}
+
+		ge.init = true;
+	}
+
+	/*! \brief Check if all the properties use the full ghost
+	 *
+	 * \tparam prp... properties
+	 *
+	 * \return true if no property has a reduced ghost extent
+	 *
+	 */
+	template<int... prp> bool prp_full_ghost()
+	{
+		if (prp_ext.size() == 0)
+		{return true;}
+
+		bool full = true;
+		int dummy[] = {0, (full &= (prp_ext.get(prp) == -1), 0)...};
+		(void)dummy;
+
+		return full;
+	}
+
+	//! list of properties
+	template<int... prp> struct prp_list {};
+
+	//! Maximum number of properties of a ghost_get grouped by ghost extent (2^n exchange functions are instantiated)
+	static constexpr int ghost_ext_max_group = 4;
+
+	/*! \brief Synchronize the ghost of the selected properties with the ghost extent c
+	 *
+	 * \tparam sel properties of the extent c
+	 *
+	 * \param c ghost extent (-1 the full ghost)
+	 * \param opt options
+	 *
+	 */
+	template<int... sel> void ghost_get_group(long int c, size_t opt, prp_list<sel...>, prp_list<>)
+	{
+		if (c == -1)
+		{
+			grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid>::template ghost_get_<sel...>(ig_box,eg_box,loc_ig_box,loc_eg_box,gdb_ext,eb_gid_list,
+																									  use_bx_def,loc_grid,ginfo_v,g_id_to_external_ghost_box,opt);
+			return;
+		}
+
+		create_ghost_ext(c);
+
+		auto & ge = gh_ext.get(c);
+
+		grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid>::template ghost_get_<sel...>(ge.ig_box,ge.eg_box,loc_ig_box,loc_eg_box,gdb_ext,ge.eb_gid_list,
+																								  use_bx_def,loc_grid,ginfo_v,g_id_to_external_ghost_box,opt);
+	}
+
+	/*! \brief No property has the ghost extent
+	 *
+	 */
+	void ghost_get_group(long int c, size_t opt, prp_list<>, prp_list<>)
+	{}
+
+	/*! \brief Select from the properties to check the ones with the ghost extent c
+	 *
+	 * \tparam sel properties already selected
+	 * \tparam p property to check
+	 * \tparam rest properties still to check
+	 *
+	 * \param c ghost extent (-1 the full ghost)
+	 * \param opt options
+	 *
+	 */
+	template<int... sel, int p, int... rest> void ghost_get_group(long int c, size_t opt, prp_list<sel...>, prp_list<p,rest...>)
+	{
+		if (prp_ext.get(p) == c)
+		{ghost_get_group(c,opt,prp_list<sel...,p>(),prp_list<rest...>());}
+		else
+		{ghost_get_group(c,opt,prp_list<sel...>(),prp_list<rest...>());}
+	}
+
+	/*! \brief Add the ghost extent of a property to the list of the extents (if not present)
+	 *
+	 * \param cls list of the extents
+	 * \param c extent
+	 *
+	 */
+	void add_ghost_ext_class(openfpm::vector<long int> & cls, long int c)
+	{
+		for (size_t i = 0 ; i < cls.size() ; i++)
+		{
+			if (cls.get(i) == c)
+			{return;}
+		}
+
+		cls.add(c);
+	}
+
+	/*! \brief Synchronize the ghost of the properties with their ghost extents, one exchange for each extent
+	 *
+	 * \tparam prp properties
+	 *
+	 * \param opt options
+	 *
+	 */
+	template<int... prp> void ghost_get_ext(size_t opt, std::true_type)
+	{
+		openfpm::vector<long int> cls;
+
+		int dummy[] = {0, (add_ghost_ext_class(cls,prp_ext.get(prp)), 0)...};
+		(void)dummy;
+
+		for (size_t i = 0 ; i < cls.size() ; i++)
+		{ghost_get_group(cls.get(i),opt,prp_list<>(),prp_list<prp...>());}
+	}
+
+	/*! \brief Synchronize the ghost of the properties with their ghost extents, one exchange for each property
+	 *
+	 * It is used when the properties are too many to be grouped
+	 *
+	 * \tparam prp properties
+	 *
+	 * \param opt options
+	 *
+	 */
+	template<int... prp> void ghost_get_ext(size_t opt, std::false_type)
+	{
+		int dummy[] = {0, (ghost_get_group(prp_ext.get(prp),opt,prp_list<>(),prp_list<prp>()), 0)...};
+		(void)dummy;
+	}
+
 	/*! \brief Create local internal ghost box in grid units
 	 *
 	 */
@@ -1272,6 +1709,14 @@ protected:
 
 		init_local_e_g_box = false;
 		loc_eg_box.clear();
+
+		for (size_t i = 0 ; i < gh_ext.size() ; i++)
+		{
+			gh_ext.get(i).ig_box.clear();
+			gh_ext.get(i).eg_box.clear();
+			gh_ext.get(i).eb_gid_list.clear();
+			gh_ext.get(i).init = false;
+		}
 	}
 
 public:
@@ -1429,6 +1874,10 @@ public:
 
 		for (size_t i = 0 ; i < dim ; i++)
 		{g_sz[i] = g.g_sz[i];}
+
+		n_out_agg = g.n_out_agg;
+		dh_radius = g.dh_radius;
+		dh_k = g.dh_k;
 	}
 
 	/*! \brief This constructor is special, it construct an expanded grid that perfectly overlap with the previous
@@ -2029,35 +2478,101 @@ public:
 		it.template launch<1>(launch_insert_sparse(),f1,f2);
 	}
 
-	/*! /brief Get a grid Iterator in GPU
-	 *
-	 * In case of dense grid getGridIterator is equivalent to getDomainIteratorGPU
-	 * in case of sparse distributed grid getDomainIterator go across all the
-	 * inserted point getGridIteratorGPU run across all grid points independently
-	 * that the point has been insert or not
-	 *
-	 * \param start point
-	 * \param stop point
-	 *
-	 * \return a Grid iterator
-	 *
-	 */
-	inline grid_dist_id_iterator_gpu<Decomposition,openfpm::vector<device_grid>>
-	getGridIteratorGPU(const grid_key_dx<dim> & start, const grid_key_dx<dim> & stop)
+#else
+
+	/*! \brief Insert point in the grid
+	*
+	* The points are collected in parallel chunk by chunk and inserted in the local grids in one
+	* pass (see bulk_insert_box). It is the host counterpart of the GPU addPoints, f1 and f2 have
+	* the same signature, f1(i,j,k) and f2(data,i,j,k), and no flush is required after it
+	*
+	* \snippet sgrid_dist_id_unit_tests.cpp bulk insert addPoints
+	*
+	* \param f1 lambda function to insert point
+	* \param f2 lambda function to set points
+	*/
+	template<typename lambda_t1, typename lambda_t2>
+	void addPoints(lambda_t1 f1, lambda_t2 f2)
 	{
-		grid_dist_id_iterator_gpu<Decomposition,openfpm::vector<device_grid>> it_dec(loc_grid,getDecomposition(), g_sz, start, stop);
-		return it_dec;
+		grid_key_dx<dim> k1;
+		grid_key_dx<dim> k2;
+
+		for (size_t j = 0 ; j < dim ; j++)
+		{
+			k1.set_d(j,0);
+			k2.set_d(j,ginfo.size(j) - 1);
+		}
+
+		addPoints(k1,k2,f1,f2);
 	}
 
-	/*! /brief Get a grid Iterator in GPU
-	 *
-	 * In case of dense grid getGridIterator is equivalent to getDomainIteratorGPU
-	 * in case of sparse distributed grid getDomainIterator go across all the
-	 * inserted point getGridIteratorGPU run across all grid points independently
-	 * that the point has been insert or not
-	 *
-	 * \return a Grid iterator
-	 *
+	/*! \brief Insert point in the grid between start and stop
+	*
+	* \param start point
+	* \param stop point
+	* \param f1 lambda function to insert point
+	* \param f2 lambda function to set points
+	*/
+	template<typename lambda_t1, typename lambda_t2>
+	void addPoints(grid_key_dx<dim> k1, grid_key_dx<dim> k2, lambda_t1 f1, lambda_t2 f2)
+	{
+		for (size_t i = 0 ; i < loc_grid.size() ; i++)
+		{
+			Box<dim,long int> base;
+			Box<dim,long int> inte;
+
+			for (size_t j = 0 ; j < dim ; j++)
+			{
+				base.setLow(j,(long int)k1.get(j) - (long int)gdb_ext.get(i).origin.get(j));
+				base.setHigh(j,(long int)k2.get(j) - (long int)gdb_ext.get(i).origin.get(j));
+			}
+
+			Box<dim,long int> dom = gdb_ext.get(i).Dbox;
+
+			if (dom.Intersect(base,inte) == false)
+			{continue;}
+
+			grid_key_dx<dim> origin;
+			for (size_t j = 0 ; j < dim ; j++)
+			{origin.set_d(j,gdb_ext.get(i).origin.get(j));}
+
+			bulk_insert_box<dim>(loc_grid.get(i),inte,origin,f1,f2);
+		}
+	}
+
+#endif
+
+#ifdef __NVCC__
+
+	/*! /brief Get a grid Iterator in GPU
+	 *
+	 * In case of dense grid getGridIterator is equivalent to getDomainIteratorGPU
+	 * in case of sparse distributed grid getDomainIterator go across all the
+	 * inserted point getGridIteratorGPU run across all grid points independently
+	 * that the point has been insert or not
+	 *
+	 * \param start point
+	 * \param stop point
+	 *
+	 * \return a Grid iterator
+	 *
+	 */
+	inline grid_dist_id_iterator_gpu<Decomposition,openfpm::vector<device_grid>>
+	getGridIteratorGPU(const grid_key_dx<dim> & start, const grid_key_dx<dim> & stop)
+	{
+		grid_dist_id_iterator_gpu<Decomposition,openfpm::vector<device_grid>> it_dec(loc_grid,getDecomposition(), g_sz, start, stop);
+		return it_dec;
+	}
+
+	/*! /brief Get a grid Iterator in GPU
+	 *
+	 * In case of dense grid getGridIterator is equivalent to getDomainIteratorGPU
+	 * in case of sparse distributed grid getDomainIterator go across all the
+	 * inserted point getGridIteratorGPU run across all grid points independently
+	 * that the point has been insert or not
+	 *
+	 * \return a Grid iterator
+	 *
 	 */
 	inline grid_dist_id_iterator_gpu<Decomposition,openfpm::vector<device_grid>>
 	getGridIteratorGPU()
@@ -2133,6 +2648,134 @@ public:
 		return it;
 	}
 
+	/*! \brief Divide the domain of the local grids in slabs along the last dimension
+	 *
+	 * \param slab thickness of each slab (0 = automatic)
+	 * \param slabs box of each slab in local grid coordinates
+	 * \param slabs_sub local grid of each slab
+	 *
+	 */
+	void get_domain_slabs(size_t slab, openfpm::vector<Box<dim,long int>> & slabs, openfpm::vector<size_t> & slabs_sub)
+	{
+		if (slab == 0)
+		{
+			// automatic, try to have at least 4 slabs for each thread
+			size_t n_plane = 0;
+			for (size_t i = 0 ; i < gdb_ext.size() ; i++)
+			{
+				if (gdb_ext.get(i).Dbox.isValid() == true)
+				{n_plane += gdb_ext.get(i).Dbox.getHigh(dim-1) - gdb_ext.get(i).Dbox.getLow(dim-1) + 1;}
+			}
+
+			slab = n_plane / (4*pdata_threads_number());
+			slab = (slab == 0)?1:slab;
+		}
+
+		for (size_t i = 0 ; i < gdb_ext.size() ; i++)
+		{
+			Box<dim,long int> bx = gdb_ext.get(i).Dbox;
+
+			if (bx.isValid() == false)
+			{continue;}
+
+			for (long int s = bx.getLow(dim-1) ; s <= bx.getHigh(dim-1) ; s += slab)
+			{
+				Box<dim,long int> sb = bx;
+
+				sb.setLow(dim-1,s);
+				sb.setHigh(dim-1,(s + (long int)slab - 1 < bx.getHigh(dim-1))?s + (long int)slab - 1:bx.getHigh(dim-1));
+
+				slabs.add(sb);
+				slabs_sub.add(i);
+			}
+		}
+	}
+
+	/*! \brief Apply a function to all the domain points using a pool of threads
+	 *
+	 * The domain of every local grid is divided in slabs along the last dimension, the slabs are
+	 * executed as tasks by the threads, and idle threads steal the pending slabs
+	 *
+	 * \warning f is called concurrently, it must write only on the point it receive
+	 *
+	 * \param f function f(key) applied to every domain point, key is the same type of getDomainIterator().get()
+	 * \param slab thickness of each slab in grid points (0 = automatic)
+	 *
+	 */
+	template<typename lambda_t>
+	void for_each_parallel(lambda_t f, size_t slab = 0)
+	{
+#ifdef SE_CLASS2
+		check_valid(this,8);
+#endif
+
+		openfpm::vector<Box<dim,long int>> slabs;
+		openfpm::vector<size_t> slabs_sub;
+
+		get_domain_slabs(slab,slabs,slabs_sub);
+
+		auto fs = [&](size_t s, int thr)
+		{
+			size_t i = slabs_sub.get(s);
+
+			auto it = loc_grid.get(i).getIterator(slabs.get(s).getKP1(),slabs.get(s).getKP2());
+
+			while (it.isNext())
+			{
+				auto key = it.get();
+
+				f(grid_dist_key_dx<dim,typename std::remove_const<decltype(key)>::type>(i,key));
+
+				++it;
+			}
+		};
+
+		parallel_work_items(slabs.size(),fs);
+	}
+
+	/*! \brief Apply a function to all the domain points using a pool of threads and reduce the results
+	 *
+	 * Every thread accumulate into its own partial result, the partial results are reduced with op at the end
+	 *
+	 * \param init identity of the reduction (for example 0 for a sum)
+	 * \param f function f(key,T & partial) applied to every domain point
+	 * \param op reduction op(a,b) that return the reduction of a and b
+	 * \param slab thickness of each slab in grid points (0 = automatic)
+	 *
+	 * \return the result of the reduction
+	 *
+	 */
+	template<typename T_red, typename lambda_t, typename reduce_t>
+	T_red for_each_parallel_reduce(const T_red & init, lambda_t f, reduce_t op, size_t slab = 0)
+	{
+#ifdef SE_CLASS2
+		check_valid(this,8);
+#endif
+
+		openfpm::vector<Box<dim,long int>> slabs;
+		openfpm::vector<size_t> slabs_sub;
+
+		get_domain_slabs(slab,slabs,slabs_sub);
+
+		auto fs = [&](size_t s, T_red & partial)
+		{
+			size_t i = slabs_sub.get(s);
+
+			auto it = loc_grid.get(i).getIterator(slabs.get(s).getKP1(),slabs.get(s).getKP2());
+
+			while (it.isNext())
+			{
+				auto key = it.get();
+
+				f(grid_dist_key_dx<dim,typename std::remove_const<decltype(key)>::type>(i,key),partial);
+
+				++it;
+			}
+		};
+
+		return parallel_work_items_reduce(slabs.size(),init,fs,op);
+	}
+
 	/*! \brief It return an iterator that span the full grid domain (each processor span its local domain)
 	 *
 	 * \param stencil_pnt stencil points
@@ -2610,6 +3253,15 @@ public:
 		// Convert the local external ghost boxes into grid unit boxes
 		create_local_eg_box();
 
+		// the properties with the same ghost extent are synchronized together with the clipped boxes
+		if (prp_full_ghost<prp...>() == false)
+		{
+			ghost_get_ext<prp...>(opt & ~SKIP_LABELLING,std::integral_constant<bool,((int)sizeof...(prp) <= ghost_ext_max_group)>());
+
+			dh_sweep = 0;
+			return;
+		}
+
 		grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid>::template ghost_get_<prp...>(ig_box,
 																								  eg_box,
 																								  loc_ig_box,
@@ -2621,6 +3273,118 @@ public:
 																								  ginfo_v,
 																								  g_id_to_external_ghost_box,
 																								  opt);
+
+		// the ghost is valid again for all the sweeps of the deep halo
+		dh_sweep = 0;
+	}
+
+	/*! \brief Set a reduced ghost extent for a property
+	 *
+	 * ghost_get send for the property only the points inside the sub-domains enlarged by g. The
+	 * extent can be different in every direction and on the two sides of a direction, so for example
+	 * a property of a staggered grid that read only its right neighbor can use a one-sided halo
+	 *
+	 * \code
+	 *
+	 * Ghost<3,long int> g(0);
+	 * g.setHigh(0,1);
+	 *
+	 * g_dist.setPropGhost<1>(g);
+	 *
+	 * \endcode
+	 *
+	 * The properties that share the same extent share the clipped ghost boxes, and a ghost_get
+	 * exchange them together: one exchange for the properties with the full ghost and one for each
+	 * reduced extent (with more than ghost_ext_max_group properties one exchange for each property).
+	 * The points outside the ghost of the grid are never sent, the local ghost (between sub-domains
+	 * of the same processor) is always synchronized in full. ghost_get_start ignore the reduced
+	 * extents and synchronize the full ghost of every property. It is a collective call
+	 *
+	 * \tparam prp property
+	 *
+	 * \param g reduced ghost extent in grid points
+	 *
+	 */
+	template<unsigned int prp> void setPropGhost(const Ghost<dim,long int> & g)
+	{
+		if (prp_ext.size() == 0)
+		{
+			prp_ext.resize(T::max_prop);
+			for (size_t i = 0 ; i < prp_ext.size() ; i++)
+			{prp_ext.get(i) = -1;}
+		}
+
+		for (size_t i = 0 ; i < gh_ext.size() ; i++)
+		{
+			bool eq = true;
+			for (size_t s = 0 ; s < dim ; s++)
+			{eq &= gh_ext.get(i).g.getLow(s) == g.getLow(s) && gh_ext.get(i).g.getHigh(s) == g.getHigh(s);}
+
+			if (eq == true)
+			{
+				prp_ext.get(prp) = i;
+				return;
+			}
+		}
+
+		gh_ext.add();
+		gh_ext.last().g = g;
+		prp_ext.get(prp) = gh_ext.size() - 1;
+	}
+
+	/*! \brief Start a ghost_get, the ghost is synchronized only after ghost_get_finish
+	 *
+	 * It pack and send the internal ghost and post the receives. Calling ghost_get_start on several
+	 * grids before the respective ghost_get_finish overlap their communications
+	 *
+	 * \note the reduced ghost extents set with setPropGhost are ignored, the full ghost of every
+	 *       property is synchronized
+	 *
+	 * \tparam prp... Properties to synchronize
+	 *
+	 * \param opt options
+	 * \param fused the messages are queued and must be exchanged with
+	 *        grid_dist_id_comm::fused_sendrecv before ghost_get_finish
+	 *
+	 */
+	template<int... prp> void ghost_get_start(size_t opt = 0, bool fused = false)
+	{
+#ifdef SE_CLASS2
+		check_valid(this,8);
+#endif
+
+		create_ig_box();
+		create_eg_box();
+		create_local_ig_box();
+		create_local_eg_box();
+
+		grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid>::template ghost_get_start_<prp...>(ig_box,
+																										eg_box,
+																										loc_ig_box,
+																										loc_eg_box,
+																										gdb_ext,
+																										use_bx_def,
+																										loc_grid,
+																										ginfo_v,
+																										g_id_to_external_ghost_box,
+																										opt,
+																										fused);
+	}
+
+	/*! \brief Complete a ghost_get started with ghost_get_start
+	 *
+	 * \tparam prp... Properties to synchronize (the same of ghost_get_start)
+	 *
+	 */
+	template<int... prp> void ghost_get_finish()
+	{
+		grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid>::template ghost_get_finish_<prp...>(eg_box,
+																										 eb_gid_list,
+																										 loc_grid,
+																										 g_id_to_external_ghost_box);
+
+		// the ghost is valid again for all the sweeps of the deep halo
+		dh_sweep = 0;
 	}
 
 	/*! \brief It synchronize the ghost parts
@@ -2656,6 +3420,51 @@ public:
 																						  	  	  	 g_id_to_internal_ghost_box);
 	}
 
+	/*! \brief Start a ghost_put, the ghost is merged only after ghost_put_finish
+	 *
+	 * \tparam op merge operation
+	 * \tparam prp... Properties to apply ghost put
+	 *
+	 * \param fused the messages are queued and must be exchanged with
+	 *        grid_dist_id_comm::fused_sendrecv before ghost_put_finish
+	 *
+	 */
+	template<template<typename,typename> class op,int... prp> void ghost_put_start(bool fused = false)
+	{
+#ifdef SE_CLASS2
+		check_valid(this,8);
+#endif
+
+		create_ig_box();
+		create_eg_box();
+		create_local_ig_box();
+		create_local_eg_box();
+
+		grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid>::template ghost_put_start_<op,prp...>(ig_box,
+																										   eg_box,
+																										   loc_ig_box,
+																										   loc_eg_box,
+																										   gdb_ext,
+																										   loc_grid,
+																										   g_id_to_internal_ghost_box,
+																										   fused);
+	}
+
+	/*! \brief Complete a ghost_put started with ghost_put_start
+	 *
+	 * \tparam op merge operation (the same of ghost_put_start)
+	 * \tparam prp... Properties to apply ghost put (the same of ghost_put_start)
+	 *
+	 */
+	template<template<typename,typename> class op,int... prp> void ghost_put_finish()
+	{
+		grid_dist_id_comm<dim,St,T,Decomposition,Memory,device_grid>::template ghost_put_finish_<op,prp...>(dec,
+																											ig_box,
+																											gdb_ext,
+																											loc_grid,
+																											g_id_to_internal_ghost_box);
+	}
+
 
 	/*! \brief Copy the give grid into this grid
 	 *
@@ -2809,62 +3618,212 @@ public:
 		dist.setDistTol(md.distributionTol());
 	}
 
-	/*! \brief apply a convolution using the stencil N
+	/*! \brief Return the region where a convolution is calculated on the local grid i
+	 *
+	 * Without deep halo it is the intersection of start-stop with the domain of the local grid. In deep
+	 * halo mode the domain is enlarged by (k - 1 - s)*radius, where s is the number of sweeps done after
+	 * the last ghost_get. In this way the ghost calculated by one sweep is the input of the next one
 	 *
+	 * \param i local grid
+	 * \param start point where the convolution start (global coordinates)
+	 * \param stop point where the convolution stop (global coordinates)
+	 * \param inte region in local coordinates
+	 *
+	 * \return false if the region is empty
 	 *
 	 */
-	template<unsigned int prop_src, unsigned int prop_dst, unsigned int stencil_size, unsigned int N, typename lambda_f, typename ... ArgsT >
-	void conv(int (& stencil)[N][dim], grid_key_dx<3> start, grid_key_dx<3> stop , lambda_f func, ArgsT ... args)
+	template<typename key_type>
+	bool conv_region(size_t i, const key_type & start, const key_type & stop, Box<dim,long int> & inte)
 	{
-		for (int i = 0 ; i < loc_grid.size() ; i++)
+		Box<dim,long int> base;
+		for (int j = 0 ; j < dim ; j++)
 		{
-			Box<dim,long int> inte;
+			base.setLow(j,(long int)start.get(j) - (long int)gdb_ext.get(i).origin.get(j));
+			base.setHigh(j,(long int)stop.get(j) - (long int)gdb_ext.get(i).origin.get(j));
+		}
+
+		Box<dim,long int> dom = gdb_ext.get(i).Dbox;
+
+		if (dh_radius != 0 && dh_sweep < dh_k)
+		{
+			long int ext = (dh_k - 1 - dh_sweep) * dh_radius;
+			const Box<dim,long int> & gdom = gdb_ext.get(i).GDbox;
 
-			Box<dim,long int> base;
 			for (int j = 0 ; j < dim ; j++)
 			{
-				base.setLow(j,(long int)start.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-				base.setHigh(j,(long int)stop.get(j) - (long int)gdb_ext.get(i).origin.get(j));
+				dom.setLow(j,std::max(dom.getLow(j) - ext,gdom.getLow(j)));
+				dom.setHigh(j,std::min(dom.getHigh(j) + ext,gdom.getHigh(j)));
+
+				// when start-stop touch a periodic boundary the region continue in the periodic image
+				if (dec.periodicity(j) == PERIODIC)
+				{
+					if ((long int)start.get(j) == 0)
+					{base.setLow(j,base.getLow(j) - ext);}
+
+					if ((long int)stop.get(j) == (long int)ginfo.size(j) - 1)
+					{base.setHigh(j,base.getHigh(j) + ext);}
+				}
 			}
+		}
 
-			Box<dim,long int> dom = gdb_ext.get(i).Dbox;
+		return dom.Intersect(base,inte);
+	}
 
-			bool overlap = dom.Intersect(base,inte);
+	/*! \brief Check that the deep halo is not consumed before a convolution sweep
+	 *
+	 * After k sweeps the ghost is not valid anymore, continuing would read outdated values
+	 *
+	 */
+	void conv_sweep_begin()
+	{
+		if (dh_radius != 0 && dh_sweep >= dh_k)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error the deep halo is consumed after " << dh_k << " sweeps, a ghost_get is required" << std::endl;
+			ACTION_ON_ERROR(GRID_DIST_ERROR_OBJECT);
+		}
+	}
 
-			if (overlap == true)
+	/*! \brief Count a convolution sweep in deep halo mode
+	 *
+	 */
+	void conv_sweep_end()
+	{
+		if (dh_radius == 0)
+		{return;}
+
+		dh_sweep++;
+	}
+
+	/*! \brief Activate the deep halo mode (temporal blocking) for the convolutions
+	 *
+	 * With a ghost of k times the stencil radius, one ghost_get is enough for k convolution
+	 * sweeps (conv, conv2, conv_cross ...). Sweep s (counting from 0 after the ghost_get) is
+	 * calculated on the domain enlarged by (k - 1 - s)*radius, so the ghost consumed by one sweep is
+	 * recalculated locally. The last sweep is calculated only on the domain. This trade a little
+	 * of redundant calculation with k times less messages
+	 *
+	 * \snippet sgrid_dist_id_unit_tests.cpp deep halo convolution
+	 *
+	 * A convolution sweep after the halo is consumed, without a ghost_get in between, is an error
+	 *
+	 * \note It is collective
+	 *
+	 * \param radius stencil radius
+	 * \param k number of sweeps for each ghost_get
+	 *
+	 * \return false if the ghost is smaller than k*radius on any processor, in this case deep halo is not activated
+	 *
+	 */
+	bool setDeepHalo(size_t radius, size_t k)
+	{
+		long int needed = radius * k;
+
+		// check that the ghost is big enough on every side facing another sub-domain
+		size_t ok = true;
+
+		for (size_t i = 0 ; i < gdb_ext.size() && ok == true ; i++)
+		{
+			const Box<dim,long int> & dom = gdb_ext.get(i).Dbox;
+			const Box<dim,long int> & gdom = gdb_ext.get(i).GDbox;
+
+			for (size_t j = 0 ; j < dim ; j++)
 			{
-				loc_grid.get(i).template conv<prop_src,prop_dst,stencil_size>(stencil,inte.getKP1(),inte.getKP2(),func,args...);
+				bool low_nn = dec.periodicity(j) == PERIODIC || dom.getLow(j) + gdb_ext.get(i).origin.get(j) > 0;
+				bool high_nn = dec.periodicity(j) == PERIODIC || dom.getHigh(j) + gdb_ext.get(i).origin.get(j) < (long int)ginfo.size(j) - 1;
+
+				if ((low_nn == true && dom.getLow(j) - gdom.getLow(j) < needed) ||
+					(high_nn == true && gdom.getHigh(j) - dom.getHigh(j) < needed))
+				{ok = false;}
 			}
 		}
+
+		// all the processors must agree, otherwise some of them would skip the ghost_get
+		v_cl.min(ok);
+		v_cl.execute();
+
+		if (ok == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error deep halo require a ghost of at least " << needed << " points" << std::endl;
+			return false;
+		}
+
+		dh_radius = radius;
+		dh_k = k;
+
+		// a ghost_get is required before the first sweep
+		dh_sweep = k;
+
+		return true;
+	}
+
+	/*! \brief Deactivate the deep halo mode
+	 *
+	 */
+	void unsetDeepHalo()
+	{
+		dh_radius = 0;
+		dh_k = 1;
+		dh_sweep = 0;
+	}
+
+	/*! \brief Return true if a ghost_get is required before the next convolution
+	 *
+	 * Without deep halo it always return true
+	 *
+	 * \return true if the ghost must be synchronized
+	 *
+	 */
+	bool needGhostGet() const
+	{
+		return dh_radius == 0 || dh_sweep >= dh_k;
 	}
 
 	/*! \brief apply a convolution using the stencil N
 	 *
 	 *
 	 */
-	template<unsigned int prop_src, unsigned int prop_dst, unsigned int stencil_size, typename lambda_f, typename ... ArgsT >
-	void conv_cross(grid_key_dx<3> start, grid_key_dx<3> stop , lambda_f func, ArgsT ... args)
+	template<unsigned int prop_src, unsigned int prop_dst, unsigned int stencil_size, unsigned int N, typename lambda_f, typename ... ArgsT >
+	void conv(int (& stencil)[N][dim], grid_key_dx<3> start, grid_key_dx<3> stop , lambda_f func, ArgsT ... args)
 	{
+		conv_sweep_begin();
+
 		for (int i = 0 ; i < loc_grid.size() ; i++)
 		{
 			Box<dim,long int> inte;
 
-			Box<dim,long int> base;
-			for (int j = 0 ; j < dim ; j++)
+			bool overlap = conv_region(i,start,stop,inte);
+
+			if (overlap == true)
 			{
-				base.setLow(j,(long int)start.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-				base.setHigh(j,(long int)stop.get(j) - (long int)gdb_ext.get(i).origin.get(j));
+				loc_grid.get(i).template conv<prop_src,prop_dst,stencil_size>(stencil,inte.getKP1(),inte.getKP2(),func,args...);
 			}
+		}
 
-			Box<dim,long int> dom = gdb_ext.get(i).Dbox;
+		conv_sweep_end();
+	}
+
+	/*! \brief apply a convolution using the stencil N
+	 *
+	 *
+	 */
+	template<unsigned int prop_src, unsigned int prop_dst, unsigned int stencil_size, typename lambda_f, typename ... ArgsT >
+	void conv_cross(grid_key_dx<3> start, grid_key_dx<3> stop , lambda_f func, ArgsT ... args)
+	{
+		conv_sweep_begin();
+
+		for (int i = 0 ; i < loc_grid.size() ; i++)
+		{
+			Box<dim,long int> inte;
 
-			bool overlap = dom.Intersect(base,inte);
+			bool overlap = conv_region(i,start,stop,inte);
 
 			if (overlap == true)
 			{
 				loc_grid.get(i).template conv_cross<prop_src,prop_dst,stencil_size>(inte.getKP1(),inte.getKP2(),func,args...);
 			}
 		}
+
+		conv_sweep_end();
 	}
 
 	/*! \brief apply a convolution using the stencil N
@@ -2874,26 +3833,21 @@ public:
 	template<unsigned int prop_src, unsigned int prop_dst, unsigned int stencil_size, typename lambda_f, typename ... ArgsT >
 	void conv_cross_b(grid_key_dx<3> start, grid_key_dx<3> stop , lambda_f func, ArgsT ... args)
 	{
+		conv_sweep_begin();
+
 		for (int i = 0 ; i < loc_grid.size() ; i++)
 		{
 			Box<dim,long int> inte;
 
-			Box<dim,long int> base;
-			for (int j = 0 ; j < dim ; j++)
-			{
-				base.setLow(j,(long int)start.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-				base.setHigh(j,(long int)stop.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-			}
-
-			Box<dim,long int> dom = gdb_ext.get(i).Dbox;
-
-			bool overlap = dom.Intersect(base,inte);
+			bool overlap = conv_region(i,start,stop,inte);
 
 			if (overlap == true)
 			{
 				loc_grid.get(i).template conv_cross_b<prop_src,prop_dst,stencil_size>(inte.getKP1(),inte.getKP2(),func,args...);
 			}
 		}
+
+		conv_sweep_end();
 	}
 
 	/*! \brief apply a convolution using the stencil N
@@ -2903,26 +3857,21 @@ public:
 	template<unsigned int stencil_size, typename v_type, typename lambda_f, typename ... ArgsT >
 	void conv_cross_ids(grid_key_dx<3> start, grid_key_dx<3> stop , lambda_f func, ArgsT ... args)
 	{
+		conv_sweep_begin();
+
 		for (int i = 0 ; i < loc_grid.size() ; i++)
 		{
 			Box<dim,long int> inte;
 
-			Box<dim,long int> base;
-			for (int j = 0 ; j < dim ; j++)
-			{
-				base.setLow(j,(long int)start.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-				base.setHigh(j,(long int)stop.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-			}
-
-			Box<dim,long int> dom = gdb_ext.get(i).Dbox;
-
-			bool overlap = dom.Intersect(base,inte);
+			bool overlap = conv_region(i,start,stop,inte);
 
 			if (overlap == true)
 			{
 				loc_grid.get(i).template conv_cross_ids<stencil_size,v_type>(inte.getKP1(),inte.getKP2(),func,args...);
 			}
 		}
+
+		conv_sweep_end();
 	}
 
 	/*! \brief apply a convolution using the stencil N
@@ -2932,26 +3881,21 @@ public:
 	template<unsigned int prop_src1, unsigned int prop_src2, unsigned int prop_dst1, unsigned int prop_dst2, unsigned int stencil_size, unsigned int N, typename lambda_f, typename ... ArgsT >
 	void conv2(int (& stencil)[N][dim], grid_key_dx<dim> start, grid_key_dx<dim> stop , lambda_f func, ArgsT ... args)
 	{
+		conv_sweep_begin();
+
 		for (int i = 0 ; i < loc_grid.size() ; i++)
 		{
 			Box<dim,long int> inte;
 
-			Box<dim,long int> base;
-			for (int j = 0 ; j < dim ; j++)
-			{
-				base.setLow(j,(long int)start.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-				base.setHigh(j,(long int)stop.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-			}
-
-			Box<dim,long int> dom = gdb_ext.get(i).Dbox;
-
-			bool overlap = dom.Intersect(base,inte);
+			bool overlap = conv_region(i,start,stop,inte);
 
 			if (overlap == true)
 			{
 				loc_grid.get(i).template conv2<prop_src1,prop_src2,prop_dst1,prop_dst2,stencil_size>(stencil,inte.getKP1(),inte.getKP2(),func,create_vcluster().rank(),args...);
 			}
 		}
+
+		conv_sweep_end();
 	}
 
 	/*! \brief apply a convolution on 2 property on GPU
@@ -2961,26 +3905,21 @@ public:
 	template<unsigned int prop_src1, unsigned int prop_src2, unsigned int prop_dst1, unsigned int prop_dst2, unsigned int stencil_size, typename lambda_f, typename ... ArgsT >
 	void conv2(grid_key_dx<dim> start, grid_key_dx<dim> stop , lambda_f func, ArgsT ... args)
 	{
+		conv_sweep_begin();
+
 		for (int i = 0 ; i < loc_grid.size() ; i++)
 		{
 			Box<dim,long int> inte;
 
-			Box<dim,long int> base;
-			for (int j = 0 ; j < dim ; j++)
-			{
-				base.setLow(j,(long int)start.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-				base.setHigh(j,(long int)stop.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-			}
-
-			Box<dim,long int> dom = gdb_ext.get(i).Dbox;
-
-			bool overlap = dom.Intersect(base,inte);
+			bool overlap = conv_region(i,start,stop,inte);
 
 			if (overlap == true)
 			{
 				loc_grid.get(i).template conv2<prop_src1,prop_src2,prop_dst1,prop_dst2,stencil_size>(inte.getKP1(),inte.getKP2(),func,args...);
 			}
 		}
+
+		conv_sweep_end();
 	}
 
 	/*! \brief apply a convolution on GPU
@@ -2990,26 +3929,21 @@ public:
 	template<unsigned int prop_src1, unsigned int prop_dst1, unsigned int stencil_size, typename lambda_f, typename ... ArgsT >
 	void conv(grid_key_dx<dim> start, grid_key_dx<dim> stop , lambda_f func, ArgsT ... args)
 	{
+		conv_sweep_begin();
+
 		for (int i = 0 ; i < loc_grid.size() ; i++)
 		{
 			Box<dim,long int> inte;
 
-			Box<dim,long int> base;
-			for (int j = 0 ; j < dim ; j++)
-			{
-				base.setLow(j,(long int)start.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-				base.setHigh(j,(long int)stop.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-			}
-
-			Box<dim,long int> dom = gdb_ext.get(i).Dbox;
-
-			bool overlap = dom.Intersect(base,inte);
+			bool overlap = conv_region(i,start,stop,inte);
 
 			if (overlap == true)
 			{
 				loc_grid.get(i).template conv<prop_src1,prop_dst1,stencil_size>(inte.getKP1(),inte.getKP2(),func,args...);
 			}
 		}
+
+		conv_sweep_end();
 	}
 
 	/*! \brief apply a convolution on 2 property on GPU
@@ -3019,26 +3953,21 @@ public:
 	template<unsigned int prop_src1, unsigned int prop_src2, unsigned int prop_dst1, unsigned int prop_dst2, unsigned int stencil_size, typename lambda_f, typename ... ArgsT >
 	void conv2_b(grid_key_dx<dim> start, grid_key_dx<dim> stop , lambda_f func, ArgsT ... args)
 	{
+		conv_sweep_begin();
+
 		for (int i = 0 ; i < loc_grid.size() ; i++)
 		{
 			Box<dim,long int> inte;
 
-			Box<dim,long int> base;
-			for (int j = 0 ; j < dim ; j++)
-			{
-				base.setLow(j,(long int)start.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-				base.setHigh(j,(long int)stop.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-			}
-
-			Box<dim,long int> dom = gdb_ext.get(i).Dbox;
-
-			bool overlap = dom.Intersect(base,inte);
+			bool overlap = conv_region(i,start,stop,inte);
 
 			if (overlap == true)
 			{
 				loc_grid.get(i).template conv2_b<prop_src1,prop_src2,prop_dst1,prop_dst2,stencil_size>(inte.getKP1(),inte.getKP2(),func,args...);
 			}
 		}
+
+		conv_sweep_end();
 	}
 
 		/*! \brief apply a convolution on 2 property on GPU
@@ -3050,26 +3979,21 @@ public:
 			 unsigned int stencil_size, typename lambda_f, typename ... ArgsT >
 	void conv3_b(grid_key_dx<dim> start, grid_key_dx<dim> stop , lambda_f func, ArgsT ... args)
 	{
+		conv_sweep_begin();
+
 		for (int i = 0 ; i < loc_grid.size() ; i++)
 		{
 			Box<dim,long int> inte;
 
-			Box<dim,long int> base;
-			for (int j = 0 ; j < dim ; j++)
-			{
-				base.setLow(j,(long int)start.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-				base.setHigh(j,(long int)stop.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-			}
-
-			Box<dim,long int> dom = gdb_ext.get(i).Dbox;
-
-			bool overlap = dom.Intersect(base,inte);
+			bool overlap = conv_region(i,start,stop,inte);
 
 			if (overlap == true)
 			{
 				loc_grid.get(i).template conv3_b<prop_src1,prop_src2,prop_src3,prop_dst1,prop_dst2,prop_dst3,stencil_size>(inte.getKP1(),inte.getKP2(),func,args...);
 			}
 		}
+
+		conv_sweep_end();
 	}
 	
     template<typename NNtype>
@@ -3088,26 +4012,70 @@ public:
 	template<unsigned int prop_src1, unsigned int prop_src2, unsigned int prop_dst1, unsigned int prop_dst2, unsigned int stencil_size, typename lambda_f, typename ... ArgsT >
 	void conv_cross2(grid_key_dx<3> start, grid_key_dx<3> stop , lambda_f func, ArgsT ... args)
 	{
+		conv_sweep_begin();
+
 		for (int i = 0 ; i < loc_grid.size() ; i++)
 		{
 			Box<dim,long int> inte;
 
-			Box<dim,long int> base;
-			for (int j = 0 ; j < dim ; j++)
+			bool overlap = conv_region(i,start,stop,inte);
+
+			if (overlap == true)
 			{
-				base.setLow(j,(long int)start.get(j) - (long int)gdb_ext.get(i).origin.get(j));
-				base.setHigh(j,(long int)stop.get(j) - (long int)gdb_ext.get(i).origin.get(j));
+				loc_grid.get(i).template conv_cross2<prop_src1,prop_src2,prop_dst1,prop_dst2,stencil_size>(inte.getKP1(),inte.getKP2(),func,args...);
 			}
+		}
 
-			Box<dim,long int> dom = gdb_ext.get(i).Dbox;
+		conv_sweep_end();
+	}
 
-			bool overlap = dom.Intersect(base,inte);
+	/*! \brief Apply a stencil that read and write any number of properties in one pass
+	 *
+	 * Differently from conv, conv2, conv3_b ... the number of properties and the dimensionality
+	 * are not fixed. The lambda receive a stencil object s, s.template get<p>() return the property p
+	 * on the point, s.template get<p>(o_0,...,o_dim-1) the property p on the point shifted by the offsets.
+	 * Computing several fields in the same sweep read every neighborhood only once. The local grids
+	 * are processed in tiles (blk points along every dimension except the first) in parallel, the points
+	 * along the first dimension are visited with a contiguous loop on raw pointers.
+	 * Only dense grids with linear layout are supported
+	 *
+	 * \snippet grid_dist_id_unit_test.cpp fused stencil conv_n
+	 *
+	 * \warning the properties written must be different from the properties read with an offset
+	 *
+	 * \tparam stencil_size maximum offset of the stencil
+	 *
+	 * \param start point where the convolution start (global coordinates)
+	 * \param stop point where the convolution stop (global coordinates)
+	 * \param func lambda [](auto & s){...}
+	 * \param blk tile size
+	 *
+	 */
+	template<unsigned int stencil_size, typename lambda_f>
+	void conv_n(grid_key_dx<dim> start, grid_key_dx<dim> stop , lambda_f func, size_t blk = 8)
+	{
+		static_assert(device_grid::isCompressed() == false, "conv_n support only dense grids");
+		static_assert(is_layout_inte<typename device_grid::layout_base_>::value == false, "conv_n support only grids with linear layout");
+
+		conv_sweep_begin();
+
+		for (int i = 0 ; i < loc_grid.size() ; i++)
+		{
+			Box<dim,long int> inte;
+
+			bool overlap = conv_region(i,start,stop,inte);
 
 			if (overlap == true)
 			{
-				loc_grid.get(i).template conv_cross2<prop_src1,prop_src2,prop_dst1,prop_dst2,stencil_size>(inte.getKP1(),inte.getKP2(),func,args...);
+				grid_key_dx<dim> origin;
+				for (size_t j = 0 ; j < dim ; j++)
+				{origin.set_d(j,gdb_ext.get(i).origin.get(j));}
+
+				conv_n_box<dim,stencil_size,T::max_prop>(loc_grid.get(i),inte,origin,func,blk);
 			}
 		}
+
+		conv_sweep_end();
 	}
 
 	/*! \brief Write the distributed grid information
@@ -3132,6 +4100,9 @@ public:
 		if (opt & FORMAT_BINARY)
 		{ft = file_type::BINARY;}
 
+		if (n_out_agg != 0 && device_grid::isCompressed() == false && (opt & PRINT_GHOST) == 0)
+		{return write_aggregated(output,ft);}
+
 		// Create a writer and write
 		VTKWriter<boost::mpl::pair<device_grid,float>,VECTOR_GRIDS> vtk_g;
 		for (size_t i = 0 ; i < loc_grid.size() ; i++)
@@ -3148,6 +4119,187 @@ public:
 		return true;
 	}
 
+	/*! \brief Set the number of processors that aggregate the output
+	 *
+	 * When n_agg is different from zero, write and write_frame do not produce one file for each processor.
+	 * The processors are divided in n_agg contiguous groups, the first processor of each group
+	 * gather the domain part of the local grids of the group and write them into one file, processor 0
+	 * write one index (.visit) file that reference the aggregated files.
+	 * Sparse grids and the option PRINT_GHOST are always written one file for each processor
+	 *
+	 * \param n_agg number of aggregators (0 disable the aggregation)
+	 *
+	 */
+	void setOutputAggregators(size_t n_agg)
+	{
+		n_out_agg = n_agg;
+	}
+
+	/*! \brief Get the number of processors that aggregate the output
+	 *
+	 * \return the number of aggregators (0 = each processor write its own file)
+	 *
+	 */
+	size_t getOutputAggregators() const
+	{
+		return n_out_agg;
+	}
+
+	/*! \brief Write the distributed grid gathering the local grids into the aggregator processors
+	 *
+	 * The file produced by the aggregator of the group g is output_g.vtk (output_g_frame.vtk for a frame),
+	 * the index output.visit (output_frame.visit) list the files of all the groups
+	 *
+	 * \param output directory where to put the files + prefix
+	 * \param ft ASCII or BINARY
+	 * \param frame frame number (-1 if it is not a frame)
+	 *
+	 * \return true if the write operation succeed
+	 *
+	 */
+	bool write_aggregated(std::string output, file_type ft, long int frame = -1)
+	{
+		size_t n_agg = (n_out_agg > v_cl.size())?v_cl.size():n_out_agg;
+
+		// size of each group, number of groups and aggregator of this processor
+		size_t g_sz = (v_cl.size() + n_agg - 1) / n_agg;
+		size_t n_grp = (v_cl.size() + g_sz - 1) / g_sz;
+		size_t grp = v_cl.rank() / g_sz;
+		size_t agg = grp * g_sz;
+
+		std::string sfx = (frame == -1)?std::string(""):"_" + std::to_string(frame);
+
+		openfpm::vector<openfpm::vector<Box<dim,long int>>> s_box;
+		openfpm::vector<openfpm::vector<T>> s_data;
+
+		// boxes (in global grid coordinates) and points gathered by the aggregator
+		openfpm::vector<Box<dim,long int>> a_box;
+		openfpm::vector<T> a_data;
+
+		openfpm::vector<size_t> prc_send;
+		openfpm::vector<size_t> prc_recv;
+		openfpm::vector<size_t> sz_recv;
+
+		// The aggregator write its own grids directly into the gathering buffer
+		openfpm::vector<Box<dim,long int>> * box_dst = &a_box;
+		openfpm::vector<T> * data_dst = &a_data;
+
+		if (v_cl.rank() != agg)
+		{
+			s_box.resize(1);
+			s_data.resize(1);
+
+			box_dst = &s_box.get(0);
+			data_dst = &s_data.get(0);
+
+			prc_send.add(agg);
+		}
+
+		for (size_t i = 0 ; i < loc_grid.size() ; i++)
+		{
+			Box<dim,long int> bx = gdb_ext.get(i).Dbox;
+
+			if (bx.isValid() == false)
+			{continue;}
+
+			auto it = loc_grid.get(i).getIterator(bx.getKP1(),bx.getKP2());
+
+			while (it.isNext())
+			{
+				auto key = it.get();
+
+				data_dst->add();
+				auto src = loc_grid.get(i).get_o(key);
+				auto dst = data_dst->last();
+
+				copy_all_prop_encap<T,decltype(src),decltype(dst)> cp(src,dst);
+				boost::mpl::for_each_ref<boost::mpl::range_c<int,0,T::max_prop>>(cp);
+
+				++it;
+			}
+
+			for (size_t j = 0 ; j < dim ; j++)
+			{
+				bx.setLow(j,bx.getLow(j) + gdb_ext.get(i).origin.get(j));
+				bx.setHigh(j,bx.getHigh(j) + gdb_ext.get(i).origin.get(j));
+			}
+
+			box_dst->add(bx);
+		}
+
+		// Boxes and points are received in the same processor order
+		v_cl.SSendRecv(s_box,a_box,prc_send,prc_recv,sz_recv);
+		v_cl.SSendRecv(s_data,a_data,prc_send,prc_recv,sz_recv);
+
+		bool ret = true;
+
+		if (v_cl.rank() == agg)
+		{
+			openfpm::vector<device_grid> a_grid;
+			a_grid.resize(a_box.size());
+
+			VTKWriter<boost::mpl::pair<device_grid,float>,VECTOR_GRIDS> vtk_g;
+
+			size_t cnt = 0;
+			for (size_t i = 0 ; i < a_box.size() ; i++)
+			{
+				size_t sz[dim];
+				Box<dim,long int> bx_loc;
+				Point<dim,St> offset;
+
+				for (size_t j = 0 ; j < dim ; j++)
+				{
+					sz[j] = a_box.get(i).getHigh(j) - a_box.get(i).getLow(j) + 1;
+					bx_loc.setLow(j,0);
+					bx_loc.setHigh(j,sz[j] - 1);
+					offset.get(j) = a_box.get(i).getLow(j) * spacing(j) + domain.getLow(j);
+				}
+
+				a_grid.get(i).resize(sz);
+
+				auto it = a_grid.get(i).getIterator();
+
+				while (it.isNext())
+				{
+					auto key = it.get();
+
+					auto src = a_data.get(cnt);
+					auto dst = a_grid.get(i).get_o(key);
+
+					copy_all_prop_encap<T,decltype(src),decltype(dst)> cp(src,dst);
+					boost::mpl::for_each_ref<boost::mpl::range_c<int,0,T::max_prop>>(cp);
+
+					++cnt;
+					++it;
+				}
+
+				vtk_g.add(a_grid.get(i),offset,cd_sm.getCellBox().getP2(),bx_loc);
+			}
+
+			ret = vtk_g.write(output + "_" + std::to_string(grp) + sfx + ".vtk", prp_names, "grids", ft);
+		}
+
+		// index of the aggregated files (VisIt multi-block), the names are relative to the index
+		if (v_cl.rank() == 0)
+		{
+			std::string base = output.substr(output.find_last_of('/') + 1);
+			std::ofstream idx(output + sfx + ".visit");
+
+			idx << "!NBLOCKS " << n_grp << "\n";
+			for (size_t i = 0 ; i < n_grp ; i++)
+			{idx << base << "_" << i << sfx << ".vtk\n";}
+
+			ret &= idx.good();
+		}
+
+		// all the processors report the result of the aggregators
+		size_t err = (ret == false);
+		v_cl.max(err);
+		v_cl.execute();
+
+		return err == 0;
+	}
+
 	/*! \brief Write all grids indigually
 	 *
 	 * \param output files
@@ -3193,6 +4345,9 @@ public:
 		if (opt & FORMAT_BINARY)
 			ft = file_type::BINARY;
 
+		if (n_out_agg != 0 && device_grid::isCompressed() == false)
+		{return write_aggregated(output,ft,i);}
+
 		// Create a writer and write
 		VTKWriter<boost::mpl::pair<device_grid,float>,VECTOR_GRIDS> vtk_g;
 		for (size_t i = 0 ; i < loc_grid.size() ; i++)
@@ -3440,11 +4595,22 @@ public:
 	 */
 	void map(size_t opt = 0)
 	{
-		// Save the background values
-		T bv;
+		map_start(opt,false);
+		map_finish();
+	}
 
+	/*! \brief Start a map, the grid parts are received only after map_finish
+	 *
+	 * \param opt options
+	 * \param fused the messages are queued and must be exchanged with
+	 *        grid_dist_id_comm::fused_sendrecv before map_finish
+	 *
+	 */
+	void map_start(size_t opt = 0, bool fused = false)
+	{
+		// Save the background values
 		copy_aggregate_dual<decltype(loc_grid.get(0).getBackgroundValue()),
-				            T> ca(loc_grid.get(0).getBackgroundValue(),bv);
+				            T> ca(loc_grid.get(0).getBackgroundValue(),map_bv);
 
 		boost::mpl::for_each_ref<boost::mpl::range_c<int,0,T::max_prop>>(ca);
 
@@ -3458,10 +4624,19 @@ public:
 
 		getGlobalGridsInfo(gdb_ext_global);
 
+		typedef typename to_int_sequence<0,T::max_prop-1>::type result;
+
+		variadic_caller<result>::call_start(this,dec,cd_sm,loc_grid,loc_grid_old,gdb_ext,gdb_ext_old,gdb_ext_global,opt,fused);
+	}
 
+	/*! \brief Complete a map started with map_start
+	 *
+	 */
+	void map_finish()
+	{
 		typedef typename to_int_sequence<0,T::max_prop-1>::type result;
 
-		variadic_caller<result>::call(this,dec,cd_sm,loc_grid,loc_grid_old,gdb_ext,gdb_ext_old,gdb_ext_global,opt);
+		variadic_caller<result>::call_finish(this,loc_grid,gdb_ext);
 
 		loc_grid_old.clear();
 		loc_grid_old.shrink_to_fit();
@@ -3471,7 +4646,7 @@ public:
 		reset_ghost_structures();
 
 		// Reset the background values
-		setBackgroundValue(bv);
+		setBackgroundValue(map_bv);
 	}
 
 	/*! \brief Save the grid state on HDF5
@@ -3511,35 +4686,38 @@ public:
 		else
 		{
 			device_grid_copy<device_grid::isCompressed()>::pre_load(gdb_ext_old,loc_grid_old,gdb_ext,loc_grid);
-			for (int i = 0 ; i < gdb_ext_old.size() ; i++)
-			{
-					auto & lg = loc_grid_old.get(i);
-					auto it_src = lg.getIterator(gdb_ext_old.get(i).Dbox.getKP1(),gdb_ext_old.get(i).Dbox.getKP2());
-					auto & dg = loc_grid.get(0);
-					grid_key_dx<dim> kp1 = gdb_ext.get(0).Dbox.getKP1();
 
-					grid_key_dx<dim> orig;
-					for (int j = 0 ; j < dim ; j++)
-					{
-							orig.set_d(j,gdb_ext_old.get(i).origin.get(j));
-					}
+			// copy the intersection of every saved grid with every local grid as one box
+			for (size_t i = 0 ; i < gdb_ext_old.size() ; i++)
+			{
+				Box<dim,long int> bx_old = gdb_ext_old.get(i).Dbox;
+				bx_old += gdb_ext_old.get(i).origin;
 
-					while (it_src.isNext())
-					{
-						auto key = it_src.get();
-						grid_key_dx<dim> key_dst;
+				for (size_t j = 0 ; j < gdb_ext.size() ; j++)
+				{
+					Box<dim,long int> bx_new = gdb_ext.get(j).Dbox;
+					bx_new += gdb_ext.get(j).origin;
 
-						for (int j = 0 ; j < dim ; j++)
-						{key_dst.set_d(j,key.get(j) + orig.get(j) + kp1.get(j));}
+					Box<dim,long int> inte;
+					if (bx_old.Intersect(bx_new,inte) == false)
+					{continue;}
 
-						device_grid_copy<device_grid::isCompressed()>::assign(key,key_dst,dg,lg);
+					Box<dim,long int> bx_src = inte;
+					Box<dim,long int> bx_dst = inte;
+					bx_src -= gdb_ext_old.get(i).origin;
+					bx_dst -= gdb_ext.get(j).origin;
 
-						++it_src;
-					}
-
-					dg.template hostToDevice<0>();
+					device_grid_copy<device_grid::isCompressed()>::template copy_box<T,Memory>(loc_grid.get(j),loc_grid_old.get(i),bx_src,bx_dst);
+				}
 			}
+
+			for (size_t j = 0 ; j < loc_grid.size() ; j++)
+			{loc_grid.get(j).template hostToDevice<0>();}
 		}
+
+		loc_grid_old.clear();
+		loc_grid_old.shrink_to_fit();
+		gdb_ext_old.clear();
 	}
 
 	/*! \brief This is a meta-function return which type of sub iterator a grid produce
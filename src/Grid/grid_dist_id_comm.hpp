@@ -10,10 +10,14 @@
 
 #include "Vector/vector_dist_ofb.hpp"
 #include "Grid/copy_grid_fast.hpp"
+#include "Grid/grid_dist_copy_box.hpp"
 #include "grid_dist_util.hpp"
 #include "util/common_pdata.hpp"
 #include "lib/pdata.hpp"
 #include "Grid/grid_common.hpp"
+#include <map>
+
+#define GRID_DIST_ERROR_OBJECT std::runtime_error("Runtime grid distributed error");
 
 
 /*! \brief Unpack selector
@@ -204,6 +208,55 @@ class grid_dist_id_comm
 	//! Receiving option
 	size_t opt;
 
+	//! ghost_get in progress: size to receive from each processor
+	std::vector<size_t> gg_prp_recv;
+
+	//! ghost_get in progress: receiving buffer
+	ExtPreAlloc<Memory> * gg_prRecv_prp = NULL;
+
+	//! ghost_get in progress: option (after the skip labelling check)
+	size_t gg_opt = 0;
+
+	//! ghost_put in progress: size to receive from each processor
+	std::vector<size_t> gp_prp_recv;
+
+	//! ghost_put in progress: sending buffer
+	ExtPreAlloc<Memory> * gp_prAlloc_prp = NULL;
+
+	//! ghost_put in progress: receiving buffer
+	ExtPreAlloc<Memory> * gp_prRecv_prp = NULL;
+
+	//! map in progress: sending buffers
+	openfpm::vector<Memory> mp_send_buffers_;
+
+	//! map in progress: sending buffers (preallocated view)
+	openfpm::vector<ExtPreAlloc<Memory>> mp_send_buffers;
+
+	//! The messages are queued for a fused exchange (fused_sendrecv) even for dense grids
+	bool fs_queue = false;
+
+	//! In a fused exchange the size of the messages is known and they are copied in fs_recv_ptr
+	bool fs_known = false;
+
+	//! In a fused exchange with known size: processor of each expected message
+	openfpm::vector<size_t> fs_recv_prc;
+
+	//! In a fused exchange with known size: where to copy each expected message
+	openfpm::vector<void *> fs_recv_ptr;
+
+	//! In a fused exchange with known size: size of each expected message
+	openfpm::vector<size_t> fs_recv_sz;
+
+	//! Message of a fused exchange (fused_sendrecv)
+	struct fused_recv
+	{
+		//! received messages
+		openfpm::vector_fr<BMemory<Memory>> buf;
+
+		//! processor that sent each message
+		openfpm::vector<size_t> prc;
+	};
+
 	/*! \brief Sync the local ghost part
 	 *
 	 * \tparam prp... properties to sync
@@ -283,7 +336,7 @@ class grid_dist_id_comm
 					auto & gd = loc_grid.get(sub_id_dst_gdb_ext);
 
 					gd.remove(bx_dst);
-					gd.copy_to(loc_grid.get(sub_id_src_gdb_ext),bx_src,bx_dst);
+					grid_copy_box<T,Memory>(gd,loc_grid.get(sub_id_src_gdb_ext),bx_src,bx_dst,opt);
 				}
 			}
 		}
@@ -372,12 +425,13 @@ class grid_dist_id_comm
 	 * This function send or queue the information to the other processor. In case the
 	 * device grid is a compressed format like in multi-resolution the communication is
 	 * queued because the other side does not know the size of the communication. If is
-	 * not compressed the other side know the size so a direct send is done
+	 * not compressed the other side know the size so a direct send is done, unless the
+	 * message is part of a fused exchange
 	 *
 	 */
 	void send_or_queue(size_t prc, char * pointer, char * pointer2)
 	{
-		if (device_grid::isCompressed() == false)
+		if (device_grid::isCompressed() == false && fs_queue == false)
 		{v_cl.send(prc,0,pointer,(char *)pointer2 - (char *)pointer);}
 		else
 		{
@@ -407,6 +461,40 @@ class grid_dist_id_comm
 		return gd->recv_buffers.last().getPointer();
 	}
 
+	/*! \brief Prepare (or not) the grid for a fused exchange
+	 *
+	 * \param fused true if the messages are exchanged by fused_sendrecv
+	 * \param known true if the receiving buffers have known size (registered with recv_or_register)
+	 *
+	 */
+	void fused_reset(bool fused, bool known)
+	{
+		fs_queue = fused;
+		fs_known = known;
+		fs_recv_prc.clear();
+		fs_recv_ptr.clear();
+		fs_recv_sz.clear();
+	}
+
+	/*! \brief Post a receive of known size, or register it for a fused exchange
+	 *
+	 * \param prc processor
+	 * \param ptr where to receive
+	 * \param sz size of the message
+	 *
+	 */
+	void recv_or_register(size_t prc, void * ptr, size_t sz)
+	{
+		if (fs_queue == false)
+		{v_cl.recv(prc,0,ptr,sz);}
+		else
+		{
+			fs_recv_prc.add(prc);
+			fs_recv_ptr.add(ptr);
+			fs_recv_sz.add(sz);
+		}
+	}
+
 	/* Send or queue the the information
 	 *
 	 * This function send or queue the information to the other processor. In case the
@@ -441,7 +529,7 @@ class grid_dist_id_comm
 			for ( size_t i = 0 ; i < eg_box.size() ; i++ )
 			{
 				prRecv_prp.allocate(prp_recv[i]);
-				v_cl.recv(eg_box.get(i).prc,0,prRecv_prp.getPointer(),prp_recv[i]);
+				recv_or_register(eg_box.get(i).prc,prRecv_prp.getPointer(),prp_recv[i]);
 			}
 		}
 		else
@@ -461,20 +549,40 @@ class grid_dist_id_comm
 											 receive_dynamic,this);
 			}
 
-			// Reorder what we received
+			reorder_recv_buffers();
+		}
+	}
 
-			recv_proc.sort();
+	/*! \brief Reorder the dynamically received buffers by processor id
+	 *
+	 */
+	void reorder_recv_buffers()
+	{
+		recv_proc.sort();
 
-			openfpm::vector_fr<BMemory<Memory>> tmp;
-			tmp.resize(recv_proc.size());
+		openfpm::vector_fr<BMemory<Memory>> tmp;
+		tmp.resize(recv_proc.size());
 
-			for (int i = 0 ; i < recv_proc.size() ; i++)
-			{
-				tmp.get(i).swap(recv_buffers.get(recv_proc.get(i).i));
-			}
-
-			recv_buffers.swap(tmp);
+		for (int i = 0 ; i < recv_proc.size() ; i++)
+		{
+			tmp.get(i).swap(recv_buffers.get(recv_proc.get(i).i));
 		}
+
+		recv_buffers.swap(tmp);
+	}
+
+	/*! \brief Callback to allocate the messages of a fused exchange
+	 *
+	 */
+	static void * receive_fused(size_t msg_i ,size_t total_msg, size_t total_p, size_t i, size_t ri, size_t tag, void * ptr)
+	{
+		fused_recv * fr = static_cast<fused_recv *>(ptr);
+
+		fr->buf.add();
+		fr->buf.last().resize(msg_i);
+		fr->prc.add(i);
+
+		return fr->buf.last().getPointer();
 	}
 
 	/* Send or queue the the information
@@ -517,12 +625,12 @@ class grid_dist_id_comm
 			for ( size_t i = 0 ; i < ig_box.size() ; i++ )
 			{
 				prRecv_prp.allocate(prp_recv[i]);
-				v_cl.recv(ig_box.get(i).prc,0,prRecv_prp.getPointer(),prp_recv[i]);
+				recv_or_register(ig_box.get(i).prc,prRecv_prp.getPointer(),prp_recv[i]);
 			}
 
 			prRecv_prp.decRef();
 		}
-		else
+		else if (fs_queue == false)
 		{
 			// It is not possible to calculate the total information so we have to receive
 
@@ -613,7 +721,7 @@ class grid_dist_id_comm
 				Box<dim,long int> rbox = eg_box.get(ei).bid.get(nle_id).lr_e_box;
 
 				loc_grid.get(n_sub_id).remove(box);
-				loc_grid.get(n_sub_id).copy_to(loc_grid.get(sub_id),rbox,box);
+				grid_copy_box<T,Memory>(loc_grid.get(n_sub_id),loc_grid.get(sub_id),rbox,box,opt);
 			}
 		}
 	}
@@ -698,7 +806,7 @@ class grid_dist_id_comm
 				Box<dim,long int> rbox = eg_box.get(ei).bid.get(nle_id).lr_e_box;
 
 				loc_grid.get(n_sub_id).remove(box);
-				loc_grid.get(n_sub_id).copy_to(loc_grid.get(sub_id),rbox,box);
+				grid_copy_box<T,Memory>(loc_grid.get(n_sub_id),loc_grid.get(sub_id),rbox,box,opt);
 			}
 		}
 	}
@@ -1275,6 +1383,7 @@ public:
 	 * \param gdb_ext information of the local grids
 	 * \param gdb_ext_old information of the old local grids
 	 * \param gdb_ext_global it contain the decomposition at global level
+	 * \param opt options
 	 *
 	 */
 	template<int ... prp>
@@ -1286,12 +1395,45 @@ public:
 			  openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_old,
 			  openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_global,
 			  size_t opt)
+	{
+		map_start_<prp...>(dec,cd_sm,loc_grid,loc_grid_old,gdb_ext,gdb_ext_old,gdb_ext_global,opt,false);
+		map_finish_<prp...>(loc_grid,gdb_ext);
+	}
+
+	/*! \brief First phase of the map: pack the parts that move, copy the ones that stay and send
+	 *
+	 * The map is completed by map_finish_. When fused is true the messages are only queued,
+	 * they are exchanged for several grids at once by fused_sendrecv
+	 *
+	 * \param dec Decomposition
+	 * \param cd_sm cell-decomposer
+	 * \param loc_grid set of local grids
+	 * \param loc_grid_old set of old local grids
+	 * \param gdb_ext information of the local grids
+	 * \param gdb_ext_old information of the old local grids
+	 * \param gdb_ext_global it contain the decomposition at global level
+	 * \param opt options
+	 * \param fused the exchange is done by fused_sendrecv
+	 *
+	 */
+	template<int ... prp>
+	void map_start_(Decomposition & dec,
+					CellDecomposer_sm<dim,St,shift<dim,St>> & cd_sm,
+					openfpm::vector<device_grid> & loc_grid,
+					openfpm::vector<device_grid> & loc_grid_old,
+					openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext,
+					openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_old,
+					openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext_global,
+					size_t opt,
+					bool fused)
 	{
 		this->opt = opt;
 
 		openfpm::vector<size_t> send_buffer_sizes(v_cl.getProcessingUnits());
-		openfpm::vector<Memory> send_buffers_;
-		openfpm::vector<ExtPreAlloc<Memory>> send_buffers;
+		openfpm::vector<Memory> & send_buffers_ = mp_send_buffers_;
+		openfpm::vector<ExtPreAlloc<Memory>> & send_buffers = mp_send_buffers;
+		send_buffers_.clear();
+		send_buffers.clear();
 		send_buffers_.resize(v_cl.getProcessingUnits());
 		send_buffers.resize(v_cl.getProcessingUnits());
 
@@ -1299,6 +1441,12 @@ public:
 		send_pointer.clear();
 		send_size.clear();
 
+		// the sizes of the messages are not known on the receiving side
+		fused_reset(fused,false);
+
+		// the parts that stay on this processor are copied directly with block copies instead of pack/unpack
+		bool direct = grid_copy_box_dense<dim,device_grid,Memory>::value && T::noPointers() == true && !(opt & RUN_ON_DEVICE);
+
 		for (int p_id = 0 ; p_id < v_cl.getProcessingUnits() ; p_id++)
 		{
 			for (int i = 0 ; i < loc_grid_old.size() ; i++)
@@ -1310,7 +1458,9 @@ public:
 						size_t p_id){
 						//gr_send.copy_to(gr,box_src,box_dst);
 
-			
+						if (direct == true && p_id == v_cl.rank())
+						{return;}
+
 						Packer<SpaceBox<dim,long int>,BMemory<Memory>>::packRequest(box_dst,send_buffer_sizes.get(p_id));
 
 						auto sub_it = gr.getIterator(box_src.getKP1(),box_src.getKP2(),0);
@@ -1339,6 +1489,9 @@ public:
 						device_grid & gr,
 						size_t p_id){
 
+						if (direct == true && p_id == v_cl.rank())
+						{return;}
+
 						size_t offset = send_buffers.get(p_id).getOffsetEnd();
 						Packer<Box<dim,long int>,Memory>::pack(send_buffers.get(p_id),box_dst,sts);
 						size_t offset2 = send_buffers.get(p_id).getOffsetEnd();
@@ -1368,6 +1521,34 @@ public:
 		// 	std::cout << "Local buffer " << v_cl.rank() << " " << ((long int *)send_buffers.get(v_cl.rank()).getPointer())[j] << " " << &((long int *)send_buffers.get(v_cl.rank()).getPointer())[j] << std::endl;
 		// }
 
+		if (direct == true)
+		{
+			auto lc = [&](Box<dim,long int> & box_src,
+						Box<dim,long int> & box_dst,
+						device_grid & gr,
+						size_t p_id){
+
+						int s = find_local_sub(box_dst,gdb_ext);
+						if (s == -1)
+						{
+							std::cout << __FILE__ << ":" << __LINE__ << " map, error non-local subdomain " << std::endl;
+							return;
+						}
+
+						// convert box_dst to local
+						Box<dim,long int> box_dst_loc;
+						for (int d = 0 ; d < dim ; d++ )
+						{
+							box_dst_loc.setLow(d, box_dst.getLow(d) - gdb_ext.get(s).origin.get(d));
+							box_dst_loc.setHigh(d, box_dst.getHigh(d) - gdb_ext.get(s).origin.get(d));
+						}
+
+						grid_copy_box<T,Memory>(loc_grid.get(s),gr,box_src,box_dst_loc,opt);
+			};
+
+			labelIntersectionGridsProcessor_and_pack(dec,cd_sm,loc_grid_old,gdb_ext,gdb_ext_old,gdb_ext_global,v_cl.rank(),lc);
+		}
+
 		unpack_buffer_to_local_grid<prp ...>(loc_grid,gdb_ext,send_buffers.get(v_cl.rank()),send_buffers.get(v_cl.rank()).size());
 
 		//openfpm::vector<void *> send_pointer;
@@ -1396,11 +1577,26 @@ public:
 		recv_buffers.clear();
 		recv_proc.clear();
 
-		v_cl.sendrecvMultipleMessagesNBX(send_pointer.size(),send_size_ptr,
-											 send_prc_queue_ptr,send_pointer_ptr,
-											 receive_dynamic,this);
+		if (fused == false)
+		{
+			v_cl.sendrecvMultipleMessagesNBX(send_pointer.size(),send_size_ptr,
+												 send_prc_queue_ptr,send_pointer_ptr,
+												 receive_dynamic,this);
+		}
 
+		fs_queue = false;
+	}
 
+	/*! \brief Second phase of the map: unpack the received parts
+	 *
+	 * \param loc_grid set of local grids
+	 * \param gdb_ext information of the local grids
+	 *
+	 */
+	template<int ... prp>
+	void map_finish_(openfpm::vector<device_grid> & loc_grid,
+					 openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext)
+	{
 		for (int i = 0 ; i < recv_buffers.size() ; i++)
 		{
 			ExtPreAlloc<Memory> prAlloc_;
@@ -1408,8 +1604,11 @@ public:
 			unpack_buffer_to_local_grid<prp ...>(loc_grid,gdb_ext,prAlloc_,recv_proc.get(i).size);
 		}
 
-		for (int i = 0 ; i < send_buffers.size() ; i++)
-		{send_buffers.get(i).decRef();}
+		for (int i = 0 ; i < mp_send_buffers.size() ; i++)
+		{mp_send_buffers.get(i).decRef();}
+
+		mp_send_buffers.clear();
+		mp_send_buffers_.clear();
 	}
 
 	/*! \brief It fill the ghost part of the grids
@@ -1439,6 +1638,42 @@ public:
 		SCOREP_USER_REGION("ghost_get",SCOREP_USER_REGION_TYPE_FUNCTION)
 #endif
 
+		ghost_get_start_<prp...>(ig_box,eg_box,loc_ig_box,loc_eg_box,gdb_ext,use_bx_def,loc_grid,ginfo,g_id_to_external_ghost_box,opt,false);
+		ghost_get_finish_<prp...>(eg_box,eb_gid_list,loc_grid,g_id_to_external_ghost_box);
+	}
+
+	/*! \brief First phase of the ghost_get: pack and send the internal ghost, post the receives
+	 *         and sync the local ghost
+	 *
+	 * The ghost_get is completed by ghost_get_finish_. When fused is true the messages are only
+	 * queued (and for dense grids the receiving buffers registered), they are exchanged for several
+	 * grids at once by fused_sendrecv
+	 *
+	 * \param ig_box internal ghost box
+	 * \param eg_box external ghost box
+	 * \param loc_ig_box local internal ghost box
+	 * \param loc_eg_box local external ghost box
+	 * \param gdb_ext local grids information
+	 * \param use_bx_def use the definition box
+	 * \param loc_grid set of local grid
+	 * \param ginfo grid information
+	 * \param g_id_to_external_ghost_box index to external ghost box
+	 * \param opt options
+	 * \param fused the exchange is done by fused_sendrecv
+	 *
+	 */
+	template<int... prp> void ghost_get_start_(const openfpm::vector<ip_box_grid<dim>> & ig_box,
+											   const openfpm::vector<ep_box_grid<dim>> & eg_box,
+											   const openfpm::vector<i_lbox_grid<dim>> & loc_ig_box,
+											   const openfpm::vector<e_lbox_grid<dim>> & loc_eg_box,
+											   const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext,
+											   bool use_bx_def,
+											   openfpm::vector<device_grid> & loc_grid,
+											   const grid_sm<dim,void> & ginfo,
+											   std::unordered_map<size_t,size_t> & g_id_to_external_ghost_box,
+											   size_t opt,
+											   bool fused)
+	{
 		// Sending property object
                 typedef object<typename object_creator<typename T::type,prp...>::type> prp_object;
 
@@ -1448,6 +1683,8 @@ public:
 		send_pointer.clear();
 		send_size.clear();
 
+		fused_reset(fused,device_grid::isCompressed() == false);
+
 		this->opt = opt;
 
 		size_t req = 0;
@@ -1610,16 +1847,20 @@ public:
 		}
 
 		// Calculate the total information to receive from each processors
-		std::vector<size_t> prp_recv;
+		gg_prp_recv.clear();
+		gg_opt = opt;
 
 		// Create an object of preallocated memory for properties
-		ExtPreAlloc<Memory> & prRecv_prp = *(new ExtPreAlloc<Memory>(g_recv_prp_mem.size(),g_recv_prp_mem));
-		prRecv_prp.incRef();
+		gg_prRecv_prp = new ExtPreAlloc<Memory>(g_recv_prp_mem.size(),g_recv_prp_mem);
+		gg_prRecv_prp->incRef();
 
 		// Before wait for the communication to complete we sync the local ghost
 		// in order to overlap with communication
 
-		queue_recv_data_get<prp_object>(eg_box,prp_recv,prRecv_prp);
+		if (fused == false || device_grid::isCompressed() == false)
+		{queue_recv_data_get<prp_object>(eg_box,gg_prp_recv,*gg_prRecv_prp);}
+
+		fs_queue = false;
 
 		#ifdef ENABLE_GRID_DIST_ID_PERF_STATS
 		sendrecv_time.stop();
@@ -1633,14 +1874,34 @@ public:
 		#ifdef ENABLE_GRID_DIST_ID_PERF_STATS
 		merge_loc_time.stop();
 		tot_loc_merge += merge_loc_time.getwct();
+		#endif
+	}
+
+	/*! \brief Second phase of the ghost_get: wait the communications and merge the received
+	 *         data into the external ghost
+	 *
+	 * \param eg_box external ghost box
+	 * \param eb_gid_list list of external ghost boxes
+	 * \param loc_grid set of local grid
+	 * \param g_id_to_external_ghost_box index to external ghost box
+	 *
+	 */
+	template<int... prp> void ghost_get_finish_(const openfpm::vector<ep_box_grid<dim>> & eg_box,
+												const openfpm::vector<e_box_multi<dim>> & eb_gid_list,
+												openfpm::vector<device_grid> & loc_grid,
+												std::unordered_map<size_t,size_t> & g_id_to_external_ghost_box)
+	{
+		#ifdef ENABLE_GRID_DIST_ID_PERF_STATS
 		timer merge_time;
 		merge_time.start();
 		#endif
 
+		size_t opt = gg_opt;
+
 		for (size_t i = 0 ; i < loc_grid.size() ; i++)
 		{loc_grid.get(i).removeAddUnpackReset();}
 
-		merge_received_data_get<prp ...>(loc_grid,eg_box,prp_recv,prRecv_prp,g_id_to_external_ghost_box,eb_gid_list,opt);
+		merge_received_data_get<prp ...>(loc_grid,eg_box,gg_prp_recv,*gg_prRecv_prp,g_id_to_external_ghost_box,eb_gid_list,opt);
 
 		rem_copy_opt opt_ = rem_copy_opt::NONE_OPT;
 		if (opt & SKIP_LABELLING)
@@ -1654,8 +1915,141 @@ public:
 		tot_merge += merge_time.getwct();
 		#endif
 
-		prRecv_prp.decRef();
-		delete &prRecv_prp;
+		gg_prRecv_prp->decRef();
+		delete gg_prRecv_prp;
+		gg_prRecv_prp = NULL;
+	}
+
+	/*! \brief Exchange the queued messages of several grids with one message for each processor
+	 *
+	 * The messages queued by ghost_get_start_, ghost_put_start_ or map_start_ (fused) of all the grids
+	 * directed to the same processor are packed into one message with an header (number of grids, and
+	 * for each grid its index and the size). In this way one communication round is done for all the
+	 * grids, instead of one for each grid. On the receiving side the messages are split back: for dense
+	 * grids into the receiving buffers registered by the start phase, for compressed grids (and map)
+	 * into the dynamic receiving buffers of each grid
+	 *
+	 * \param grids grids (the same start phase must be called on all of them with fused = true)
+	 *
+	 */
+	static void fused_sendrecv(openfpm::vector<grid_dist_id_comm *> & grids)
+	{
+		if (grids.size() == 0)
+		{return;}
+
+		Vcluster<Memory> & v_cl = grids.get(0)->v_cl;
+
+		// group the messages by processor
+		std::map<size_t,openfpm::vector<size_t>> prc_msg;
+
+		for (size_t g = 0 ; g < grids.size() ; g++)
+		{
+			for (size_t k = 0 ; k < grids.get(g)->send_prc_queue.size() ; k++)
+			{
+				prc_msg[grids.get(g)->send_prc_queue.get(k)].add(g);
+				prc_msg[grids.get(g)->send_prc_queue.get(k)].add(k);
+			}
+		}
+
+		openfpm::vector<openfpm::vector<unsigned char>> send_buf;
+		openfpm::vector<size_t> prc;
+		openfpm::vector<size_t> sz;
+		openfpm::vector<void *> ptr;
+
+		for (auto & pm : prc_msg)
+		{
+			size_t n_msg = pm.second.size() / 2;
+			size_t tot = sizeof(size_t) + 2*n_msg*sizeof(size_t);
+
+			for (size_t m = 0 ; m < n_msg ; m++)
+			{tot += grids.get(pm.second.get(2*m))->send_size.get(pm.second.get(2*m+1));}
+
+			send_buf.add();
+			send_buf.last().resize(tot);
+
+			size_t * head = (size_t *)&send_buf.last().get(0);
+			unsigned char * data = (unsigned char *)(head + 1 + 2*n_msg);
+
+			head[0] = n_msg;
+			for (size_t m = 0 ; m < n_msg ; m++)
+			{
+				grid_dist_id_comm * gd = grids.get(pm.second.get(2*m));
+				size_t k = pm.second.get(2*m+1);
+
+				head[1+2*m] = pm.second.get(2*m);
+				head[2+2*m] = gd->send_size.get(k);
+
+				memcpy(data,gd->send_pointer.get(k),gd->send_size.get(k));
+				data += gd->send_size.get(k);
+			}
+
+			prc.add(pm.first);
+			sz.add(tot);
+		}
+
+		for (size_t i = 0 ; i < send_buf.size() ; i++)
+		{ptr.add(&send_buf.get(i).get(0));}
+
+		fused_recv fr;
+
+		if (prc.size() == 0)
+		{v_cl.sendrecvMultipleMessagesNBX(0,NULL,NULL,NULL,receive_fused,&fr);}
+		else
+		{v_cl.sendrecvMultipleMessagesNBX(prc.size(),&sz.get(0),&prc.get(0),&ptr.get(0),receive_fused,&fr);}
+
+		// split the messages into the receiving buffers of each grid
+		for (size_t i = 0 ; i < fr.buf.size() ; i++)
+		{
+			size_t * head = (size_t *)fr.buf.get(i).getPointer();
+			unsigned char * data = (unsigned char *)(head + 1 + 2*head[0]);
+
+			for (size_t m = 0 ; m < head[0] ; m++)
+			{
+				grid_dist_id_comm * gd = grids.get(head[1+2*m]);
+				size_t msg_sz = head[2+2*m];
+
+				if (gd->fs_known == true)
+				{
+					// copy into the buffer registered for this processor
+					size_t k = 0;
+					for ( ; k < gd->fs_recv_prc.size() ; k++)
+					{
+						if (gd->fs_recv_prc.get(k) == fr.prc.get(i))
+						{break;}
+					}
+
+					if (k == gd->fs_recv_prc.size() || gd->fs_recv_sz.get(k) != msg_sz)
+					{
+						std::cerr << __FILE__ << ":" << __LINE__ << " Error unexpected message of " << msg_sz << " bytes from processor " << fr.prc.get(i) << std::endl;
+						ACTION_ON_ERROR(GRID_DIST_ERROR_OBJECT);
+					}
+					else if (msg_sz != 0)
+					{memcpy(gd->fs_recv_ptr.get(k),data,msg_sz);}
+
+					data += msg_sz;
+					continue;
+				}
+
+				gd->recv_buffers.add();
+				gd->recv_buffers.last().resize(msg_sz);
+
+				if (msg_sz != 0)
+				{memcpy(gd->recv_buffers.last().getPointer(),data,msg_sz);}
+
+				gd->recv_proc.add();
+				gd->recv_proc.last().p_id = fr.prc.get(i);
+				gd->recv_proc.last().size = msg_sz;
+				gd->recv_proc.last().i = gd->recv_proc.size()-1;
+
+				data += msg_sz;
+			}
+		}
+
+		for (size_t g = 0 ; g < grids.size() ; g++)
+		{
+			if (grids.get(g)->fs_known == false)
+			{grids.get(g)->reorder_recv_buffers();}
+		}
 	}
 
 	/*! \brief It merge the information in the ghost with the
@@ -1681,6 +2075,39 @@ public:
 			        const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext,
 					openfpm::vector<device_grid> & loc_grid,
 					openfpm::vector<std::unordered_map<size_t,size_t>> & g_id_to_internal_ghost_box)
+	{
+		ghost_put_start_<op,prp...>(ig_box,eg_box,loc_ig_box,loc_eg_box,gdb_ext,loc_grid,g_id_to_internal_ghost_box,false);
+		ghost_put_finish_<op,prp...>(dec,ig_box,gdb_ext,loc_grid,g_id_to_internal_ghost_box);
+	}
+
+	/*! \brief First phase of the ghost_put: pack and send the external ghost, post the receives
+	 *         and merge the local ghost
+	 *
+	 * The ghost_put is completed by ghost_put_finish_. When fused is true the messages are only
+	 * queued (and for dense grids the receiving buffers registered), they are exchanged for several
+	 * grids at once by fused_sendrecv
+	 *
+	 * \tparam op merge operation
+	 *
+	 * \param ig_box internal ghost box
+	 * \param eg_box external ghost box
+	 * \param loc_ig_box local internal ghost box
+	 * \param loc_eg_box local external ghost box
+	 * \param gdb_ext local grids information
+	 * \param loc_grid set of local grid
+	 * \param g_id_to_internal_ghost_box index to internal ghost box
+	 * \param fused the exchange is done by fused_sendrecv
+	 *
+	 */
+	template<template<typename,typename> class op,int... prp>
+	void ghost_put_start_(const openfpm::vector<ip_box_grid<dim>> & ig_box,
+						  const openfpm::vector<ep_box_grid<dim>> & eg_box,
+						  const openfpm::vector<i_lbox_grid<dim>> & loc_ig_box,
+						  const openfpm::vector<e_lbox_grid<dim>> & loc_eg_box,
+						  const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext,
+						  openfpm::vector<device_grid> & loc_grid,
+						  openfpm::vector<std::unordered_map<size_t,size_t>> & g_id_to_internal_ghost_box,
+						  bool fused)
 	{
 		// Sending property object
 		typedef object<typename object_creator<typename T::type,prp...>::type> prp_object;
@@ -1691,6 +2118,8 @@ public:
 		send_pointer.clear();
 		send_size.clear();
 
+		fused_reset(fused,device_grid::isCompressed() == false);
+
 		size_t req = 0;
 
 		// Create a packing request vector
@@ -1724,7 +2153,8 @@ public:
 		g_send_prp_mem.resize(req);
 
 		// Create an object of preallocated memory for properties
-		ExtPreAlloc<Memory> & prAlloc_prp = *(new ExtPreAlloc<Memory>(req,g_send_prp_mem));
+		gp_prAlloc_prp = new ExtPreAlloc<Memory>(req,g_send_prp_mem);
+		ExtPreAlloc<Memory> & prAlloc_prp = *gp_prAlloc_prp;
 
 		prAlloc_prp.incRef();
 
@@ -1769,25 +2199,49 @@ public:
 		}
 
 		// Calculate the total information to receive from each processors
-		std::vector<size_t> prp_recv;
+		gp_prp_recv.clear();
 
 		// Create an object of preallocated memory for properties
-		ExtPreAlloc<Memory> & prRecv_prp = *(new ExtPreAlloc<Memory>(0,g_recv_prp_mem));
-		prRecv_prp.incRef();
+		gp_prRecv_prp = new ExtPreAlloc<Memory>(0,g_recv_prp_mem);
+		gp_prRecv_prp->incRef();
+
+		queue_recv_data_put<prp_object>(ig_box,gp_prp_recv,*gp_prRecv_prp);
 
-		queue_recv_data_put<prp_object>(ig_box,prp_recv,prRecv_prp);
+		fs_queue = false;
 
 		// Before wait for the communication to complete we sync the local ghost
 		// in order to overlap with communication
 
 		ghost_put_local<op,prp...>(loc_ig_box,loc_eg_box,gdb_ext,loc_grid,g_id_to_internal_ghost_box);
+	}
 
-		merge_received_data_put<op,prp ...>(dec,loc_grid,ig_box,prp_recv,prRecv_prp,gdb_ext,g_id_to_internal_ghost_box);
-
-		prRecv_prp.decRef();
-		prAlloc_prp.decRef();
-		delete &prAlloc_prp;
-		delete &prRecv_prp;
+	/*! \brief Second phase of the ghost_put: wait the communications and merge the received
+	 *         data into the internal ghost
+	 *
+	 * \tparam op merge operation
+	 *
+	 * \param dec Decomposition
+	 * \param ig_box internal ghost box
+	 * \param gdb_ext local grids information
+	 * \param loc_grid set of local grid
+	 * \param g_id_to_internal_ghost_box index to internal ghost box
+	 *
+	 */
+	template<template<typename,typename> class op,int... prp>
+	void ghost_put_finish_(Decomposition & dec,
+						   const openfpm::vector<ip_box_grid<dim>> & ig_box,
+						   const openfpm::vector<GBoxes<device_grid::dims>> & gdb_ext,
+						   openfpm::vector<device_grid> & loc_grid,
+						   openfpm::vector<std::unordered_map<size_t,size_t>> & g_id_to_internal_ghost_box)
+	{
+		merge_received_data_put<op,prp ...>(dec,loc_grid,ig_box,gp_prp_recv,*gp_prRecv_prp,gdb_ext,g_id_to_internal_ghost_box);
+
+		gp_prRecv_prp->decRef();
+		gp_prAlloc_prp->decRef();
+		delete gp_prAlloc_prp;
+		delete gp_prRecv_prp;
+		gp_prAlloc_prp = NULL;
+		gp_prRecv_prp = NULL;
 	}
 
 	/*! \brief Constructor
@@ -2789,5 +2789,424 @@ BOOST_AUTO_TEST_CASE( grid_dist_copy_construct )
 	BOOST_REQUIRE_EQUAL(match,true);
 }
 
-BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_CASE( grid_dist_write_aggregated )
+{
+	Box<3,float> domain({-1.0,-1.0,-1.0},{1.0,1.0,1.0});
+
+	Vcluster<> & v_cl = create_vcluster();
+
+	if ( v_cl.getProcessingUnits() > 32 )
+	{return;}
+
+	BOOST_TEST_CHECKPOINT( "Testing grid aggregated write");
+
+	// grid size
+	size_t sz[3] = {16,16,16};
+
+	// Ghost
+	Ghost<3,long int> g(1);
+
+	// periodicity
+	periodicity<3> pr = {{NON_PERIODIC,NON_PERIODIC,NON_PERIODIC}};
+
+	grid_dist_id<3, float, aggregate<float, float[3]>> g_dist(sz,domain,g,pr);
+
+	auto it = g_dist.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto k = it.get();
+		auto gkey = it.getGKey(k);
+
+		g_dist.get<0>(k) = gkey.get(0);
+		g_dist.get<1>(k)[0] = gkey.get(0);
+		g_dist.get<1>(k)[1] = gkey.get(1);
+		g_dist.get<1>(k)[2] = gkey.get(2);
+
+		++it;
+	}
+
+	// Two aggregators (or one if we run on one processor)
+	g_dist.setOutputAggregators(2);
+	bool ret = g_dist.write("grid_dist_aggregated");
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// only the aggregators produce a file
+	size_t g_sz = (v_cl.size() + 1) / 2;
+
+	std::ifstream f("grid_dist_aggregated_" + std::to_string(v_cl.rank() / g_sz) + ".vtk");
+	BOOST_REQUIRE_EQUAL(f.good(),true);
+
+	// the frames are aggregated too, processor 0 write the index
+	ret = g_dist.write_frame("grid_dist_aggregated",3,VTK_WRITER | FORMAT_BINARY);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream f3("grid_dist_aggregated_" + std::to_string(v_cl.rank() / g_sz) + "_3.vtk");
+	BOOST_REQUIRE_EQUAL(f3.good(),true);
+
+	if (v_cl.rank() == 0)
+	{
+		std::ifstream idx("grid_dist_aggregated_3.visit");
+		std::string line;
+		std::getline(idx,line);
+
+		size_t n_grp = (v_cl.size() + g_sz - 1) / g_sz;
+		BOOST_REQUIRE_EQUAL(line,"!NBLOCKS " + std::to_string(n_grp));
+	}
+}
+
+BOOST_AUTO_TEST_CASE( grid_dist_for_each_parallel )
+{
+	Box<3,float> domain({-1.0,-1.0,-1.0},{1.0,1.0,1.0});
+
+	Vcluster<> & v_cl = create_vcluster();
+
+	if ( v_cl.getProcessingUnits() > 32 )
+	{return;}
+
+	// grid size
+	size_t sz[3] = {32,32,32};
+
+	// Ghost
+	Ghost<3,long int> g(1);
+
+	// periodicity
+	periodicity<3> pr = {{NON_PERIODIC,NON_PERIODIC,NON_PERIODIC}};
+
+	grid_dist_id<3, float, aggregate<long int>> g_dist(sz,domain,g,pr);
+
+	auto & gs = g_dist.getGridInfoVoid();
+
+	g_dist.for_each_parallel([&](const grid_dist_key_dx<3> & k)
+	{
+		g_dist.get<0>(k) = gs.LinId(g_dist.getGKey(k));
+	});
+
+	long int sum = g_dist.for_each_parallel_reduce(0l,[&](const grid_dist_key_dx<3> & k, long int & partial)
+	{
+		partial += 1;
+	},
+	[](long int a, long int b){return a + b;});
+
+	v_cl.sum(sum);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(sum,32*32*32);
+
+	bool match = true;
+	auto it = g_dist.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto k = it.get();
+
+		match &= g_dist.get<0>(k) == (long int)gs.LinId(it.getGKey(k));
+
+		++it;
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+}
+
+BOOST_AUTO_TEST_CASE( grid_dist_conv_n_fused )
+{
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	Vcluster<> & v_cl = create_vcluster();
+
+	if ( v_cl.getProcessingUnits() > 32 )
+	{return;}
+
+	// grid size
+	size_t sz[3] = {24,24,24};
+
+	// Ghost
+	Ghost<3,long int> g(1);
+
+	// periodicity
+	periodicity<3> pr = {{NON_PERIODIC,NON_PERIODIC,NON_PERIODIC}};
+
+	grid_dist_id<3, float, aggregate<float,float,float,float,float,float>> g_dist(sz,domain,g,pr);
+
+	auto it = g_dist.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto k = it.get();
+		auto gk = it.getGKey(k);
+
+		float x = gk.get(0);
+		float y = gk.get(1);
+		float z = gk.get(2);
+
+		g_dist.template get<0>(k) = x*x;
+		g_dist.template get<1>(k) = y*y + x;
+		g_dist.template get<2>(k) = x*y + 2.0*z*z;
+
+		++it;
+	}
+
+	g_dist.template ghost_get<0,1,2>();
+
+	grid_key_dx<3> start({1,1,1});
+	grid_key_dx<3> stop({(long int)sz[0]-2,(long int)sz[1]-2,(long int)sz[2]-2});
+
+	//! [fused stencil conv_n]
+
+	// Laplacian of three fields in one sweep
+	g_dist.template conv_n<1>(start,stop,[](auto & s)
+	{
+		s.template get<3>() = s.template get<0>(1,0,0) + s.template get<0>(-1,0,0) +
+		                      s.template get<0>(0,1,0) + s.template get<0>(0,-1,0) +
+		                      s.template get<0>(0,0,1) + s.template get<0>(0,0,-1) - 6.0f*s.template get<0>();
+
+		s.template get<4>() = s.template get<1>(1,0,0) + s.template get<1>(-1,0,0) +
+		                      s.template get<1>(0,1,0) + s.template get<1>(0,-1,0) +
+		                      s.template get<1>(0,0,1) + s.template get<1>(0,0,-1) - 6.0f*s.template get<1>();
+
+		s.template get<5>() = s.template get<2>(1,0,0) + s.template get<2>(-1,0,0) +
+		                      s.template get<2>(0,1,0) + s.template get<2>(0,-1,0) +
+		                      s.template get<2>(0,0,1) + s.template get<2>(0,0,-1) - 6.0f*s.template get<2>();
+	},4);
+
+	//! [fused stencil conv_n]
+
+	bool match = true;
+	auto it2 = g_dist.getSubDomainIterator(start,stop);
+
+	while (it2.isNext())
+	{
+		auto k = it2.get();
+
+		match &= g_dist.template get<3>(k) == 2.0f;
+		match &= g_dist.template get<4>(k) == 2.0f;
+		match &= g_dist.template get<5>(k) == 4.0f;
+
+		++it2;
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+
+	// the points along x are visited with the linear id, check the global coordinates
+	g_dist.template conv_n<1>(start,stop,[](auto & s)
+	{
+		auto gk = s.getGKey();
+
+		s.template get<3>() = gk.get(0);
+		s.template get<4>() = gk.get(1);
+		s.template get<5>() = s.template get<0>(1,0,0) - s.template get<0>();
+	},5);
+
+	auto it3 = g_dist.getSubDomainIterator(start,stop);
+
+	while (it3.isNext())
+	{
+		auto k = it3.get();
+		auto gk = it3.getGKey(k);
+
+		match &= g_dist.template get<3>(k) == gk.get(0);
+		match &= g_dist.template get<4>(k) == gk.get(1);
+		match &= g_dist.template get<5>(k) == 2.0f*gk.get(0) + 1.0f;
+
+		++it3;
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+}
+
+BOOST_AUTO_TEST_CASE( grid_dist_prop_ghost_extent )
+{
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	Vcluster<> & v_cl = create_vcluster();
+
+	if ( v_cl.getProcessingUnits() > 32 )
+	{return;}
+
+	// grid size
+	size_t sz[3] = {32,32,32};
+
+	// Ghost
+	Ghost<3,long int> g(2);
+
+	// periodicity
+	periodicity<3> pr = {{PERIODIC,PERIODIC,PERIODIC}};
+
+	// property 0 and 2 use the full ghost and are exchanged together
+	grid_dist_id<3, float, aggregate<long int,long int,long int>> g_dist(sz,domain,g,pr);
+
+	//! [one sided ghost]
+
+	// property 1 read only the right neighbor in x
+	Ghost<3,long int> g1(0);
+	g1.setHigh(0,1);
+
+	g_dist.setPropGhost<1>(g1);
+
+	//! [one sided ghost]
+
+	auto & gs = g_dist.getGridInfoVoid();
+
+	auto it = g_dist.getDomainGhostIterator();
+
+	while (it.isNext())
+	{
+		auto k = it.get();
+
+		g_dist.template get<0>(k) = -1;
+		g_dist.template get<1>(k) = -1;
+		g_dist.template get<2>(k) = -1;
+
+		++it;
+	}
+
+	auto dom = g_dist.getDomainIterator();
+
+	while (dom.isNext())
+	{
+		auto k = dom.get();
+
+		g_dist.template get<0>(k) = gs.LinId(dom.getGKey(k));
+		g_dist.template get<1>(k) = gs.LinId(dom.getGKey(k));
+		g_dist.template get<2>(k) = gs.LinId(dom.getGKey(k));
+
+		++dom;
+	}
+
+	g_dist.template ghost_get<0,1,2>();
+
+	auto & gdb_ext = g_dist.getLocalGridsInfo();
+
+	bool match = true;
+	size_t n_out = 0;
+	auto it2 = g_dist.getDomainGhostIterator();
+
+	while (it2.isNext())
+	{
+		auto k = it2.get();
+		auto gk = it2.getGKey(k);
+
+		grid_key_dx<3> wk;
+		for (size_t i = 0 ; i < 3 ; i++)
+		{wk.set_d(i,(gk.get(i) + sz[i]) % sz[i]);}
+
+		long int id = gs.LinId(wk);
+
+		match &= g_dist.template get<0>(k) == id;
+		match &= g_dist.template get<2>(k) == id;
+
+		// property 1 must be correct inside the sub-domain enlarged by g1
+		auto lk = k.getKey();
+		auto & Dbox = gdb_ext.get(k.getSub()).Dbox;
+
+		bool in = true;
+		for (size_t i = 0 ; i < 3 ; i++)
+		{in &= lk.get(i) >= Dbox.getLow(i) + g1.getLow(i) && lk.get(i) <= Dbox.getHigh(i) + g1.getHigh(i);}
+
+		if (in == true)
+		{match &= g_dist.template get<1>(k) == id;}
+		else
+		{
+			// outside it, a point that come from another processor must not be received
+			bool remote = true;
+			for (size_t s = 0 ; s < gdb_ext.size() ; s++)
+			{
+				bool inside = true;
+				for (size_t i = 0 ; i < 3 ; i++)
+				{
+					long int lw = wk.get(i) - gdb_ext.get(s).origin.get(i);
+					inside &= lw >= gdb_ext.get(s).Dbox.getLow(i) && lw <= gdb_ext.get(s).Dbox.getHigh(i);
+				}
+
+				remote &= !inside;
+			}
+
+			if (remote == true)
+			{
+				match &= g_dist.template get<1>(k) == -1;
+				n_out++;
+			}
+		}
+
+		++it2;
+	}
+
+	v_cl.sum(n_out);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(match,true);
+
+	if (v_cl.getProcessingUnits() > 1)
+	{BOOST_REQUIRE(n_out != 0);}
+}
+
+BOOST_AUTO_TEST_CASE( grid_copy_box_memcpy_test )
+{
+	typedef aggregate<float,float[3]> T;
+
+	size_t sz_src[3] = {12,10,8};
+	size_t sz_dst[3] = {12,14,6};
+
+	grid_cpu<3,T> src(sz_src);
+	grid_cpu<3,T> dst(sz_dst);
+	src.setMemory();
+	dst.setMemory();
+
+	auto it = src.getIterator();
+	while (it.isNext())
+	{
+		auto k = it.get();
 
+		src.template get<0>(k) = src.getGrid().LinId(k);
+		for (size_t i = 0 ; i < 3 ; i++)
+		{src.template get<1>(k)[i] = src.getGrid().LinId(k) + i;}
+
+		++it;
+	}
+
+	auto it2 = dst.getIterator();
+	while (it2.isNext())
+	{
+		auto k = it2.get();
+
+		dst.template get<0>(k) = -1;
+
+		++it2;
+	}
+
+	// a box covering the full x direction (merged rows) and a box with partial rows
+	Box<3,long int> bx_src[2] = {Box<3,long int>({0,2,1},{11,7,6}),Box<3,long int>({3,1,0},{8,4,3})};
+	Box<3,long int> bx_dst[2] = {Box<3,long int>({0,5,0},{11,10,5}),Box<3,long int>({2,0,1},{7,3,4})};
+
+	bool match = true;
+
+	for (size_t b = 0 ; b < 2 ; b++)
+	{
+		grid_copy_box_memcpy(dst,src,bx_src[b],bx_dst[b],sizeof(T));
+
+		auto it3 = dst.getIterator(bx_dst[b].getKP1(),bx_dst[b].getKP2());
+		while (it3.isNext())
+		{
+			auto k = it3.get();
+
+			grid_key_dx<3> ks;
+			for (size_t i = 0 ; i < 3 ; i++)
+			{ks.set_d(i,k.get(i) - bx_dst[b].getLow(i) + bx_src[b].getLow(i));}
+
+			match &= dst.template get<0>(k) == src.getGrid().LinId(ks);
+			for (size_t i = 0 ; i < 3 ; i++)
+			{match &= dst.template get<1>(k)[i] == src.getGrid().LinId(ks) + i;}
+
+			++it3;
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+
+	// outside the boxes nothing changed
+	grid_key_dx<3> k_out(0,0,0);
+	BOOST_REQUIRE_EQUAL(dst.template get<0>(k_out),-1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -753,6 +753,96 @@ BOOST_AUTO_TEST_CASE( sgrid_gpu_test_conv2_test )
 }
 
 
+BOOST_AUTO_TEST_CASE( sgrid_gpu_test_conv2_deep_halo )
+{
+	size_t sz[2] = {164,164};
+	periodicity<2> bc = {PERIODIC,PERIODIC};
+
+	// ghost for two sweeps of a stencil of radius 1
+	Ghost<2,long int> g(2);
+
+	Box<2,float> domain({0.0,0.0},{1.0,1.0});
+
+	sgrid_dist_id_gpu<2,float,aggregate<float,float,float,float>> gdist(sz,domain,g,bc);
+
+	gdist.template setBackgroundValue<0>(666);
+	gdist.template setBackgroundValue<1>(666);
+	gdist.template setBackgroundValue<2>(666);
+	gdist.template setBackgroundValue<3>(666);
+
+	Box<2,size_t> box({1,1},{sz[0],sz[1]});
+
+	float c = 5.0;
+
+	typedef typename GetAddBlockType<decltype(gdist)>::type InsertBlockT;
+
+	gdist.addPoints(box.getKP1(),box.getKP2(),
+			        [] __device__ (int i, int j)
+			        {
+						return true;
+			        },
+			        [c] __device__ (InsertBlockT & data, int i, int j)
+			        {
+			        	data.template get<0>() = c + i + j;
+			        	data.template get<1>() = c + 1000 + i + j;
+			        	data.template get<2>() = 0;
+			        	data.template get<3>() = 0;
+			        }
+			        );
+
+	gdist.template flush<smax_<0>,smax_<1>,smax_<2>,smax_<3>>(flush_type::FLUSH_ON_DEVICE);
+
+	//! [deep halo convolution]
+
+	BOOST_REQUIRE_EQUAL(gdist.setDeepHalo(1,2),true);
+	BOOST_REQUIRE_EQUAL(gdist.needGhostGet(),true);
+
+	gdist.template ghost_get<0,1,2,3>(RUN_ON_DEVICE);
+
+	typedef typename GetCpBlockType<decltype(gdist),0,1>::type CpBlockType;
+
+	// first sweep, it calculate also one layer of ghost
+	gdist.template conv2<0,1,2,3,1>({2,2},{(int)sz[0]-3,(int)sz[1]-3},[] __device__ (float & u_out, float & v_out, CpBlockType & u, CpBlockType & v,int i, int j){
+		u_out = u(i+1,j) - u(i-1,j) + u(i,j+1) - u(i,j-1);
+		v_out = v(i+1,j) - v(i-1,j) + v(i,j+1) - v(i,j-1);
+	});
+
+	BOOST_REQUIRE_EQUAL(gdist.needGhostGet(),false);
+
+	// second sweep without ghost_get, it use the ghost calculated by the first sweep
+	gdist.template conv2<2,3,0,1,1>({3,3},{(int)sz[0]-4,(int)sz[1]-4},[] __device__ (float & u_out, float & v_out, CpBlockType & u, CpBlockType & v,int i, int j){
+		u_out = u(i+1,j) - u(i-1,j) + u(i,j+1) - u(i,j-1);
+		v_out = v(i+1,j) - v(i-1,j) + v(i,j+1) - v(i,j-1);
+	});
+
+	BOOST_REQUIRE_EQUAL(gdist.needGhostGet(),true);
+
+	//! [deep halo convolution]
+
+	gdist.deviceToHost<0,1,2,3>();
+
+	auto it3 = gdist.getSubDomainIterator({3,3},{(int)sz[0]-4,(int)sz[1]-4});
+
+	bool match = true;
+
+	while (it3.isNext())
+	{
+		auto p = it3.get();
+
+		// the first sweep produce a constant field, the second one 0
+		if (gdist.template get<0>(p) != 0.0 || gdist.template get<1>(p) != 0.0)
+		{
+			std::cout << gdist.template get<0>(p) << "  " << gdist.template get<1>(p) << std::endl;
+			match = false;
+			break;
+		}
+
+		++it3;
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+}
+
 BOOST_AUTO_TEST_CASE( sgrid_gpu_test_conv2_test_3d )
 {
 	#ifdef CUDA_ON_CPU
@@ -935,4 +935,195 @@ BOOST_AUTO_TEST_CASE (sgrid_dist_id_soa_write )
 //	sg2.load("hdf5_w2_test");
 }
 
+BOOST_AUTO_TEST_CASE (sgrid_dist_id_bulk_insert )
+{
+	periodicity<3> bc = {NON_PERIODIC, NON_PERIODIC, NON_PERIODIC};
+
+	auto & v_cl = create_vcluster<>();
+
+	if (v_cl.size() > 16)
+	{return;}
+
+	// Domain
+	Box<3,double> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	// grid size
+	size_t sz[3] = {128,128,128};
+
+	// Ghost
+	Ghost<3,long int> g(1);
+
+	sgrid_dist_id<3,double,aggregate<double,double>> sg(sz,domain,g,bc);
+
+	//! [bulk insert addPoints]
+
+	// spherical shell
+	sg.addPoints([](int i, int j, int k)
+	             {
+	                long int sx = i - 64;
+	                long int sy = j - 64;
+	                long int sz = k - 64;
+	                long int r2 = sx*sx + sy*sy + sz*sz;
+
+	                return r2 < 40*40 && r2 >= 20*20;
+	             },
+	             [](auto & data, int i, int j, int k)
+	             {
+	                data.template get<0>() = 1.0;
+	                data.template get<1>() = i + 1000*j + 1000000*k;
+	             });
+
+	//! [bulk insert addPoints]
+
+	size_t cnt = 0;
+	size_t cnt_ref = 0;
+	bool match = true;
+
+	auto it = sg.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+		auto gkey = it.getGKey(key);
+
+		long int sx = gkey.get(0) - 64;
+		long int sy = gkey.get(1) - 64;
+		long int sz = gkey.get(2) - 64;
+		long int r2 = sx*sx + sy*sy + sz*sz;
+
+		match &= (r2 < 40*40 && r2 >= 20*20);
+		match &= sg.template get<0>(key) == 1.0;
+		match &= sg.template get<1>(key) == gkey.get(0) + 1000*gkey.get(1) + 1000000*gkey.get(2);
+
+		cnt++;
+
+		++it;
+	}
+
+	for (long int i = 0 ; i < 128 ; i++)
+	{
+		for (long int j = 0 ; j < 128 ; j++)
+		{
+			for (long int k = 0 ; k < 128 ; k++)
+			{
+				long int r2 = (i-64)*(i-64) + (j-64)*(j-64) + (k-64)*(k-64);
+				cnt_ref += (r2 < 40*40 && r2 >= 20*20);
+			}
+		}
+	}
+
+	v_cl.sum(cnt);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(match,true);
+	BOOST_REQUIRE_EQUAL(cnt,cnt_ref);
+}
+
+BOOST_AUTO_TEST_CASE( sgrid_dist_id_conv2_deep_halo )
+{
+	constexpr int U = 0;
+	constexpr int V = 1;
+	constexpr int U_next = 2;
+	constexpr int V_next = 3;
+
+	// the same calculation with a ghost_get for each sweep
+	constexpr int U_ref = 4;
+	constexpr int V_ref = 5;
+	constexpr int U_ref_next = 6;
+	constexpr int V_ref_next = 7;
+
+	Box<3,double> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	size_t sz[3] = {32,32,32};
+
+	periodicity<3> bc = {PERIODIC,PERIODIC,PERIODIC};
+
+	// ghost for two sweeps of a stencil of radius 1
+	Ghost<3,long int> g(2);
+
+	sgrid_dist_soa<3, double, aggregate<double,double,double,double,double,double,double,double>> grid(sz,domain,g,bc);
+
+	auto it = grid.getGridIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get_dist();
+		auto gkey = it.get();
+
+		double u = sin(0.3*gkey.get(0)) + cos(0.2*gkey.get(1)) + 0.1*gkey.get(2);
+		double v = cos(0.1*gkey.get(0)*gkey.get(1)) + 0.05*gkey.get(2);
+
+		grid.template insert<U>(key) = u;
+		grid.template insert<V>(key) = v;
+		grid.template insert<U_next>(key) = 0.0;
+		grid.template insert<V_next>(key) = 0.0;
+
+		grid.template insert<U_ref>(key) = u;
+		grid.template insert<V_ref>(key) = v;
+		grid.template insert<U_ref_next>(key) = 0.0;
+		grid.template insert<V_ref_next>(key) = 0.0;
+
+		++it;
+	}
+
+	int stencil[6][3] = {{1,0,0},{-1,0,0},{0,-1,0},{0,1,0},{0,0,-1},{0,0,1}};
+
+	auto func = [](Vc::double_v & u_out,Vc::double_v & v_out,
+				   Vc::double_v (& u)[7],Vc::double_v (& v)[7],
+				   unsigned char * mask){
+
+		u_out = u[0] + 0.1*(u[1] + u[2] + u[3] + u[4] + u[5] + u[6] - 6.0*u[0]) - 0.01*u[0]*v[0];
+		v_out = v[0] + 0.05*(v[1] + v[2] + v[3] + v[4] + v[5] + v[6] - 6.0*v[0]) + 0.01*u[0]*v[0];
+	};
+
+	grid_key_dx<3> start({0,0,0});
+	grid_key_dx<3> stop({(long int)sz[0]-1,(long int)sz[1]-1,(long int)sz[2]-1});
+
+	// reference, two sweeps with a ghost_get each
+	grid.template ghost_get<U_ref,V_ref>();
+	grid.conv2<U_ref,V_ref,U_ref_next,V_ref_next,1>(stencil,start,stop,func);
+	grid.template ghost_get<U_ref_next,V_ref_next>();
+	grid.conv2<U_ref_next,V_ref_next,U_ref,V_ref,1>(stencil,start,stop,func);
+
+	//! [deep halo convolution]
+
+	BOOST_REQUIRE_EQUAL(grid.setDeepHalo(1,2),true);
+	BOOST_REQUIRE_EQUAL(grid.needGhostGet(),true);
+
+	grid.template ghost_get<U,V>();
+
+	// first sweep, it calculate also one layer of ghost
+	grid.conv2<U,V,U_next,V_next,1>(stencil,start,stop,func);
+
+	BOOST_REQUIRE_EQUAL(grid.needGhostGet(),false);
+
+	// second sweep without ghost_get, it use the ghost calculated by the first sweep
+	grid.conv2<U_next,V_next,U,V,1>(stencil,start,stop,func);
+
+	BOOST_REQUIRE_EQUAL(grid.needGhostGet(),true);
+
+	//! [deep halo convolution]
+
+	grid.unsetDeepHalo();
+
+	// a ghost smaller than k*radius is refused
+	BOOST_REQUIRE_EQUAL(grid.setDeepHalo(1,3),false);
+
+	bool match = true;
+
+	auto it2 = grid.getDomainIterator();
+
+	while (it2.isNext())
+	{
+		auto key = it2.get();
+
+		match &= fabs(grid.template get<U>(key) - grid.template get<U_ref>(key)) < 1e-12;
+		match &= fabs(grid.template get<V>(key) - grid.template get<V_ref>(key)) < 1e-12;
+
+		++it2;
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -13,6 +13,10 @@
 constexpr int NO_POSITION = 1;
 constexpr int WITH_POSITION = 2;
 constexpr int NO_CHANGE_ELEMENTS = 4;
+constexpr int GHOST_NODE_SHARED = 65536;
+constexpr int GHOST_VIRTUAL_PERIODIC = 131072;
+constexpr int GHOST_ZERO_COPY = 262144;
+constexpr int NEIGHBOR_COLLECTIVE = 524288;
 
 constexpr int BIND_DEC_TO_GHOST = 1;
 
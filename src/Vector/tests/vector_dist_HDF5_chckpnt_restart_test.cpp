@@ -164,6 +164,9 @@ BOOST_AUTO_TEST_CASE( vector_dist_hdf5_load_test )
 	{
 		auto key = it2.get();
 
+		// Check that the particles has been moved to the processor that own them
+		BOOST_REQUIRE_EQUAL(vd.getDecomposition().isLocal(vd.getPos(key)),true);
+
 		// Check the properties
 		for (size_t i = 0; i < dim; i++)
 			BOOST_REQUIRE_EQUAL(vd.template getProp<0>(key)[i],(float)(0.51234 + vd.getPos(key)[0] + vd.getPos(key)[1]+ vd.getPos(key)[2]));
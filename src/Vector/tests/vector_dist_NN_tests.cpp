@@ -479,3 +479,467 @@ BOOST_AUTO_TEST_CASE( vector_dist_particle_getCellListSym_with_div )
 
 	BOOST_REQUIRE_EQUAL(match,true);
 }
+
+BOOST_AUTO_TEST_CASE( vector_dist_verlet_multi_res )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 12)
+		return;
+
+	std::default_random_engine eg(v_cl.getProcessUnitID());
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	// radius ratio 16 between big and small particles
+	float r_big = 0.08;
+	float r_small = 0.005;
+
+	Ghost<3,float> ghost(r_big * 1.1);
+
+	vector_dist<3,float, aggregate<float>> vd(2000,box,bc,ghost);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		vd.getProp<0>(key) = (ud(eg) < 0.05)?r_big:r_small;
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<0>();
+
+	//! [Verlet multi resolution]
+
+	auto ver = vd.getVerletMultiRes<0>();
+
+	//! [Verlet multi resolution]
+
+	BOOST_REQUIRE(ver.getInternalCellList().getNLevels() > 1);
+
+	// compare with the brute force neighborhood
+	bool ret = true;
+
+	for (size_t p = 0 ; p < vd.size_local() ; p++)
+	{
+		openfpm::vector<size_t> nn;
+
+		for (size_t q = 0 ; q < vd.size_local_with_ghost() ; q++)
+		{
+			if (q == p)
+			{continue;}
+
+			float r = std::max(vd.getProp<0>(p),vd.getProp<0>(q));
+
+			Point<3,float> xp = vd.getPos(p);
+			Point<3,float> xq = vd.getPos(q);
+
+			if (xp.distance2(xq) <= r*r)
+			{nn.add(q);}
+		}
+
+		ret &= (nn.size() == ver.getNNPart(p));
+
+		if (nn.size() != ver.getNNPart(p))
+		{continue;}
+
+		// neighborhood are ordered
+		size_t j = 0;
+		auto NN = ver.getNNIterator(p);
+
+		while (NN.isNext())
+		{
+			ret &= (NN.get() == nn.get(j));
+
+			j++;
+			++NN;
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_pair_kernel )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 12)
+		return;
+
+	std::default_random_engine eg(v_cl.getProcessUnitID());
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	float r_cut = 0.1;
+	Ghost<3,float> ghost(r_cut);
+
+	// charge, force, force calculated with the pair kernel
+	vector_dist<3,float, aggregate<float,float[3],float[3]>> vd(4000,box,bc,ghost);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		vd.getProp<0>(key) = ud(eg);
+
+		for (size_t i = 0 ; i < 3 ; i++)
+		{
+			vd.getProp<1>(key)[i] = 0.0;
+			vd.getProp<2>(key)[i] = 0.0;
+		}
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<0>();
+
+	auto ver = vd.getVerlet(r_cut);
+
+	// reference
+	for (size_t p = 0 ; p < vd.size_local() ; p++)
+	{
+		auto Np = ver.getNNIterator<NO_CHECK>(p);
+
+		while (Np.isNext())
+		{
+			size_t q = Np.get();
+
+			Point<3,float> xp = vd.getPos(p);
+			Point<3,float> dx = xp - vd.getPos(q);
+			float r2 = xp.distance2(vd.getPos(q));
+
+			if (r2 < r_cut*r_cut && r2 > 0.0)
+			{
+				for (size_t i = 0 ; i < 3 ; i++)
+				{vd.getProp<1>(p)[i] += vd.getProp<0>(q) * dx.get(i) / r2;}
+			}
+
+			++Np;
+		}
+	}
+
+	//! [pair kernel]
+
+	vd.pair_kernel<2,0>(ver,[&](auto & t)
+	{
+		for (size_t j = 0 ; j < PAIR_TILE ; j++)
+		{
+			float w = (t.r2[j] < r_cut*r_cut && t.r2[j] > 0.0f)?t.prp_q[0][j] / t.r2[j]:0.0f;
+
+			for (size_t i = 0 ; i < 3 ; i++)
+			{t.res[i][j] = w * t.dx[i][j];}
+		}
+	});
+
+	//! [pair kernel]
+
+	bool ret = true;
+	for (size_t p = 0 ; p < vd.size_local() ; p++)
+	{
+		for (size_t i = 0 ; i < 3 ; i++)
+		{ret &= fabs(vd.getProp<1>(p)[i] - vd.getProp<2>(p)[i]) <= 1e-3 * (1.0 + fabs(vd.getProp<1>(p)[i]));}
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_pair_kernel_crs_symmetric )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 12)
+		return;
+
+	std::default_random_engine eg(v_cl.getProcessUnitID());
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	float r_cut = 0.1;
+	Ghost<3,float> ghost(r_cut);
+
+	// charge, force with the non symmetric list, force with the symmetric list
+	vector_dist<3,float, aggregate<float,float[3],float[3]>> vd(4000,box,bc,ghost,BIND_DEC_TO_GHOST);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		vd.getProp<0>(key) = ud(eg);
+
+		for (size_t i = 0 ; i < 3 ; i++)
+		{
+			vd.getProp<1>(key)[i] = 0.0;
+			vd.getProp<2>(key)[i] = 0.0;
+		}
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<0>();
+
+	// antisymmetric pair force
+	auto kernel = [&](auto & t)
+	{
+		for (size_t j = 0 ; j < PAIR_TILE ; j++)
+		{
+			float w = (t.r2[j] < r_cut*r_cut && t.r2[j] > 0.0f)?r_cut*r_cut - t.r2[j]:0.0f;
+
+			for (size_t i = 0 ; i < 3 ; i++)
+			{t.res[i][j] = w * t.dx[i][j];}
+		}
+	};
+
+	auto ver = vd.getVerlet(r_cut);
+	vd.pair_kernel<1,0>(ver,kernel);
+
+	// the contributions on the ghost are accumulated from zero
+	auto git = vd.getGhostIterator();
+
+	while (git.isNext())
+	{
+		auto key = git.get();
+
+		for (size_t i = 0 ; i < 3 ; i++)
+		{vd.getProp<2>(key)[i] = 0.0;}
+
+		++git;
+	}
+
+	auto ver_crs = vd.getVerletCrs(r_cut);
+	vd.pair_kernel<2,0>(ver_crs,kernel,VL_CRS_SYMMETRIC,-1);
+	vd.ghost_put<add_,2>();
+
+	bool ret = true;
+	for (size_t p = 0 ; p < vd.size_local() ; p++)
+	{
+		for (size_t i = 0 ; i < 3 ; i++)
+		{ret &= fabs(vd.getProp<1>(p)[i] - vd.getProp<2>(p)[i]) <= 1e-3 * (r_cut*r_cut*r_cut + fabs(vd.getProp<1>(p)[i]));}
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_virtual_periodic_images )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 4)
+		return;
+
+	std::default_random_engine eg(v_cl.getProcessUnitID());
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	float r_cut = 0.15;
+	Ghost<3,float> ghost(r_cut);
+
+	// charge, density with copied images, density with virtual images
+	vector_dist<3,float, aggregate<float,float,float>> vd(1000,box,bc,ghost);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		vd.getProp<0>(key) = ud(eg);
+		vd.getProp<1>(key) = 0.0;
+		vd.getProp<2>(key) = 0.0;
+
+		++it;
+	}
+
+	vd.map();
+
+	auto kernel = [&](auto & t)
+	{
+		for (size_t j = 0 ; j < PAIR_TILE ; j++)
+		{t.res[0][j] = (t.r2[j] < r_cut*r_cut)?t.prp_q[0][j] * (r_cut*r_cut - t.r2[j]):0.0f;}
+	};
+
+	// number of neighbors of every particle with a Cell-list
+	auto count_nn = [&](openfpm::vector<size_t> & n_nn)
+	{
+		auto NN = vd.getCellList(r_cut);
+
+		n_nn.resize(vd.size_local());
+
+		for (size_t p = 0 ; p < vd.size_local() ; p++)
+		{
+			Point<3,float> xp = vd.getPos(p);
+			auto Np = NN.getNNIterator<NO_CHECK>(NN.getCell(xp));
+
+			n_nn.get(p) = 0;
+
+			while (Np.isNext())
+			{
+				if (xp.distance2(vd.getPosVirtual(Np.get())) < r_cut*r_cut)
+				{n_nn.get(p)++;}
+
+				++Np;
+			}
+		}
+	};
+
+	vd.ghost_get<0>();
+	size_t n_copy = vd.size_local_with_ghost();
+
+	auto ver = vd.getVerlet(r_cut);
+	vd.pair_kernel<1,0>(ver,kernel);
+
+	openfpm::vector<size_t> n_nn;
+	count_nn(n_nn);
+
+	//! [virtual periodic images]
+
+	vd.ghost_get<0>(WITH_POSITION | GHOST_VIRTUAL_PERIODIC);
+
+	auto ver_v = vd.getVerlet(r_cut);
+	vd.pair_kernel<2,0>(ver_v,kernel);
+
+	//! [virtual periodic images]
+
+	BOOST_REQUIRE_EQUAL(vd.isVirtualPeriodic(),true);
+	BOOST_REQUIRE_EQUAL(vd.size_local_with_ghost() + vd.getVirtualImages().size(),n_copy);
+
+	bool ret = true;
+	for (size_t p = 0 ; p < vd.size_local() ; p++)
+	{ret &= fabs(vd.getProp<1>(p) - vd.getProp<2>(p)) <= 1e-4 * (1.0 + fabs(vd.getProp<1>(p)));}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// the Cell-list contain the virtual images
+	openfpm::vector<size_t> n_nn_v;
+	count_nn(n_nn_v);
+
+	ret = true;
+	for (size_t p = 0 ; p < vd.size_local() ; p++)
+	{ret &= n_nn.get(p) == n_nn_v.get(p);}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_virtual_periodic_images_symmetric )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 4)
+		return;
+
+	std::default_random_engine eg(v_cl.getProcessUnitID());
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	float r_cut = 0.15;
+	Ghost<3,float> ghost(r_cut);
+
+	// charge, density with virtual images, density with the symmetric list
+	vector_dist<3,float, aggregate<float,float,float>> vd(1000,box,bc,ghost);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		vd.getProp<0>(key) = ud(eg);
+		vd.getProp<1>(key) = 0.0;
+		vd.getProp<2>(key) = 0.0;
+
+		++it;
+	}
+
+	vd.map();
+
+	auto kernel = [&](auto & t)
+	{
+		for (size_t j = 0 ; j < PAIR_TILE ; j++)
+		{t.res[0][j] = (t.r2[j] < r_cut*r_cut && t.r2[j] > 0.0f)?r_cut*r_cut - t.r2[j]:0.0f;}
+	};
+
+	vd.ghost_get<0>(WITH_POSITION | GHOST_VIRTUAL_PERIODIC);
+
+	auto ver_v = vd.getVerlet(r_cut);
+	vd.pair_kernel<1,0>(ver_v,kernel);
+
+	// the symmetric list contain the virtual images, their contributions go directly to the source
+	auto git = vd.getGhostIterator();
+
+	while (git.isNext())
+	{
+		vd.getProp<2>(git.get()) = 0.0;
+
+		++git;
+	}
+
+	auto ver_s = vd.getVerletSym(r_cut);
+	vd.pair_kernel<2,0>(ver_s,kernel,VL_SYMMETRIC,1);
+
+	BOOST_REQUIRE_EQUAL(vd.isVirtualPeriodic(),true);
+
+	// crossing-scheme lists does not support the virtual images
+	bool error = false;
+
+	set_enable_throw_on_error();
+
+	try
+	{
+		auto ver_c = vd.getVerletCrs(r_cut);
+	}
+	catch (std::exception & e)
+	{
+		error = true;
+	}
+
+	set_disable_throw_on_error();
+
+	BOOST_REQUIRE_EQUAL(error,true);
+
+	vd.ghost_put<add_,2>();
+
+	bool ret = true;
+	for (size_t p = 0 ; p < vd.size_local() ; p++)
+	{ret &= fabs(vd.getProp<1>(p) - vd.getProp<2>(p)) <= 1e-4 * (1.0 + fabs(vd.getProp<1>(p)));}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
@@ -2248,4 +2248,129 @@ BOOST_AUTO_TEST_CASE( vector_dist_particle_NN_MP_iteration )
 	test_vector_dist_particle_NN_MP_iteration<vector_dist<3,float, part_prop >>();
 }
 
+BOOST_AUTO_TEST_CASE( vector_dist_cell_list_verlet_threads )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 24)
+		return;
+
+	float L = 1000.0;
+
+	std::srand(0);
+	std::default_random_engine eg;
+	std::uniform_real_distribution<float> ud(-L,L);
+
+	long int k = 4096 * v_cl.getProcessingUnits();
+
+	BOOST_TEST_CHECKPOINT( "Testing 3D periodic vector threaded cell-list and verlet-list k=" << k );
+
+	Box<3,float> box({-L,-L,-L},{L,L,L});
+
+	// Boundary conditions
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+
+	float r_cut = 100.0;
+
+	// ghost
+	Ghost<3,float> ghost(r_cut);
+
+	vector_dist<3,float, aggregate<size_t> > vd(k,box,bc,ghost);
+
+	auto it = vd.getIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<0>();
+
+	// sequential construction
+	auto NN = vd.getCellList<CELL_MEMFAST(3,float)>(r_cut);
+	auto ver = vd.getVerlet(r_cut);
+
+	// threaded construction
+	vd.setNNThreads(0);
+	auto NN2 = vd.getCellList<CELL_MEMFAST(3,float)>(r_cut);
+	auto ver2 = vd.getVerlet(r_cut);
+
+	bool ret = true;
+
+	auto p_it = vd.getDomainIterator();
+
+	while (p_it.isNext())
+	{
+		auto p = p_it.get();
+
+		Point<3,float> xp = vd.getPos(p);
+
+		// the particles must appear in the same order
+		auto Np = NN.getNNIterator(NN.getCell(xp));
+		auto Np2 = NN2.getNNIterator(NN2.getCell(xp));
+
+		while (Np.isNext())
+		{
+			ret &= Np2.isNext();
+			ret &= Np.get() == Np2.get();
+
+			++Np;
+			++Np2;
+		}
+
+		ret &= Np2.isNext() == false;
+
+		ret &= ver.getNNPart(p.getKey()) == ver2.getNNPart(p.getKey());
+
+		for (size_t i = 0 ; i < ver.getNNPart(p.getKey()) && i < ver2.getNNPart(p.getKey()) ; i++)
+		{ret &= ver.get(p.getKey(),i) == ver2.get(p.getKey(),i);}
+
+		++p_it;
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// move the particles and update the structures with threads
+	auto it2 = vd.getDomainIterator();
+
+	while (it2.isNext())
+	{
+		auto key = it2.get();
+
+		vd.getPos(key)[0] += 1.0;
+
+		++it2;
+	}
+
+	vd.map();
+	vd.ghost_get<0>();
+
+	vd.updateCellList(NN2);
+	vd.updateVerlet(ver2,r_cut);
+
+	vd.setNNThreads(1);
+	vd.updateCellList(NN);
+	vd.updateVerlet(ver,r_cut);
+
+	auto p_it2 = vd.getDomainIterator();
+
+	while (p_it2.isNext())
+	{
+		auto p = p_it2.get();
+
+		ret &= ver.getNNPart(p.getKey()) == ver2.getNNPart(p.getKey());
+
+		++p_it2;
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
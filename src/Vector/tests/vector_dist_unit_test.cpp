@@ -16,6 +16,7 @@
 #include "vector_dist_util_unit_tests.hpp"
 #include "Point_test.hpp"
 #include "Vector/performance/vector_dist_performance_common.hpp"
+#include "lib/pdata_python.hpp"
 
 /*! \brief Print a string about the test
  *
@@ -1993,5 +1994,1043 @@ BOOST_AUTO_TEST_CASE ( vector_of_cell_list_compile_test )
 }
 
 
-BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_CASE( vector_dist_write_aggregated )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 48)
+	{return;}
+
+	std::default_random_engine eg;
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	Ghost<3,float> g(0.05);
+	size_t bc[3] = {NON_PERIODIC,NON_PERIODIC,NON_PERIODIC};
+
+	vector_dist<3,float,aggregate<float,float[3]>> vd(1000,domain,bc,g);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		vd.getProp<0>(key) = key.getKey();
+		vd.getProp<1>(key)[0] = vd.getPos(key)[0];
+		vd.getProp<1>(key)[1] = vd.getPos(key)[1];
+		vd.getProp<1>(key)[2] = vd.getPos(key)[2];
+
+		++it;
+	}
+
+	vd.map();
+
+	// Two aggregators (or one if we run on one processor)
+	vd.setOutputAggregators(2);
+	bool ret = vd.write("vector_dist_aggregated");
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	size_t g_sz = (v_cl.size() + 1) / 2;
+
+	// only the aggregators produce a file
+	std::ifstream f("vector_dist_aggregated_" + std::to_string(v_cl.rank() / g_sz) + ".vtp");
+	BOOST_REQUIRE_EQUAL(f.good(),true);
+
+	// the frames are aggregated too
+	ret = vd.write_frame("vector_dist_aggregated",3,VTK_WRITER | FORMAT_BINARY);
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	std::ifstream f3("vector_dist_aggregated_" + std::to_string(v_cl.rank() / g_sz) + "_3.vtp");
+	BOOST_REQUIRE_EQUAL(f3.good(),true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_for_each_parallel )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 48)
+	{return;}
+
+	std::default_random_engine eg;
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	Ghost<3,float> g(0.05);
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	vector_dist<3,float,aggregate<float,size_t>> vd(10000,domain,bc,g);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<>();
+
+	vd.for_each_parallel([&](vect_dist_key_dx p)
+	{
+		vd.getProp<0>(p) = vd.getPos(p)[0];
+		vd.getProp<1>(p) = 0;
+	});
+
+	//! [for_each_parallel reduction]
+
+	double sum = vd.for_each_parallel_reduce(0.0,[&](vect_dist_key_dx p, double & partial)
+	{
+		partial += vd.getProp<0>(p);
+	},
+	[](double a, double b){return a + b;});
+
+	//! [for_each_parallel reduction]
+
+	double sum_seq = 0.0;
+	auto it2 = vd.getDomainIterator();
+
+	while (it2.isNext())
+	{
+		auto p = it2.get();
+
+		sum_seq += vd.getProp<0>(p);
+
+		++it2;
+	}
+
+	BOOST_REQUIRE_CLOSE(sum,sum_seq,0.001);
+
+	// every domain particle is visited once when we chunk by cells
+	auto NN = vd.getCellList<CELL_MEMFAST(3,float)>(0.05);
+
+	vd.for_each_parallel_cells(NN,[&](vect_dist_key_dx p)
+	{
+		vd.getProp<1>(p) += 1;
+	});
+
+	bool ret = true;
+	auto it3 = vd.getDomainIterator();
+
+	while (it3.isNext())
+	{
+		auto p = it3.get();
+
+		ret &= vd.getProp<1>(p) == 1;
+
+		++it3;
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_remove_unordered )
+{
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	Ghost<3,float> g(0.05);
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	vector_dist<3,float,aggregate<size_t>> vd(5000,domain,bc,g);
+
+	std::default_random_engine eg;
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<>();
+
+	// tag every particle with its index
+	size_t n_real = vd.size_local();
+	size_t n_ghost = vd.size_local_with_ghost() - n_real;
+
+	for (size_t i = 0 ; i < vd.size_local_with_ghost() ; i++)
+	{vd.getPropNC<0>(i) = i;}
+
+	// remove the particles in the left part of the domain, the keys are not sorted
+	//! [remove unordered]
+
+	openfpm::vector<size_t> keys;
+	for (long int i = n_real - 1 ; i >= 0 ; i--)
+	{
+		if (vd.getPos(i)[0] < 0.3)
+		{keys.add(i);}
+	}
+
+	// duplicates are ignored
+	if (keys.size() != 0)
+	{keys.add(keys.get(0));}
+
+	openfpm::vector<std::pair<size_t,size_t>> moved;
+	vd.remove_unordered(keys,&moved);
+
+	//! [remove unordered]
+
+	size_t n_removed = (keys.size() == 0)?0:keys.size() - 1;
+
+	BOOST_REQUIRE_EQUAL(vd.size_local(),n_real - n_removed);
+	BOOST_REQUIRE_EQUAL(vd.size_local_with_ghost() - vd.size_local(),n_ghost);
+
+	// the real particles left are the ones on the right, each one once
+	openfpm::vector<unsigned char> seen;
+	seen.resize(n_real);
+	for (size_t i = 0 ; i < n_real ; i++)
+	{seen.get(i) = 0;}
+
+	bool ret = true;
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		size_t id = vd.getProp<0>(i);
+
+		ret &= vd.getPos(i)[0] >= 0.3;
+		ret &= id < n_real;
+
+		if (id < n_real)
+		{
+			ret &= seen.get(id) == 0;
+			seen.get(id) = 1;
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// the moved particles are reported
+	for (size_t i = 0 ; i < moved.size() ; i++)
+	{ret &= (vd.getProp<0>(moved.get(i).second) == moved.get(i).first);}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// ghost are preserved
+	for (size_t i = 0 ; i < n_ghost ; i++)
+	{ret &= (vd.getProp<0>(vd.size_local() + i) == n_real + i);}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_ghost_get_cutoff )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 48)
+	{return;}
+
+	std::default_random_engine eg;
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	Ghost<3,float> g(0.1);
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	vector_dist<3,float,aggregate<float[3]>> vd(5000,domain,bc,g);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		vd.getProp<0>(key)[0] = vd.getPos(key)[0];
+		vd.getProp<0>(key)[1] = vd.getPos(key)[1];
+		vd.getProp<0>(key)[2] = vd.getPos(key)[2];
+
+		++it;
+	}
+
+	vd.map();
+
+	// the ghost properties must match the ghost positions (up to the periodic shift)
+	auto check = [&]()
+	{
+		bool ret = true;
+		auto it3 = vd.getGhostIterator();
+
+		while (it3.isNext())
+		{
+			auto key = it3.get();
+
+			for (size_t i = 0 ; i < 3 ; i++)
+			{
+				float d = fabs(vd.getPos(key)[i] - vd.getProp<0>(key)[i]);
+				ret &= (d < 0.001) || (fabs(d - 1.0) < 0.001);
+			}
+
+			++it3;
+		}
+
+		return ret;
+	};
+
+	vd.ghost_get<0>();
+	size_t n_full = vd.size_local_with_ghost();
+
+	// count the full ghost particles inside the local sub-domains enlarged by the cutoff
+	float r_cut = 0.03;
+	auto & dec = vd.getDecomposition();
+
+	size_t n_expected = vd.size_local();
+	for (size_t k = vd.size_local() ; k < vd.size_local_with_ghost() ; k++)
+	{
+		Point<3,float> p = vd.getPos(k);
+
+		for (size_t s = 0 ; s < dec.getNSubDomain() ; s++)
+		{
+			Box<3,float> sub = dec.getSubDomain(s);
+			sub.enlarge(Ghost<3,float>(r_cut));
+
+			if (sub.isInsideNP(p) == true)
+			{
+				n_expected++;
+				break;
+			}
+		}
+	}
+
+	//! [ghost_get with cutoff]
+
+	// thin layer for a short range interaction
+	vd.ghost_get<0>(WITH_POSITION,r_cut);
+
+	//! [ghost_get with cutoff]
+
+	size_t n_thin = vd.size_local_with_ghost();
+
+	BOOST_REQUIRE_EQUAL(n_thin,n_expected);
+	BOOST_REQUIRE_EQUAL(check(),true);
+
+	// alternate the cutoffs reusing the labelling
+	vd.ghost_get<0>(WITH_POSITION | SKIP_LABELLING);
+
+	BOOST_REQUIRE_EQUAL(vd.size_local_with_ghost(),n_full);
+	BOOST_REQUIRE_EQUAL(check(),true);
+
+	vd.ghost_get<0>(WITH_POSITION | SKIP_LABELLING,r_cut);
+
+	BOOST_REQUIRE_EQUAL(vd.size_local_with_ghost(),n_thin);
+	BOOST_REQUIRE_EQUAL(check(),true);
+
+	size_t n_thin_tot = n_thin - vd.size_local();
+	size_t n_full_tot = n_full - vd.size_local();
+	v_cl.sum(n_thin_tot);
+	v_cl.sum(n_full_tot);
+	v_cl.execute();
+
+	BOOST_REQUIRE(n_thin_tot < n_full_tot);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_Imap )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	std::default_random_engine eg(v_cl.rank());
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	Ghost<3,float> g(0.1);
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	vector_dist<3,float,aggregate<float,float[3]>> vd(0,domain,bc,g);
+
+	// every processor create particles everywhere
+	for (size_t i = 0 ; i < 1000 ; i++)
+	{
+		vd.add();
+
+		vd.getLastPos()[0] = ud(eg);
+		vd.getLastPos()[1] = ud(eg);
+		vd.getLastPos()[2] = ud(eg);
+
+		vd.getLastProp<1>()[0] = vd.getLastPos()[0];
+		vd.getLastProp<1>()[1] = vd.getLastPos()[1];
+		vd.getLastProp<1>()[2] = vd.getLastPos()[2];
+	}
+
+	size_t n_tot = vd.size_local();
+	v_cl.sum(n_tot);
+	v_cl.execute();
+
+	//! [Imap overlap]
+
+	vd.Imap();
+
+	// the particles that stay can be processed while the others are in flight
+	bool match = true;
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		match &= vd.getDecomposition().isLocal(vd.getPos(key));
+		vd.getProp<0>(key) = 1.0;
+
+		++it;
+	}
+
+	vd.map_wait();
+
+	//! [Imap overlap]
+
+	BOOST_REQUIRE_EQUAL(match,true);
+
+	size_t n_tot2 = vd.size_local();
+	v_cl.sum(n_tot2);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(n_tot,n_tot2);
+
+	// all the particles are local and carry their properties
+	auto it2 = vd.getDomainIterator();
+
+	while (it2.isNext())
+	{
+		auto key = it2.get();
+
+		match &= vd.getDecomposition().isLocal(vd.getPos(key));
+
+		for (size_t i = 0 ; i < 3 ; i++)
+		{match &= vd.getProp<1>(key)[i] == vd.getPos(key)[i];}
+
+		++it2;
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+	BOOST_REQUIRE_EQUAL(vd.size_local(),vd.size_local_with_ghost());
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_ghost_get_zero_copy )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 48)
+	{return;}
+
+	std::default_random_engine eg;
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	Ghost<3,float> g(0.1);
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	vector_dist<3,float,aggregate<float,float[3],int>> vd(5000,domain,bc,g);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		++it;
+	}
+
+	vd.map();
+
+	// set the properties from the position
+	auto set = [&](float s)
+	{
+		auto it2 = vd.getDomainIterator();
+
+		while (it2.isNext())
+		{
+			auto key = it2.get();
+
+			vd.getProp<0>(key) = s * vd.getPos(key)[0];
+			vd.getProp<1>(key)[0] = s * vd.getPos(key)[0];
+			vd.getProp<1>(key)[1] = s * vd.getPos(key)[1];
+			vd.getProp<1>(key)[2] = s * vd.getPos(key)[2];
+			vd.getProp<2>(key) = s;
+
+			++it2;
+		}
+	};
+
+	set(1.0);
+	vd.ghost_get<0,1,2>();
+
+	set(2.0);
+
+	//! [ghost_get zero copy]
+
+	// same ghost layout, property 0 and 1 sent directly from the particles
+	vd.ghost_get<0,1>(SKIP_LABELLING | GHOST_ZERO_COPY);
+
+	//! [ghost_get zero copy]
+
+	bool match = true;
+	auto it3 = vd.getGhostIterator();
+
+	while (it3.isNext())
+	{
+		auto key = it3.get();
+
+		// the ghost position is shifted for periodic images
+		for (size_t i = 0 ; i < 3 ; i++)
+		{
+			float d = fabs(2.0 * vd.getPos(key)[i] - vd.getProp<1>(key)[i]);
+			match &= (d < 0.001) || (fabs(d - 2.0) < 0.001);
+		}
+
+		float d0 = fabs(2.0 * vd.getPos(key)[0] - vd.getProp<0>(key));
+		match &= (d0 < 0.001) || (fabs(d0 - 2.0) < 0.001);
+
+		// property 2 has not been sent, it is the one of the first ghost_get
+		match &= vd.getProp<2>(key) == 1;
 
+		++it3;
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+
+	// the properties has been exchanged without buffers
+	BOOST_REQUIRE_EQUAL(vd.getGhostZeroCopyCount(),1ul);
+
+	// a second exchange reuse the datatypes of the first one
+	set(3.0);
+	vd.ghost_get<0>(SKIP_LABELLING | GHOST_ZERO_COPY);
+	vd.ghost_get<0,1>(SKIP_LABELLING | GHOST_ZERO_COPY);
+
+	BOOST_REQUIRE_EQUAL(vd.getGhostZeroCopyCount(),3ul);
+
+	auto it4 = vd.getGhostIterator();
+
+	while (it4.isNext())
+	{
+		auto key = it4.get();
+
+		float d0 = fabs(3.0 * vd.getPos(key)[0] - vd.getProp<0>(key));
+		match &= (d0 < 0.001) || (fabs(d0 - 3.0) < 0.001);
+
+		float d1 = fabs(3.0 * vd.getPos(key)[2] - vd.getProp<1>(key)[2]);
+		match &= (d1 < 0.001) || (fabs(d1 - 3.0) < 0.001);
+
+		++it4;
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+
+	// a new labelling use the buffered exchange
+	vd.ghost_get<0,1,2>();
+
+	BOOST_REQUIRE_EQUAL(vd.getGhostZeroCopyCount(),3ul);
+
+	// alternate two cutoffs, every cutoff has its own ghost layout
+	vd.ghost_get<0,1,2>(WITH_POSITION,0.05);
+
+	for (size_t k = 0 ; k < 4 ; k++)
+	{
+		float rc = (k % 2 == 0)?0.1:0.05;
+		float s = 4.0 + k;
+
+		set(s);
+		vd.ghost_get<0,1>(SKIP_LABELLING | GHOST_ZERO_COPY,rc);
+
+		auto it5 = vd.getGhostIterator();
+
+		while (it5.isNext())
+		{
+			auto key = it5.get();
+
+			float d0 = fabs(s * vd.getPos(key)[0] - vd.getProp<0>(key));
+			match &= (d0 < 0.001) || (fabs(d0 - s) < 0.001);
+
+			float d1 = fabs(s * vd.getPos(key)[1] - vd.getProp<1>(key)[1]);
+			match &= (d1 < 0.001) || (fabs(d1 - s) < 0.001);
+
+			++it5;
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+	BOOST_REQUIRE_EQUAL(vd.getGhostZeroCopyCount(),7ul);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_neighbor_collective )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 48)
+	{return;}
+
+	std::default_random_engine eg;
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	Ghost<3,float> g(0.1);
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	vector_dist<3,float,aggregate<float,float,int>> vd(5000,domain,bc,g);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		vd.getProp<0>(key) = vd.getPos(key)[0];
+		vd.getProp<1>(key) = vd.getPos(key)[1];
+
+		++it;
+	}
+
+	vd.map();
+
+	// reference exchanged with NBX
+	vector_dist<3,float,aggregate<float,float,int>> vd2(vd);
+
+	//! [ghost_get neighbor collective]
+
+	vd.ghost_get<0,1>(NEIGHBOR_COLLECTIVE);
+
+	//! [ghost_get neighbor collective]
+
+	vd2.ghost_get<0,1>();
+
+	BOOST_REQUIRE_EQUAL(vd.size_local_with_ghost(),vd2.size_local_with_ghost());
+
+	double s0 = 0.0;
+	double s0_2 = 0.0;
+	bool match = true;
+
+	for (size_t i = vd.size_local() ; i < vd.size_local_with_ghost() ; i++)
+	{
+		s0 += vd.getProp<0>(i);
+		s0_2 += vd2.getProp<0>(i);
+
+		// the ghost position is shifted for periodic images
+		float d = fabs(vd.getPos(i)[1] - vd.getProp<1>(i));
+		match &= (d < 0.001) || (fabs(d - 1.0) < 0.001);
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+	BOOST_REQUIRE_CLOSE(s0,s0_2,0.001);
+
+	// ghost_put, same ghost layout
+	for (size_t i = 0 ; i < vd.size_local_with_ghost() ; i++)
+	{
+		vd.getProp<2>(i) = 1;
+		vd2.getProp<2>(i) = 1;
+	}
+
+	vd.ghost_put<add_,2>(NEIGHBOR_COLLECTIVE);
+	vd2.ghost_put<add_,2>();
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{match &= vd.getProp<2>(i) == vd2.getProp<2>(i);}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+
+	// move the particles less than the ghost, they go only to the near processors
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		vd.getPos(i)[0] += 0.05;
+		vd2.getPos(i)[0] += 0.05;
+	}
+
+	vd.map(MAP_LOCAL | NEIGHBOR_COLLECTIVE);
+	vd2.map();
+
+	BOOST_REQUIRE_EQUAL(vd.size_local(),vd2.size_local());
+
+	size_t tot = vd.size_local();
+	v_cl.sum(tot);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(tot,5000ul);
+
+	// move the particles further than the near processors, the NBX exchange is used and no particle is lost
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		vd.getPos(i)[0] += 0.5;
+		vd.getPos(i)[1] += 0.5;
+		vd2.getPos(i)[0] += 0.5;
+		vd2.getPos(i)[1] += 0.5;
+	}
+
+	vd.map(MAP_LOCAL | NEIGHBOR_COLLECTIVE);
+	vd2.map();
+
+	BOOST_REQUIRE_EQUAL(vd.size_local(),vd2.size_local());
+
+	tot = vd.size_local();
+	v_cl.sum(tot);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(tot,5000ul);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_neighbor_collective_skip_labelling )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 48)
+	{return;}
+
+	std::default_random_engine eg;
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	Ghost<3,float> g(0.1);
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	vector_dist<3,float,aggregate<float,float,int>> vd(5000,domain,bc,g);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		vd.getProp<0>(key) = vd.getPos(key)[0];
+		vd.getProp<1>(key) = vd.getPos(key)[1];
+
+		++it;
+	}
+
+	vd.map();
+
+	// reference exchanged with NBX
+	vector_dist<3,float,aggregate<float,float,int>> vd2(vd);
+
+	vd.ghost_get<0,1>(NEIGHBOR_COLLECTIVE);
+	vd2.ghost_get<0,1>();
+
+	// change the properties and exchange them on the same ghost layout
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		vd.getProp<0>(i) = 2.0 * vd.getPos(i)[0];
+		vd.getProp<1>(i) = 2.0 * vd.getPos(i)[1];
+		vd2.getProp<0>(i) = 2.0 * vd2.getPos(i)[0];
+		vd2.getProp<1>(i) = 2.0 * vd2.getPos(i)[1];
+	}
+
+	size_t n_ghost = vd.size_local_with_ghost();
+
+	vd.ghost_get<0,1>(SKIP_LABELLING | NO_CHANGE_ELEMENTS | NEIGHBOR_COLLECTIVE);
+	vd2.ghost_get<0,1>(SKIP_LABELLING | NO_CHANGE_ELEMENTS);
+
+	BOOST_REQUIRE_EQUAL(vd.size_local_with_ghost(),n_ghost);
+	BOOST_REQUIRE_EQUAL(vd.size_local_with_ghost(),vd2.size_local_with_ghost());
+
+	double s0 = 0.0;
+	double s0_2 = 0.0;
+	bool match = true;
+
+	for (size_t i = vd.size_local() ; i < vd.size_local_with_ghost() ; i++)
+	{
+		s0 += vd.getProp<0>(i);
+		s0_2 += vd2.getProp<0>(i);
+
+		// the ghost position is shifted for periodic images
+		float d = fabs(2.0 * vd.getPos(i)[1] - vd.getProp<1>(i));
+		match &= (d < 0.001) || (fabs(d - 2.0) < 0.001);
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+	BOOST_REQUIRE_CLOSE(s0,s0_2,0.001);
+
+	// ghost_put on the same ghost layout
+	for (size_t i = 0 ; i < vd.size_local_with_ghost() ; i++)
+	{
+		vd.getProp<2>(i) = 1;
+		vd2.getProp<2>(i) = 1;
+	}
+
+	vd.ghost_put<add_,2>(NO_CHANGE_ELEMENTS | NEIGHBOR_COLLECTIVE);
+	vd2.ghost_put<add_,2>(NO_CHANGE_ELEMENTS);
+
+	size_t tot = 0;
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		match &= vd.getProp<2>(i) == vd2.getProp<2>(i);
+		tot += vd.getProp<2>(i) - 1;
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+
+	// every ghost particle has been added to its real particle
+	size_t n_g = vd.size_local_with_ghost() - vd.size_local();
+	v_cl.sum(tot);
+	v_cl.sum(n_g);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(tot,n_g);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_ghost_node_shared )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 48)
+	{return;}
+
+	std::default_random_engine eg;
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	Ghost<3,float> g(0.1);
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	vector_dist<3,float,aggregate<float,float,int>> vd(5000,domain,bc,g);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		vd.getProp<0>(key) = vd.getPos(key)[0];
+		vd.getProp<1>(key) = vd.getPos(key)[1];
+
+		++it;
+	}
+
+	vd.map();
+
+	// reference exchanged with NBX
+	vector_dist<3,float,aggregate<float,float,int>> vd2(vd);
+
+	vd.ghost_get<0,1>(GHOST_NODE_SHARED);
+	vd2.ghost_get<0,1>();
+
+	BOOST_REQUIRE_EQUAL(vd.size_local_with_ghost(),vd2.size_local_with_ghost());
+
+	double s0 = 0.0;
+	double s0_2 = 0.0;
+	bool match = true;
+
+	for (size_t i = vd.size_local() ; i < vd.size_local_with_ghost() ; i++)
+	{
+		s0 += vd.getProp<0>(i);
+		s0_2 += vd2.getProp<0>(i);
+
+		// the ghost position is shifted for periodic images
+		float d = fabs(vd.getPos(i)[1] - vd.getProp<1>(i));
+		match &= (d < 0.001) || (fabs(d - 1.0) < 0.001);
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+	BOOST_REQUIRE_CLOSE(s0,s0_2,0.001);
+
+	// change the properties and exchange them on the same ghost layout
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{
+		vd.getProp<0>(i) = 2.0 * vd.getPos(i)[0];
+		vd.getProp<1>(i) = 2.0 * vd.getPos(i)[1];
+		vd2.getProp<0>(i) = 2.0 * vd2.getPos(i)[0];
+		vd2.getProp<1>(i) = 2.0 * vd2.getPos(i)[1];
+	}
+
+	size_t n_ghost = vd.size_local_with_ghost();
+
+	vd.ghost_get<0,1>(SKIP_LABELLING | GHOST_NODE_SHARED);
+	vd2.ghost_get<0,1>(SKIP_LABELLING);
+
+	BOOST_REQUIRE_EQUAL(vd.size_local_with_ghost(),n_ghost);
+
+	s0 = 0.0;
+	s0_2 = 0.0;
+
+	for (size_t i = vd.size_local() ; i < vd.size_local_with_ghost() ; i++)
+	{
+		s0 += vd.getProp<0>(i);
+		s0_2 += vd2.getProp<0>(i);
+
+		float d = fabs(2.0 * vd.getPos(i)[1] - vd.getProp<1>(i));
+		match &= (d < 0.001) || (fabs(d - 2.0) < 0.001);
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+	BOOST_REQUIRE_CLOSE(s0,s0_2,0.001);
+
+	// ghost_put on the ghost received from the shared segments
+	for (size_t i = 0 ; i < vd.size_local_with_ghost() ; i++)
+	{
+		vd.getProp<2>(i) = 1;
+		vd2.getProp<2>(i) = 1;
+	}
+
+	vd.ghost_put<add_,2>();
+	vd2.ghost_put<add_,2>();
+
+	for (size_t i = 0 ; i < vd.size_local() ; i++)
+	{match &= vd.getProp<2>(i) == vd2.getProp<2>(i);}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+}
+
+/*! \brief Element i of a view
+ *
+ */
+template<typename T> T & py_view_get(const py_view & v, size_t i, size_t j = 0)
+{
+	return *(T *)((char *)v.ptr + i*v.strides[0] + ((v.ndim > 1)?j*v.strides[1]:0));
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_python_view_round_trip )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	if (v_cl.getProcessingUnits() > 48)
+	{return;}
+
+	std::default_random_engine eg;
+	std::uniform_real_distribution<float> ud(0.0f, 1.0f);
+
+	Box<3,float> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	Ghost<3,float> g(0.1);
+	size_t bc[3] = {NON_PERIODIC,NON_PERIODIC,NON_PERIODIC};
+
+	vector_dist<3,float,aggregate<float,int,float[3]>> vd(1000,domain,bc,g);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.getPos(key)[0] = ud(eg);
+		vd.getPos(key)[1] = ud(eg);
+		vd.getPos(key)[2] = ud(eg);
+
+		++it;
+	}
+
+	// the vector is seen through the C interface used by python
+	void * h = py_register_vector_dist(vd);
+
+	BOOST_REQUIRE_EQUAL(ofp_vector_dist_dim(h),3);
+	BOOST_REQUIRE_EQUAL(ofp_vector_dist_n_prop(h),3);
+
+	py_view p0;
+	py_view p1;
+	py_view p2;
+	py_view x;
+
+	// a property that does not exist
+	BOOST_REQUIRE_EQUAL(ofp_vector_dist_prop_view(h,3,&p0),-1);
+
+	BOOST_REQUIRE_EQUAL(ofp_vector_dist_map(h),0);
+
+	ofp_vector_dist_pos_view(h,&x);
+	ofp_vector_dist_prop_view(h,0,&p0);
+	ofp_vector_dist_prop_view(h,1,&p1);
+	ofp_vector_dist_prop_view(h,2,&p2);
+
+	size_t n = ofp_vector_dist_size_local(h);
+	BOOST_REQUIRE_EQUAL(n,vd.size_local());
+
+	BOOST_REQUIRE_EQUAL(x.dtype,PY_FLOAT);
+	BOOST_REQUIRE_EQUAL(p0.dtype,PY_FLOAT);
+	BOOST_REQUIRE_EQUAL(p1.dtype,PY_INT);
+	BOOST_REQUIRE_EQUAL(p2.dtype,PY_FLOAT);
+
+	BOOST_REQUIRE_EQUAL(x.ndim,2);
+	BOOST_REQUIRE_EQUAL(p0.ndim,1);
+	BOOST_REQUIRE_EQUAL(p1.ndim,1);
+	BOOST_REQUIRE_EQUAL(p2.ndim,2);
+	BOOST_REQUIRE_EQUAL(p2.shape[1],3ul);
+
+	// the views point to the memory of the vector
+	bool match = true;
+	for (size_t i = 0 ; i < n ; i++)
+	{
+		match &= &py_view_get<float>(p0,i) == &vd.getPropNC<0>(i);
+		match &= &py_view_get<int>(p1,i) == &vd.getPropNC<1>(i);
+
+		for (size_t j = 0 ; j < 3 ; j++)
+		{
+			match &= &py_view_get<float>(x,i,j) == &vd.getPos(i)[j];
+			match &= &py_view_get<float>(p2,i,j) == &vd.getPropNC<2>(i)[j];
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(match,true);
+
+	// write the properties through the views
+	for (size_t i = 0 ; i < n ; i++)
+	{
+		py_view_get<float>(p0,i) = py_view_get<float>(x,i,0);
+		py_view_get<int>(p1,i) = py_view_get<float>(x,i,1) * 1000000;
+
+		for (size_t j = 0 ; j < 3 ; j++)
+		{py_view_get<float>(p2,i,j) = py_view_get<float>(x,i,j);}
+	}
+
+	BOOST_REQUIRE_EQUAL(ofp_vector_dist_ghost_get(h,1),0);
+
+	BOOST_REQUIRE_EQUAL(ofp_vector_dist_size_local_with_ghost(h),vd.size_local_with_ghost());
+
+	// the views must be requested again after ghost_get
+	ofp_vector_dist_pos_view(h,&x);
+	ofp_vector_dist_prop_view(h,0,&p0);
+	ofp_vector_dist_prop_view(h,1,&p1);
+	ofp_vector_dist_prop_view(h,2,&p2);
+
+	BOOST_REQUIRE_EQUAL(x.shape[0],vd.size_local_with_ghost());
+	BOOST_REQUIRE_EQUAL(p2.shape[0],vd.size_local_with_ghost());
+
+	// real and ghost particles carry the values written through the views
+	bool ret = true;
+	for (size_t i = 0 ; i < vd.size_local_with_ghost() ; i++)
+	{
+		ret &= vd.getPropNC<0>(i) == vd.getPos(i)[0];
+		ret &= vd.getPropNC<1>(i) == (int)(vd.getPos(i)[1] * 1000000);
+		ret &= py_view_get<float>(p0,i) == vd.getPos(i)[0];
+
+		for (size_t j = 0 ; j < 3 ; j++)
+		{
+			ret &= vd.getPropNC<2>(i)[j] == vd.getPos(i)[j];
+			ret &= py_view_get<float>(p2,i,j) == py_view_get<float>(x,i,j);
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// the handle does not own the vector
+	ofp_vector_dist_delete(h);
+
+	BOOST_REQUIRE_EQUAL(vd.size_local(),n);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,292 @@
+/*
+ * vector_dist_ghost_zero_copy.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef VECTOR_DIST_GHOST_ZERO_COPY_HPP_
+#define VECTOR_DIST_GHOST_ZERO_COPY_HPP_
+
+#include <mpi.h>
+#include <utility>
+#include "Vector/map_vector.hpp"
+
+/*! \brief Get the address of the first element of a vector with linear layout
+ *
+ * It is the lowest address of the properties of the element 0
+ *
+ */
+template<typename vector_type>
+struct ghost_zc_base
+{
+	//! vector
+	vector_type & v;
+
+	//! lowest address
+	char * base;
+
+	//! constructor
+	ghost_zc_base(vector_type & v)
+	:v(v),base((char *)&v.template get<0>(0))
+	{}
+
+	//! It call the functor for each property
+	template<typename T>
+	inline void operator()(T& t)
+	{
+		char * a = (char *)&v.template get<T::value>(0);
+
+		if (a < base)
+		{base = a;}
+	}
+};
+
+/*! \brief MPI datatypes of a set of exchanged properties
+ *
+ */
+struct ghost_zc_layout
+{
+	//! size of a particle
+	size_t el_sz;
+
+	//! offset and size of the properties inside a particle
+	openfpm::vector<std::pair<size_t,size_t>> blocks;
+
+	//! selected properties of one particle
+	MPI_Datatype el_s;
+
+	//! selected properties of one particle with the extent of the full particle
+	MPI_Datatype el;
+
+	//! for each processor to send, the particles to send (MPI_DATATYPE_NULL if there is nothing to send)
+	openfpm::vector<MPI_Datatype> types;
+};
+
+/*! \brief Ghost exchange of a set of properties without send and receive buffers
+ *
+ * The properties are sent directly from the particle vector with an MPI indexed datatype built on the list
+ * of the particles to send, and received directly in the ghost part of the vector. It work for vectors in host
+ * memory with linear layout, where the properties of a particle are contiguous
+ *
+ * The ghost layout (processors and number of particles received from each processor) must be the one of a
+ * previous ghost_get, so this exchange is only used with SKIP_LABELLING. The datatypes are created at the first
+ * exchange of a set of properties and reused until reset is called (new labelling)
+ *
+ */
+class ghost_zero_copy
+{
+	//! communicator used for the exchange (duplicated from MPI_COMM_WORLD)
+	MPI_Comm comm = MPI_COMM_NULL;
+
+	//! requests of the exchange
+	openfpm::vector<MPI_Request> req;
+
+	//! datatypes for each set of exchanged properties
+	openfpm::vector<ghost_zc_layout> layouts;
+
+	//! displacements of the particles to send
+	openfpm::vector<int> disp;
+
+	/*! \brief Free the datatypes
+	 *
+	 */
+	void free_types()
+	{
+		int finalized = 0;
+		MPI_Finalized(&finalized);
+
+		if (finalized == false)
+		{
+			for (size_t i = 0 ; i < layouts.size() ; i++)
+			{
+				auto & l = layouts.get(i);
+
+				for (size_t j = 0 ; j < l.types.size() ; j++)
+				{
+					if (l.types.get(j) != MPI_DATATYPE_NULL)
+					{MPI_Type_free(&l.types.get(j));}
+				}
+
+				MPI_Type_free(&l.el);
+				MPI_Type_free(&l.el_s);
+			}
+		}
+
+		layouts.clear();
+	}
+
+	/*! \brief Get the datatypes of a set of properties, they are created if not present
+	 *
+	 * \see exchange
+	 *
+	 */
+	template<typename vector_opart_type>
+	ghost_zc_layout & get_layout(size_t el_sz,
+								 const openfpm::vector<std::pair<size_t,size_t>> & blocks,
+								 const openfpm::vector<size_t> & prc_send,
+								 vector_opart_type & g_opart)
+	{
+		for (size_t i = 0 ; i < layouts.size() ; i++)
+		{
+			auto & l = layouts.get(i);
+
+			if (l.el_sz != el_sz || l.blocks.size() != blocks.size())
+			{continue;}
+
+			bool eq = true;
+			for (size_t j = 0 ; j < blocks.size() ; j++)
+			{eq &= l.blocks.get(j) == blocks.get(j);}
+
+			if (eq == true)
+			{return l;}
+		}
+
+		layouts.add();
+		auto & l = layouts.last();
+
+		l.el_sz = el_sz;
+		l.blocks = blocks;
+
+		// one particle: the selected properties with the extent of the full particle
+		openfpm::vector<int> bl(blocks.size());
+		openfpm::vector<MPI_Aint> off(blocks.size());
+		openfpm::vector<MPI_Datatype> bt(blocks.size());
+
+		for (size_t i = 0 ; i < blocks.size() ; i++)
+		{
+			off.get(i) = blocks.get(i).first;
+			bl.get(i) = blocks.get(i).second;
+			bt.get(i) = MPI_BYTE;
+		}
+
+		MPI_Type_create_struct(blocks.size(),&bl.get(0),&off.get(0),&bt.get(0),&l.el_s);
+		MPI_Type_create_resized(l.el_s,0,el_sz,&l.el);
+		MPI_Type_commit(&l.el);
+
+		// the particles to send to each processor
+		l.types.resize(prc_send.size());
+		for (size_t i = 0 ; i < prc_send.size() ; i++)
+		{
+			size_t n = g_opart.get(i).size();
+
+			l.types.get(i) = MPI_DATATYPE_NULL;
+
+			if (n == 0)
+			{continue;}
+
+			disp.resize(n);
+			for (size_t j = 0 ; j < n ; j++)
+			{disp.get(j) = g_opart.get(i).template get<0>(j);}
+
+			MPI_Type_create_indexed_block(n,1,&disp.get(0),l.el,&l.types.get(i));
+			MPI_Type_commit(&l.types.get(i));
+		}
+
+		return l;
+	}
+
+public:
+
+	//! Constructor
+	ghost_zero_copy()
+	{}
+
+	//! Copy constructor, the communicator and the datatypes are not shared across objects
+	ghost_zero_copy(const ghost_zero_copy & zc)
+	{}
+
+	//! Copy, the communicator and the datatypes are not shared across objects
+	ghost_zero_copy & operator=(const ghost_zero_copy & zc)
+	{
+		reset();
+
+		return *this;
+	}
+
+	//! Destructor
+	~ghost_zero_copy()
+	{
+		free_types();
+
+		int finalized = 0;
+		MPI_Finalized(&finalized);
+
+		if (finalized == false && comm != MPI_COMM_NULL)
+		{MPI_Comm_free(&comm);}
+	}
+
+	/*! \brief Initialize the communicator
+	 *
+	 * \note It is collective on MPI_COMM_WORLD, it does nothing if already initialized
+	 *
+	 */
+	void init()
+	{
+		if (comm == MPI_COMM_NULL)
+		{MPI_Comm_dup(MPI_COMM_WORLD,&comm);}
+	}
+
+	/*! \brief Free the datatypes, to call when the particles to send change (new labelling)
+	 *
+	 */
+	void reset()
+	{
+		free_types();
+	}
+
+	/*! \brief Exchange the properties
+	 *
+	 * \param base address of the particle 0
+	 * \param el_sz size of a particle
+	 * \param blocks offset and size of the properties to exchange inside a particle
+	 * \param prc_send processors to send
+	 * \param g_opart for each processor to send the list of the particles to send
+	 * \param prc_recv processors from which we receive
+	 * \param recv_sz number of particles received from each processor
+	 * \param recv_start first ghost particle
+	 *
+	 */
+	template<typename vector_opart_type>
+	void exchange(void * base,
+				  size_t el_sz,
+				  const openfpm::vector<std::pair<size_t,size_t>> & blocks,
+				  const openfpm::vector<size_t> & prc_send,
+				  vector_opart_type & g_opart,
+				  const openfpm::vector<size_t> & prc_recv,
+				  const openfpm::vector<size_t> & recv_sz,
+				  size_t recv_start)
+	{
+		ghost_zc_layout & l = get_layout(el_sz,blocks,prc_send,g_opart);
+
+		req.clear();
+
+		// receive directly in the ghost part
+		size_t k = recv_start;
+		for (size_t i = 0 ; i < prc_recv.size() ; i++)
+		{
+			if (recv_sz.get(i) != 0)
+			{
+				req.add();
+				MPI_Irecv((char *)base + k*el_sz,recv_sz.get(i),l.el,prc_recv.get(i),0,comm,&req.last());
+			}
+
+			k += recv_sz.get(i);
+		}
+
+		// send directly from the particles
+		for (size_t i = 0 ; i < prc_send.size() ; i++)
+		{
+			if (l.types.get(i) == MPI_DATATYPE_NULL)
+			{continue;}
+
+			req.add();
+			MPI_Isend(base,1,l.types.get(i),prc_send.get(i),0,comm,&req.last());
+		}
+
+		if (req.size() != 0)
+		{MPI_Waitall(req.size(),&req.get(0),MPI_STATUSES_IGNORE);}
+	}
+};
+
+#endif /* VECTOR_DIST_GHOST_ZERO_COPY_HPP_ */
@@ -0,0 +1,557 @@
+/*
+ * vector_dist_multi_res.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef VECTOR_DIST_MULTI_RES_HPP_
+#define VECTOR_DIST_MULTI_RES_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "Vector/map_vector.hpp"
+#include "Space/Shape/Box.hpp"
+#include "Grid/grid_sm.hpp"
+#include "util/for_each_parallel.hpp"
+
+//! Maximum number of levels of a multi-resolution Cell-list
+#define MULTI_RES_MAX_LEVELS 16
+
+//! Number of particles processed by one work item in the construction of the multi-resolution structures
+#define MULTI_RES_CHUNK 1024
+
+/*! \brief Multi-resolution Cell-list for particles with different interaction radii
+ *
+ * Every particle p has its own radius r_p, two particles interact if their distance is smaller
+ * or equal than max(r_p,r_q). The particles are binned by radius into levels, the level l contain the particles
+ * with radius in (r_max/2^(l+1),r_max/2^l] (the last level contain all the smaller ones) and it has its own cells
+ * of side r_max/2^l. Searching the neighborhood of p in a level with cells bigger or equal than r_p
+ * require only the 3^dim cells around p, so with forEachNeighborCoarser a particle look only into its level and into
+ * the coarser ones. The interactions with the finer particles are found from the other side (the relation is
+ * symmetric), this is what VerletListMultiRes does.
+ *
+ * \tparam dim dimensionality
+ * \tparam St space type
+ *
+ */
+template<unsigned int dim, typename St>
+class CellListMultiRes
+{
+	//! Box where the Cell-list is defined
+	Box<dim,St> box;
+
+	//! biggest radius
+	St r_max;
+
+	//! cells of each level
+	openfpm::vector<grid_sm<dim,void>> gr;
+
+	//! for each level the particles ordered by cell (cell id, particle id)
+	openfpm::vector<openfpm::vector<std::pair<size_t,size_t>>> cells;
+
+	//! level of each particle
+	openfpm::vector<unsigned char> lvl;
+
+	//! radius of each particle
+	openfpm::vector<St> rad;
+
+	/*! \brief Get the cell of a position in a level
+	 *
+	 * \param l level
+	 * \param xp position
+	 *
+	 * \return the cell key
+	 *
+	 */
+	template<typename pos_type> grid_key_dx<dim> getCellKey(size_t l, const pos_type & xp) const
+	{
+		grid_key_dx<dim> k;
+		St c = getCellSize(l);
+
+		for (size_t i = 0 ; i < dim ; i++)
+		{
+			long int ki = (long int)std::floor((xp[i] - box.getLow(i)) / c);
+			ki = std::max(0l,std::min(ki,(long int)gr.get(l).size(i) - 1));
+			k.set_d(i,ki);
+		}
+
+		return k;
+	}
+
+	/*! \brief Call f on all the particles of a level in the cells around a position
+	 *
+	 * \param l level
+	 * \param xp position
+	 * \param n number of cells to search in each direction
+	 * \param f function f(q)
+	 *
+	 */
+	template<typename pos_type, typename lambda_f> void forEachInCells(size_t l, const pos_type & xp, long int n, lambda_f & f) const
+	{
+		if (cells.get(l).size() == 0)
+		{return;}
+
+		grid_key_dx<dim> kc = getCellKey(l,xp);
+		grid_key_dx<dim> start;
+		grid_key_dx<dim> stop;
+
+		for (size_t i = 0 ; i < dim ; i++)
+		{
+			start.set_d(i,std::max(0l,kc.get(i) - n));
+			stop.set_d(i,std::min((long int)gr.get(l).size(i) - 1,kc.get(i) + n));
+		}
+
+		const std::pair<size_t,size_t> * first = &cells.get(l).get(0);
+		const std::pair<size_t,size_t> * last = first + cells.get(l).size();
+
+		grid_key_dx_iterator_sub<dim> it(gr.get(l),start,stop);
+
+		while (it.isNext())
+		{
+			size_t cid = gr.get(l).LinId(it.get());
+
+			auto fnd = std::lower_bound(first,last,std::pair<size_t,size_t>(cid,0));
+
+			for ( ; fnd != last && fnd->first == cid ; ++fnd)
+			{f(fnd->second);}
+
+			++it;
+		}
+	}
+
+	/*! \brief Call f on all the particles q of a level with distance from p smaller or equal than max(r_p,r_q)
+	 *
+	 * \param l level
+	 * \param p particle
+	 * \param v_pos particle positions
+	 * \param f function f(q)
+	 *
+	 */
+	template<typename vector_pos_type, typename lambda_f> void forEachNeighborLevel(size_t l, size_t p, const vector_pos_type & v_pos, lambda_f & f) const
+	{
+		// all the particles of the level has radius smaller than the cell size
+		St c = getCellSize(l);
+		St r = std::max(rad.get(p),c);
+		long int n = (long int)std::ceil(r / c);
+
+		auto xp = v_pos.template get<0>(p);
+
+		auto fc = [&](size_t q)
+		{
+			if (q == p)
+			{return;}
+
+			St r_pq = std::max(rad.get(p),rad.get(q));
+
+			St d2 = 0;
+			for (size_t i = 0 ; i < dim ; i++)
+			{
+				St dx = v_pos.template get<0>(q)[i] - xp[i];
+				d2 += dx*dx;
+			}
+
+			if (d2 <= r_pq*r_pq)
+			{f(q);}
+		};
+
+		forEachInCells(l,xp,n,fc);
+	}
+
+public:
+
+	/*! \brief Construct the multi-resolution Cell-list
+	 *
+	 * \tparam prp_r property containing the radius of the particles
+	 *
+	 * \param bx box where the Cell-list is defined (it must contain all the particles)
+	 * \param r_mx biggest radius
+	 * \param n_lvl number of levels
+	 * \param v_pos particle positions
+	 * \param v_prp particle properties
+	 *
+	 */
+	template<unsigned int prp_r, typename vector_pos_type, typename vector_prp_type>
+	void Initialize(const Box<dim,St> & bx, St r_mx, size_t n_lvl, const vector_pos_type & v_pos, const vector_prp_type & v_prp)
+	{
+		box = bx;
+		r_max = r_mx;
+
+		n_lvl = std::max((size_t)1,std::min(n_lvl,(size_t)MULTI_RES_MAX_LEVELS));
+
+		gr.resize(n_lvl);
+		cells.resize(n_lvl);
+
+		for (size_t l = 0 ; l < n_lvl ; l++)
+		{
+			size_t div[dim];
+			for (size_t i = 0 ; i < dim ; i++)
+			{div[i] = std::max((size_t)1,(size_t)std::ceil((box.getHigh(i) - box.getLow(i)) / getCellSize(l)));}
+
+			gr.get(l).setDimensions(div);
+			cells.get(l).clear();
+		}
+
+		size_t n_part = v_pos.size();
+		lvl.resize(n_part);
+		rad.resize(n_part);
+
+		// calculate the levels
+		auto fl = [&](size_t c, int thr)
+		{
+			size_t stop = std::min(n_part,(c+1)*MULTI_RES_CHUNK);
+
+			for (size_t p = c*MULTI_RES_CHUNK ; p < stop ; p++)
+			{
+				St r = v_prp.template get<prp_r>(p);
+				rad.get(p) = r;
+
+				size_t l = (r <= 0)?n_lvl-1:(size_t)std::max(0.0,std::floor(std::log2((double)r_max / r)));
+				lvl.get(p) = std::min(l,n_lvl-1);
+			}
+		};
+
+		size_t n_chunk = (n_part + MULTI_RES_CHUNK - 1) / MULTI_RES_CHUNK;
+		parallel_work_items(n_chunk,fl);
+
+		for (size_t p = 0 ; p < n_part ; p++)
+		{
+			size_t l = lvl.get(p);
+			cells.get(l).add(std::pair<size_t,size_t>(gr.get(l).LinId(getCellKey(l,v_pos.template get<0>(p))),p));
+		}
+
+		auto fs = [&](size_t l, int thr)
+		{
+			if (cells.get(l).size() == 0)
+			{return;}
+
+			std::pair<size_t,size_t> * first = &cells.get(l).get(0);
+			std::sort(first,first + cells.get(l).size());
+		};
+
+		parallel_work_items(n_lvl,fs);
+	}
+
+	/*! \brief Get the number of levels
+	 *
+	 * \return the number of levels
+	 *
+	 */
+	size_t getNLevels() const
+	{
+		return gr.size();
+	}
+
+	/*! \brief Get the cell side of a level
+	 *
+	 * \param l level
+	 *
+	 * \return the cell side
+	 *
+	 */
+	St getCellSize(size_t l) const
+	{
+		return r_max / (St)(1ul << l);
+	}
+
+	/*! \brief Get the level of a particle
+	 *
+	 * \param p particle
+	 *
+	 * \return the level
+	 *
+	 */
+	size_t getLevel(size_t p) const
+	{
+		return lvl.get(p);
+	}
+
+	/*! \brief Get the number of particles in a level
+	 *
+	 * \param l level
+	 *
+	 * \return the number of particles
+	 *
+	 */
+	size_t getNParticles(size_t l) const
+	{
+		return cells.get(l).size();
+	}
+
+	/*! \brief Call f on the neighbors q of p with level smaller or equal than the level of p
+	 *
+	 * The neighbors are the particles with distance smaller or equal than max(r_p,r_q), only 3^dim cells for each
+	 * level are searched
+	 *
+	 * \param p particle
+	 * \param v_pos particle positions
+	 * \param f function f(q)
+	 *
+	 */
+	template<typename vector_pos_type, typename lambda_f> void forEachNeighborCoarser(size_t p, const vector_pos_type & v_pos, lambda_f & f) const
+	{
+		for (size_t l = 0 ; l <= lvl.get(p) ; l++)
+		{forEachNeighborLevel(l,p,v_pos,f);}
+	}
+
+	/*! \brief Call f on all the neighbors q of p
+	 *
+	 * The neighbors are the particles with distance smaller or equal than max(r_p,r_q). On the levels finer than
+	 * the level of p more than 3^dim cells are searched, if the full neighborhood is needed for all
+	 * the particles VerletListMultiRes is faster
+	 *
+	 * \param p particle
+	 * \param v_pos particle positions
+	 * \param f function f(q)
+	 *
+	 */
+	template<typename vector_pos_type, typename lambda_f> void forEachNeighbor(size_t p, const vector_pos_type & v_pos, lambda_f & f) const
+	{
+		for (size_t l = 0 ; l < gr.size() ; l++)
+		{forEachNeighborLevel(l,p,v_pos,f);}
+	}
+};
+
+/*! \brief Iterator across the neighborhood of a particle in VerletListMultiRes
+ *
+ */
+class VerletListMultiResIterator
+{
+	//! neighborhood list
+	const size_t * nn;
+
+	//! number of neighbors
+	size_t n;
+
+	//! actual neighbor
+	size_t i = 0;
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param nn neighborhood list
+	 * \param n number of neighbors
+	 *
+	 */
+	VerletListMultiResIterator(const size_t * nn, size_t n)
+	:nn(nn),n(n)
+	{}
+
+	//! Check if there are other neighbors
+	bool isNext() const
+	{
+		return i < n;
+	}
+
+	//! Get the neighbor
+	size_t get() const
+	{
+		return nn[i];
+	}
+
+	//! Next neighbor
+	VerletListMultiResIterator & operator++()
+	{
+		i++;
+		return *this;
+	}
+};
+
+/*! \brief Verlet-list for particles with different interaction radii
+ *
+ * For every particle p (real particles only) it store all the particles q (real and ghost) with distance smaller or
+ * equal than max(r_p,r_q). It is constructed from a CellListMultiRes, every particle search only its level
+ * and the coarser ones, when a particle p find a particle q on a coarser level p is also added to the list of q.
+ *
+ * \tparam dim dimensionality
+ * \tparam St space type
+ *
+ */
+template<unsigned int dim, typename St>
+class VerletListMultiRes
+{
+	//! multi-resolution Cell-list
+	CellListMultiRes<dim,St> cl;
+
+	//! start of the neighborhood of every particle
+	openfpm::vector<size_t> start;
+
+	//! neighborhood of all the particles
+	openfpm::vector<size_t> nn;
+
+public:
+
+	/*! \brief Construct the Verlet-list
+	 *
+	 * \tparam prp_r property containing the radius of the particles
+	 *
+	 * \param bx box where the Verlet-list is defined (it must contain all the particles)
+	 * \param r_mx biggest radius
+	 * \param n_lvl number of levels
+	 * \param v_pos particle positions
+	 * \param v_prp particle properties
+	 * \param g_m ghost marker
+	 *
+	 */
+	template<unsigned int prp_r, typename vector_pos_type, typename vector_prp_type>
+	void Initialize(const Box<dim,St> & bx, St r_mx, size_t n_lvl, const vector_pos_type & v_pos, const vector_prp_type & v_prp, size_t g_m)
+	{
+		cl.template Initialize<prp_r>(bx,r_mx,n_lvl,v_pos,v_prp);
+
+		size_t n_part = v_pos.size();
+		size_t n_chunk = (n_part + MULTI_RES_CHUNK - 1) / MULTI_RES_CHUNK;
+
+		// pairs (p,q) found by every chunk
+		openfpm::vector<openfpm::vector<std::pair<size_t,size_t>>> pairs;
+		pairs.resize(n_chunk);
+
+		auto fp = [&](size_t c, int thr)
+		{
+			size_t stop = std::min(n_part,(c+1)*MULTI_RES_CHUNK);
+
+			for (size_t p = c*MULTI_RES_CHUNK ; p < stop ; p++)
+			{
+				auto fn = [&](size_t q)
+				{
+					if (p < g_m)
+					{pairs.get(c).add(std::pair<size_t,size_t>(p,q));}
+
+					// q is coarser, q does not search p
+					if (q < g_m && cl.getLevel(q) < cl.getLevel(p))
+					{pairs.get(c).add(std::pair<size_t,size_t>(q,p));}
+				};
+
+				cl.forEachNeighborCoarser(p,v_pos,fn);
+			}
+		};
+
+		parallel_work_items(n_chunk,fp);
+
+		// compact into a CSR structure
+		start.resize(g_m+1);
+		for (size_t p = 0 ; p <= g_m ; p++)
+		{start.get(p) = 0;}
+
+		for (size_t c = 0 ; c < pairs.size() ; c++)
+		{
+			for (size_t i = 0 ; i < pairs.get(c).size() ; i++)
+			{start.get(pairs.get(c).get(i).first + 1)++;}
+		}
+
+		for (size_t p = 0 ; p < g_m ; p++)
+		{start.get(p+1) += start.get(p);}
+
+		openfpm::vector<size_t> cnt;
+		cnt.resize(g_m);
+		for (size_t p = 0 ; p < g_m ; p++)
+		{cnt.get(p) = start.get(p);}
+
+		nn.resize(start.get(g_m));
+
+		for (size_t c = 0 ; c < pairs.size() ; c++)
+		{
+			for (size_t i = 0 ; i < pairs.get(c).size() ; i++)
+			{
+				size_t p = pairs.get(c).get(i).first;
+				nn.get(cnt.get(p)) = pairs.get(c).get(i).second;
+				cnt.get(p)++;
+			}
+
+			pairs.get(c).clear();
+		}
+
+		// deterministic order of the neighborhood
+		auto fo = [&](size_t c, int thr)
+		{
+			size_t stop = std::min(g_m,(c+1)*MULTI_RES_CHUNK);
+
+			for (size_t p = c*MULTI_RES_CHUNK ; p < stop ; p++)
+			{
+				if (start.get(p+1) != start.get(p))
+				{std::sort(&nn.get(start.get(p)),&nn.get(start.get(p)) + start.get(p+1) - start.get(p));}
+			}
+		};
+
+		parallel_work_items((g_m + MULTI_RES_CHUNK - 1) / MULTI_RES_CHUNK,fo);
+	}
+
+	/*! \brief Get the number of neighbors of a particle
+	 *
+	 * \param p particle
+	 *
+	 * \return the number of neighbors
+	 *
+	 */
+	size_t getNNPart(size_t p) const
+	{
+		return start.get(p+1) - start.get(p);
+	}
+
+	/*! \brief Get a neighbor of a particle
+	 *
+	 * \param p particle
+	 * \param j neighbor
+	 *
+	 * \return the neighbor
+	 *
+	 */
+	size_t get(size_t p, size_t j) const
+	{
+		return nn.get(start.get(p) + j);
+	}
+
+	/*! \brief Get an iterator across the neighborhood of a particle
+	 *
+	 * \param p particle
+	 *
+	 * \return the iterator
+	 *
+	 */
+	VerletListMultiResIterator getNNIterator(size_t p) const
+	{
+		if (getNNPart(p) == 0)
+		{return VerletListMultiResIterator(NULL,0);}
+
+		return VerletListMultiResIterator(&nn.get(start.get(p)),getNNPart(p));
+	}
+
+	/*! \brief Get an iterator across the neighborhood of a particle
+	 *
+	 * It is the same as getNNIterator(p), it has the same signature of the VerletList one
+	 *
+	 * \tparam impl implementation (ignored)
+	 *
+	 * \param p particle
+	 *
+	 * \return the iterator
+	 *
+	 */
+	template<unsigned int impl> VerletListMultiResIterator getNNIterator(size_t p) const
+	{
+		return getNNIterator(p);
+	}
+
+	/*! \brief Get the total number of interaction pairs stored
+	 *
+	 * \return the number of pairs
+	 *
+	 */
+	size_t size() const
+	{
+		return nn.size();
+	}
+
+	/*! \brief Get the internal multi-resolution Cell-list
+	 *
+	 * \return the Cell-list
+	 *
+	 */
+	const CellListMultiRes<dim,St> & getInternalCellList() const
+	{
+		return cl;
+	}
+};
+
+#endif /* VECTOR_DIST_MULTI_RES_HPP_ */
@@ -0,0 +1,355 @@
+/*
+ * vector_dist_nn_threads.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef VECTOR_DIST_NN_THREADS_HPP_
+#define VECTOR_DIST_NN_THREADS_HPP_
+
+#include "config.h"
+#include <algorithm>
+#include "NN/CellList/CellList.hpp"
+#include "util/for_each_parallel.hpp"
+
+/*! \brief Check if a Cell-list can be filled cell by cell with addCell (CPU Cell-list)
+ *
+ * has_addCell<CellL>::value is true if CellL has a member addCell(cell,ele)
+ *
+ */
+template<typename CellL, typename Sfinae = void>
+struct has_addCell: std::false_type
+{};
+
+/*! \brief Check if a Cell-list can be filled cell by cell with addCell (CPU Cell-list)
+ *
+ * has_addCell<CellL>::value is true if CellL has a member addCell(cell,ele)
+ *
+ */
+template<typename CellL>
+struct has_addCell<CellL, typename Void<decltype(std::declval<CellL &>().addCell(0,0))>::type>: std::true_type
+{};
+
+/*! \brief Check if particles can be added concurrently to different cells of a Cell-list
+ *
+ * It is true for the Cell-lists with Mem_fast and Mem_bal storage, where every cell has its own
+ * storage, as long as Mem_fast does not need to reallocate its slots
+ *
+ */
+template<typename CellL>
+struct cell_list_concurrent_add: std::false_type
+{};
+
+/*! \brief Check if particles can be added concurrently to different cells of a Cell-list
+ *
+ * Cell-list with Mem_fast storage
+ *
+ */
+template<unsigned int dim, typename T, typename ... mem_arg, typename transform, typename ... cl_arg>
+struct cell_list_concurrent_add<CellList<dim,T,Mem_fast<mem_arg...>,transform,cl_arg...>>: std::true_type
+{};
+
+/*! \brief Check if particles can be added concurrently to different cells of a Cell-list
+ *
+ * Cell-list with Mem_bal storage
+ *
+ */
+template<unsigned int dim, typename T, typename ... mem_arg, typename transform, typename ... cl_arg>
+struct cell_list_concurrent_add<CellList<dim,T,Mem_bal<mem_arg...>,transform,cl_arg...>>: std::true_type
+{};
+
+/*! \brief Return the number of threads to use for the construction of the neighborhood structures
+ *
+ * \param n_thr requested number of threads (0 = all the threads available)
+ *
+ * \return the number of threads
+ *
+ */
+inline unsigned int nn_threads_number(unsigned int n_thr)
+{
+	return pdata_threads_number(n_thr);
+}
+
+/*! \brief Fill a CPU Cell-list using several threads
+ *
+ * The construction is done in three passes
+ *
+ * * Every thread calculate the cell of a contiguous chunk of particles and count the particles for each cell
+ * * A prefix sum over (cell,thread) calculate where every thread has to write its particles
+ * * Every thread scatter its particles into a cell-ordered array
+ *
+ * The cell-ordered array is finally appended into the Cell-list. The largest cell is filled first, so
+ * that the storage of every cell is big enough, after that every thread fill a contiguous range of cells
+ * with about the same number of particles (when the Cell-list support concurrent insertion in different
+ * cells). The order of the particles inside every cell is the same produced by the sequential construction
+ *
+ * \tparam dim dimensionality
+ * \tparam St space type
+ *
+ * \param v_pos particle positions (domain + ghost)
+ * \param cell_list Cell-list to fill
+ * \param n_thr number of threads
+ *
+ */
+template<unsigned int dim, typename St, typename CellL, typename vector_pos_type>
+void populate_cell_list_threads(const vector_pos_type & v_pos, CellL & cell_list, unsigned int n_thr)
+{
+	size_t n_part = v_pos.size();
+	size_t n_cell = cell_list.getGrid().size();
+
+	openfpm::vector<size_t> cell_id;
+	openfpm::vector<size_t> cnt;
+	openfpm::vector<size_t> c_start;
+	openfpm::vector<size_t> sorted;
+
+	cell_id.resize(n_part);
+	cnt.resize(n_thr*n_cell);
+	c_start.resize(n_cell+1);
+	sorted.resize(n_part);
+
+	// count pass
+#ifdef HAVE_OPENMP
+	#pragma omp parallel for num_threads(n_thr) schedule(static,1)
+#endif
+	for (int t = 0 ; t < (int)n_thr ; t++)
+	{
+		size_t start = n_part * t / n_thr;
+		size_t stop = n_part * (t+1) / n_thr;
+
+		size_t * cnt_t = &cnt.get(t*n_cell);
+
+		for (size_t c = 0 ; c < n_cell ; c++)
+		{cnt_t[c] = 0;}
+
+		for (size_t i = start ; i < stop ; i++)
+		{
+			Point<dim,St> xp = v_pos.get(i);
+
+			size_t c = cell_list.getCell(xp);
+			cell_id.get(i) = c;
+			cnt_t[c]++;
+		}
+	}
+
+	// prefix sum, cnt become the writing offset of each thread for each cell
+	size_t tot = 0;
+	for (size_t c = 0 ; c < n_cell ; c++)
+	{
+		c_start.get(c) = tot;
+
+		for (size_t t = 0 ; t < n_thr ; t++)
+		{
+			size_t n = cnt.get(t*n_cell + c);
+			cnt.get(t*n_cell + c) = tot;
+			tot += n;
+		}
+	}
+	c_start.get(n_cell) = tot;
+
+	// scatter pass
+#ifdef HAVE_OPENMP
+	#pragma omp parallel for num_threads(n_thr) schedule(static,1)
+#endif
+	for (int t = 0 ; t < (int)n_thr ; t++)
+	{
+		size_t start = n_part * t / n_thr;
+		size_t stop = n_part * (t+1) / n_thr;
+
+		size_t * off_t = &cnt.get(t*n_cell);
+
+		for (size_t i = start ; i < stop ; i++)
+		{
+			size_t c = cell_id.get(i);
+			sorted.get(off_t[c]) = i;
+			off_t[c]++;
+		}
+	}
+
+	// append the particles cell by cell
+	cell_list.clear();
+
+	if (cell_list_concurrent_add<CellL>::value == false || n_thr == 1)
+	{
+		for (size_t c = 0 ; c < n_cell ; c++)
+		{
+			for (size_t k = c_start.get(c) ; k < c_start.get(c+1) ; k++)
+			{cell_list.addCell(c,sorted.get(k));}
+		}
+
+		return;
+	}
+
+	// the largest cell is filled first, after it no cell need to grow the storage
+	size_t c_max = 0;
+	for (size_t c = 0 ; c < n_cell ; c++)
+	{
+		if (c_start.get(c+1) - c_start.get(c) > c_start.get(c_max+1) - c_start.get(c_max))
+		{c_max = c;}
+	}
+
+	for (size_t k = c_start.get(c_max) ; k < c_start.get(c_max+1) ; k++)
+	{cell_list.addCell(c_max,sorted.get(k));}
+
+#ifdef HAVE_OPENMP
+	#pragma omp parallel for num_threads(n_thr) schedule(static,1)
+#endif
+	for (int t = 0 ; t < (int)n_thr ; t++)
+	{
+		// range of cells with about tot / n_thr particles
+		size_t c0 = std::lower_bound(c_start.begin(),c_start.begin() + n_cell,tot * t / n_thr) - c_start.begin();
+		size_t c1 = std::lower_bound(c_start.begin(),c_start.begin() + n_cell,tot * (t+1) / n_thr) - c_start.begin();
+
+		if (t == (int)n_thr - 1)
+		{c1 = n_cell;}
+
+		for (size_t c = c0 ; c < c1 ; c++)
+		{
+			if (c == c_max)
+			{continue;}
+
+			for (size_t k = c_start.get(c) ; k < c_start.get(c+1) ; k++)
+			{cell_list.addCell(c,sorted.get(k));}
+		}
+	}
+}
+
+/*! \brief Fill a non-symmetric Verlet-list using several threads
+ *
+ * Every thread search the neighborhood of a contiguous chunk of particles using the
+ * Cell-list cli and store the neighborhood in its own segment. The segments are
+ * concatenated in particle order at the end.
+ *
+ * \tparam dim dimensionality
+ * \tparam St space type
+ *
+ * \param ver Verlet-list to fill
+ * \param cli Cell-list (already filled) used to search the neighborhood
+ * \param v_pos particle positions (domain + ghost)
+ * \param g_m ghost marker (number of domain particles)
+ * \param r_cut cut-off radius
+ * \param n_thr number of threads
+ *
+ */
+template<unsigned int dim, typename St, typename VerletL, typename CellL, typename vector_pos_type>
+void fill_verlet_threads(VerletL & ver, CellL & cli, const vector_pos_type & v_pos, size_t g_m, St r_cut, unsigned int n_thr)
+{
+	St r_cut2 = r_cut*r_cut;
+
+	openfpm::vector<openfpm::vector<size_t>> seg;
+	openfpm::vector<size_t> n_nn;
+	openfpm::vector<size_t> max_nn;
+
+	seg.resize(n_thr);
+	max_nn.resize(n_thr);
+	n_nn.resize(g_m);
+
+#ifdef HAVE_OPENMP
+	#pragma omp parallel for num_threads(n_thr) schedule(static,1)
+#endif
+	for (int t = 0 ; t < (int)n_thr ; t++)
+	{
+		size_t start = g_m * t / n_thr;
+		size_t stop = g_m * (t+1) / n_thr;
+
+		auto & sg = seg.get(t);
+		sg.clear();
+		max_nn.get(t) = 0;
+
+		for (size_t i = start ; i < stop ; i++)
+		{
+			Point<dim,St> xp = v_pos.get(i);
+
+			size_t n = 0;
+			auto NN = cli.template getNNIterator<NO_CHECK>(cli.getCell(xp));
+
+			while (NN.isNext())
+			{
+				size_t q = NN.get();
+
+				Point<dim,St> xq = v_pos.get(q);
+
+				if (xp.distance2(xq) < r_cut2)
+				{
+					sg.add(q);
+					n++;
+				}
+
+				++NN;
+			}
+
+			n_nn.get(i) = n;
+			max_nn.get(t) = (n > max_nn.get(t))?n:max_nn.get(t);
+		}
+	}
+
+	size_t slot = 1;
+	for (size_t t = 0 ; t < n_thr ; t++)
+	{slot = (max_nn.get(t) > slot)?max_nn.get(t):slot;}
+
+	// concatenate the segments
+	ver.init_to_zero(slot,g_m);
+
+	for (size_t t = 0 ; t < n_thr ; t++)
+	{
+		size_t start = g_m * t / n_thr;
+		size_t stop = g_m * (t+1) / n_thr;
+
+		auto & sg = seg.get(t);
+
+		size_t k = 0;
+		for (size_t i = start ; i < stop ; i++)
+		{
+			for (size_t j = 0 ; j < n_nn.get(i) ; j++, k++)
+			{ver.addPart(i,sg.get(k));}
+		}
+	}
+}
+
+/*! \brief Fill a Cell-list with several threads when the Cell-list support it
+ *
+ * \tparam is_cpu_cl true when the Cell-list is a CPU Cell-list with addCell
+ *
+ */
+template<bool is_cpu_cl>
+struct populate_cell_list_threads_impl
+{
+	/*! \brief The Cell-list does not support the threaded construction
+	 *
+	 * \return false, the Cell-list has not been filled
+	 *
+	 */
+	template<unsigned int dim, typename St, typename CellL, typename vector_pos_type>
+	static bool populate(const vector_pos_type & v_pos, CellL & cell_list, unsigned int n_thr)
+	{
+		return false;
+	}
+};
+
+/*! \brief Fill a Cell-list with several threads when the Cell-list support it
+ *
+ * \tparam is_cpu_cl true when the Cell-list is a CPU Cell-list with addCell
+ *
+ */
+template<>
+struct populate_cell_list_threads_impl<true>
+{
+	/*! \brief Fill the Cell-list
+	 *
+	 * \param v_pos particle positions
+	 * \param cell_list Cell-list to fill
+	 * \param n_thr number of threads
+	 *
+	 * \return true, the Cell-list has been filled
+	 *
+	 */
+	template<unsigned int dim, typename St, typename CellL, typename vector_pos_type>
+	static bool populate(const vector_pos_type & v_pos, CellL & cell_list, unsigned int n_thr)
+	{
+		populate_cell_list_threads<dim,St>(v_pos,cell_list,n_thr);
+
+		return true;
+	}
+};
+
+#endif /* VECTOR_DIST_NN_THREADS_HPP_ */
@@ -0,0 +1,297 @@
+/*
+ * vector_dist_pair_kernel.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef VECTOR_DIST_PAIR_KERNEL_HPP_
+#define VECTOR_DIST_PAIR_KERNEL_HPP_
+
+#include <limits>
+#include <type_traits>
+#include "util/for_each_parallel.hpp"
+
+//! Number of neighbors in a pair tile, it is a multiple of every SIMD width
+#define PAIR_TILE 64
+
+/*! \brief Number of components of a property used in a pair kernel
+ *
+ * A scalar has one component, an array St[N] has N components
+ *
+ */
+template<typename T, bool is_array = std::is_array<T>::value>
+struct pair_kernel_prp
+{
+	//! number of components
+	static const unsigned int n = 1;
+
+	//! get a component
+	template<typename ref_type> static inline auto get(ref_type && v, unsigned int c) -> decltype(v)
+	{
+		return v;
+	}
+};
+
+/*! \brief Number of components of a property used in a pair kernel
+ *
+ * A scalar has one component, an array St[N] has N components
+ *
+ */
+template<typename T>
+struct pair_kernel_prp<T,true>
+{
+	//! number of components
+	static const unsigned int n = std::extent<T>::value;
+
+	//! get a component
+	template<typename ref_type> static inline auto get(ref_type && v, unsigned int c) -> decltype(v[c])
+	{
+		return v[c];
+	}
+};
+
+/*! \brief Tile of pairs (p,q) passed to the lambda of vector_dist::pair_kernel
+ *
+ * All the pairs of a tile share the same particle p. The data of the neighbors are in structure of
+ * arrays aligned to a cache line so that a loop over the lanes of the tile vectorize
+ *
+ * \code
+ *
+ * vd.pair_kernel<force,charge>(ver,[&](auto & t)
+ * {
+ *   for (size_t j = 0 ; j < PAIR_TILE ; j++)
+ *   {
+ *     float w = (t.r2[j] < r_cut2)?t.prp_q[0][j] / (t.r2[j]*t.r2[j]):0.0;
+ *
+ *     for (size_t i = 0 ; i < 3 ; i++)
+ *     {t.res[i][j] = w * t.dx[i][j];}
+ *   }
+ * });
+ *
+ * \endcode
+ *
+ * \tparam dim dimensionality
+ * \tparam St space type
+ * \tparam n_in number of input properties
+ * \tparam n_out number of components of the output property
+ *
+ */
+template<unsigned int dim, typename St, unsigned int n_in, unsigned int n_out>
+struct pair_tile
+{
+	//! x_p - x_q for every lane
+	alignas(64) St dx[dim][PAIR_TILE];
+
+	//! squared distance for every lane (max of St for the unused lanes)
+	alignas(64) St r2[PAIR_TILE];
+
+	//! input properties of the neighbors
+	alignas(64) St prp_q[(n_in == 0)?1:n_in][PAIR_TILE];
+
+	//! result of every lane (set to zero before calling the lambda)
+	alignas(64) St res[n_out][PAIR_TILE];
+
+	//! input properties of p
+	St prp_p[(n_in == 0)?1:n_in];
+
+	//! position of p
+	St xp[dim];
+
+	//! particle p
+	size_t p;
+
+	//! neighbor of every lane (the source particle for virtual periodic images)
+	size_t q[PAIR_TILE];
+
+	//! number of used lanes
+	size_t n;
+};
+
+/*! \brief Gather the input properties of a particle in a tile
+ *
+ */
+template<typename vector_prp_type, unsigned int ... prp_in>
+struct pair_kernel_gather
+{
+	//! gather the properties of particle k into dst[prp][lane]
+	template<typename dst_type>
+	static inline void gather(const vector_prp_type & v_prp, size_t k, dst_type & dst, size_t lane)
+	{
+		size_t i = 0;
+		int dummy[] = {0, (dst[i++][lane] = v_prp.template get<prp_in>(k), 0) ...};
+		(void)dummy;
+	}
+
+	//! gather the properties of particle k into dst[prp]
+	template<typename dst_type>
+	static inline void gather_p(const vector_prp_type & v_prp, size_t k, dst_type & dst)
+	{
+		size_t i = 0;
+		int dummy[] = {0, (dst[i++] = v_prp.template get<prp_in>(k), 0) ...};
+		(void)dummy;
+	}
+};
+
+/*! \brief Resolve the virtual periodic images in a pair kernel
+ *
+ * The particles with id bigger or equal than n_part are virtual images, the data are in the source particle and
+ * the position is the position of the source minus the shift
+ *
+ */
+template<typename vector_img_type, typename vector_shift_type>
+struct pair_kernel_images
+{
+	//! virtual images (source, shift id)
+	vector_img_type img;
+
+	//! shift vectors
+	vector_shift_type shifts;
+
+	//! number of particles (real + ghost)
+	size_t n_part;
+
+	/*! \brief Constructor
+	 *
+	 * \param img virtual images
+	 * \param shifts shift vectors
+	 * \param n_part number of particles (real + ghost)
+	 *
+	 */
+	pair_kernel_images(vector_img_type img, vector_shift_type shifts, size_t n_part)
+	:img(img),shifts(shifts),n_part(n_part)
+	{}
+
+	/*! \brief Get the particle that store the data of q and the position of q
+	 *
+	 * \param q particle or virtual image
+	 * \param v_pos particle positions
+	 * \param x position of q
+	 *
+	 * \return the particle that store the data of q
+	 *
+	 */
+	template<typename vector_pos_type, typename St, unsigned int dim>
+	inline size_t resolve(size_t q, const vector_pos_type & v_pos, St (& x)[dim]) const
+	{
+		if (q < n_part)
+		{
+			for (size_t i = 0 ; i < dim ; i++)
+			{x[i] = v_pos.template get<0>(q)[i];}
+
+			return q;
+		}
+
+		size_t src = img.template get<0>(q - n_part);
+		size_t sh = img.template get<1>(q - n_part);
+
+		for (size_t i = 0 ; i < dim ; i++)
+		{x[i] = v_pos.template get<0>(src)[i] - shifts.template get<0>(sh)[i];}
+
+		return src;
+	}
+};
+
+/*! \brief Process the neighborhood of one particle with a pair kernel
+ *
+ * The neighbors are gathered into tiles of PAIR_TILE pairs, every tile is passed to f and the results
+ * are accumulated on p and, if sym_sign != 0, sym_sign times the results are accumulated on the neighbor
+ *
+ * \param p particle
+ * \param ver Verlet-list
+ * \param v_pos particle positions
+ * \param v_prp particle properties
+ * \param img resolver of the virtual periodic images
+ * \param t tile
+ * \param f pair kernel
+ * \param sym_sign 0 for non symmetric lists, 1 or -1 for symmetric lists
+ *
+ */
+template<unsigned int dim, typename St, unsigned int prp_out, unsigned int ... prp_in, typename VerletL,
+		 typename vector_pos_type, typename vector_prp_type, typename img_type, typename tile_type, typename lambda_t>
+void pair_kernel_particle(size_t p, VerletL & ver, vector_pos_type & v_pos, vector_prp_type & v_prp, const img_type & img, tile_type & t, lambda_t & f, int sym_sign)
+{
+	typedef typename std::remove_reference<decltype(v_prp.template get<prp_out>(0))>::type out_type;
+	typedef pair_kernel_prp<out_type> out;
+
+	t.p = p;
+	size_t sp = img.resolve(p,v_pos,t.xp);
+
+	pair_kernel_gather<vector_prp_type,prp_in...>::gather_p(v_prp,sp,t.prp_p);
+
+	St acc[out::n];
+	for (size_t c = 0 ; c < out::n ; c++)
+	{acc[c] = 0;}
+
+	auto NN = ver.template getNNIterator<NO_CHECK>(p);
+
+	bool next = NN.isNext();
+
+	while (next == true)
+	{
+		// gather
+		t.n = 0;
+		while (NN.isNext() && t.n < PAIR_TILE)
+		{
+			St xq[dim];
+			size_t q = img.resolve(NN.get(),v_pos,xq);
+
+			t.q[t.n] = q;
+
+			St r2 = 0;
+			for (size_t i = 0 ; i < dim ; i++)
+			{
+				t.dx[i][t.n] = t.xp[i] - xq[i];
+				r2 += t.dx[i][t.n]*t.dx[i][t.n];
+			}
+			t.r2[t.n] = r2;
+
+			pair_kernel_gather<vector_prp_type,prp_in...>::gather(v_prp,q,t.prp_q,t.n);
+
+			t.n++;
+			++NN;
+		}
+
+		next = NN.isNext();
+
+		// padding
+		for (size_t j = t.n ; j < PAIR_TILE ; j++)
+		{
+			for (size_t i = 0 ; i < dim ; i++)
+			{t.dx[i][j] = 0;}
+			t.r2[j] = std::numeric_limits<St>::max();
+
+			for (size_t k = 0 ; k < sizeof...(prp_in) ; k++)
+			{t.prp_q[k][j] = 0;}
+		}
+
+		for (size_t c = 0 ; c < out::n ; c++)
+		{
+			for (size_t j = 0 ; j < PAIR_TILE ; j++)
+			{t.res[c][j] = 0;}
+		}
+
+		f(t);
+
+		// scatter
+		for (size_t c = 0 ; c < out::n ; c++)
+		{
+			for (size_t j = 0 ; j < t.n ; j++)
+			{acc[c] += t.res[c][j];}
+		}
+
+		if (sym_sign != 0)
+		{
+			for (size_t j = 0 ; j < t.n ; j++)
+			{
+				for (size_t c = 0 ; c < out::n ; c++)
+				{out::get(v_prp.template get<prp_out>(t.q[j]),c) += sym_sign * t.res[c][j];}
+			}
+		}
+	}
+
+	for (size_t c = 0 ; c < out::n ; c++)
+	{out::get(v_prp.template get<prp_out>(sp),c) += acc[c];}
+}
+
+#endif /* VECTOR_DIST_PAIR_KERNEL_HPP_ */
@@ -0,0 +1,203 @@
+/*
+ * vector_dist_virtual_images.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: i-bird
+ */
+
+#ifndef VECTOR_DIST_VIRTUAL_IMAGES_HPP_
+#define VECTOR_DIST_VIRTUAL_IMAGES_HPP_
+
+#include "NN/CellList/CellList.hpp"
+
+/*! \brief Positions of the particles followed by the virtual periodic images
+ *
+ * The virtual periodic images (GHOST_VIRTUAL_PERIODIC) have id bigger or equal than the number of
+ * particles (real + ghost), their position is the position of the source particle minus the shift
+ * and it is calculated on the fly. It can be used in place of the position vector to iterate the
+ * neighborhood of a Cell-list that contain the virtual images
+ *
+ */
+template<unsigned int dim, typename St, typename vector_pos_type, typename vector_img_type, typename vector_shift_type>
+class vector_pos_virtual
+{
+	//! particle positions (real + ghost)
+	const vector_pos_type & v_pos;
+
+	//! virtual images (source, shift id)
+	const vector_img_type & img;
+
+	//! shift vectors
+	const vector_shift_type & shifts;
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param v_pos particle positions (real + ghost)
+	 * \param img virtual images
+	 * \param shifts shift vectors
+	 *
+	 */
+	vector_pos_virtual(const vector_pos_type & v_pos, const vector_img_type & img, const vector_shift_type & shifts)
+	:v_pos(v_pos),img(img),shifts(shifts)
+	{}
+
+	/*! \brief Get the position of a particle or of a virtual image
+	 *
+	 * \param q particle or virtual image
+	 *
+	 * \return the position
+	 *
+	 */
+	inline Point<dim,St> get(size_t q) const
+	{
+		if (q < v_pos.size())
+		{return v_pos.get(q);}
+
+		size_t i = q - v_pos.size();
+
+		Point<dim,St> p = v_pos.get(img.template get<0>(i));
+		p -= shifts.get(img.template get<1>(i));
+
+		return p;
+	}
+
+	/*! \brief Get the position of a particle or of a virtual image (like the position vector)
+	 *
+	 * \tparam prp must be 0
+	 *
+	 * \param q particle or virtual image
+	 *
+	 * \return the position
+	 *
+	 */
+	template<unsigned int prp> inline Point<dim,St> get(size_t q) const
+	{
+		return get(q);
+	}
+
+	/*! \brief Number of particles plus the number of virtual images
+	 *
+	 * \return the size
+	 *
+	 */
+	inline size_t size() const
+	{
+		return v_pos.size() + img.size();
+	}
+};
+
+/*! \brief Add the virtual periodic images to a Cell-list
+ *
+ * \tparam is_cpu_cl true when the Cell-list is a CPU Cell-list with addCell
+ *
+ */
+template<bool is_cpu_cl>
+struct add_virtual_images_impl
+{
+	/*! \brief The Cell-list does not support the insertion of single elements
+	 *
+	 * \return false, the images has not been added
+	 *
+	 */
+	template<typename CellL, typename vector_pos_virtual_type>
+	static bool add(CellL & cell_list, const vector_pos_virtual_type & vp, size_t n_part)
+	{
+		return false;
+	}
+};
+
+/*! \brief Add the virtual periodic images to a Cell-list
+ *
+ * \tparam is_cpu_cl true when the Cell-list is a CPU Cell-list with addCell
+ *
+ */
+template<>
+struct add_virtual_images_impl<true>
+{
+	/*! \brief Add the images, the Cell-list must be already filled with the particles
+	 *
+	 * \param cell_list Cell-list
+	 * \param vp positions of the particles and of the virtual images
+	 * \param n_part number of particles (real + ghost), the id of the first image
+	 *
+	 * \return true, the images has been added
+	 *
+	 */
+	template<typename CellL, typename vector_pos_virtual_type>
+	static bool add(CellL & cell_list, const vector_pos_virtual_type & vp, size_t n_part)
+	{
+		for (size_t q = n_part ; q < vp.size() ; q++)
+		{
+			auto xq = vp.get(q);
+			cell_list.addCell(cell_list.getCell(xq),q);
+		}
+
+		return true;
+	}
+};
+
+/*! \brief Fill a symmetric Verlet-list from its internal Cell-list
+ *
+ * The internal Cell-list must be already filled with the particles and the virtual images.
+ * For every real particle p the neighborhood is the one of the symmetric iterator of the
+ * Cell-list (every pair is stored only once) within the cut-off radius, p excluded
+ *
+ * \tparam dim dimensionality
+ * \tparam St space type
+ *
+ * \param ver Verlet-list to fill
+ * \param cli internal Cell-list of ver
+ * \param vp positions of the particles and of the virtual images
+ * \param g_m ghost marker (number of domain particles)
+ * \param r_cut cut-off radius
+ *
+ */
+template<unsigned int dim, typename St, typename VerletL, typename CellL, typename vector_pos_virtual_type>
+void fill_verlet_sym_virtual(VerletL & ver, CellL & cli, const vector_pos_virtual_type & vp, size_t g_m, St r_cut)
+{
+	St r_cut2 = r_cut*r_cut;
+
+	openfpm::vector<size_t> nn;
+	openfpm::vector<size_t> n_nn;
+
+	n_nn.resize(g_m);
+
+	size_t slot = 1;
+
+	for (size_t p = 0 ; p < g_m ; p++)
+	{
+		Point<dim,St> xp = vp.get(p);
+
+		size_t n = 0;
+		auto NN = cli.template getNNIteratorSym<NO_CHECK>(cli.getCell(xp),p,vp);
+
+		while (NN.isNext())
+		{
+			size_t q = NN.get();
+
+			if (q != p && xp.distance2(vp.get(q)) < r_cut2)
+			{
+				nn.add(q);
+				n++;
+			}
+
+			++NN;
+		}
+
+		n_nn.get(p) = n;
+		slot = (n > slot)?n:slot;
+	}
+
+	ver.init_to_zero(slot,g_m);
+
+	size_t k = 0;
+	for (size_t p = 0 ; p < g_m ; p++)
+	{
+		for (size_t j = 0 ; j < n_nn.get(p) ; j++, k++)
+		{ver.addPart(p,nn.get(k));}
+	}
+}
+
+#endif /* VECTOR_DIST_VIRTUAL_IMAGES_HPP_ */
@@ -41,11 +41,20 @@
 #include "lib/pdata.hpp"
 #include "cuda/vector_dist_operators_list_ker.hpp"
 #include "util/PathsAndFiles.hpp"
+#include "Vector/util/vector_dist_nn_threads.hpp"
+#include "Vector/util/vector_dist_virtual_images.hpp"
+#include "Vector/util/vector_dist_multi_res.hpp"
+#include "Vector/util/vector_dist_pair_kernel.hpp"
+#include "util/for_each_parallel.hpp"
 
 #include <type_traits>
+#include <limits>
 
 #define DEC_GRAN(gr) ((size_t)gr << 32)
 
+//! number of particles moved by one work item in remove_unordered
+#define REMOVE_UNORDERED_CHUNK 1024
+
 #ifdef CUDA_GPU
 template<unsigned int dim,typename St> using CELLLIST_GPU_SPARSE = CellList_gpu<dim,St,CudaMemory,shift_only<dim, St>,unsigned int,int,true>;
 #endif
@@ -341,6 +350,12 @@ private:
 	//! Name of the properties
 	openfpm::vector<std::string> prp_names;
 
+	//! Number of processors that aggregate and write the output (0 = each processor write its own file)
+	size_t n_out_agg = 0;
+
+	//! Number of threads used to construct Cell-lists and Verlet-lists (0 = all the available threads)
+	unsigned int nn_thr = 1;
+
 #ifdef SE_CLASS3
 
 	se_class3_vector<prop::max_prop,dim,St,Decomposition,self> se3;
@@ -414,6 +429,101 @@ private:
 		}
 	}
 
+	/*! \brief Fail if the last ghost_get created virtual periodic images
+	 *
+	 * The neighborhood structures that does not add the virtual periodic images would miss silently
+	 * the neighbors across the periodic boundaries
+	 *
+	 * \param fn function that does not support the virtual periodic images
+	 *
+	 */
+	void check_no_virtual_images(const char * fn) const
+	{
+		if (this->isVirtualPeriodic() == true)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error " << fn << " does not support the virtual periodic images, use getCellList, getCellListSym, getVerlet, getVerletSym or ghost_get without GHOST_VIRTUAL_PERIODIC" << std::endl;
+			ACTION_ON_ERROR(VECTOR_DIST_ERROR_OBJECT);
+		}
+	}
+
+	/*! \brief Add the virtual periodic images of the last ghost_get to a Cell-list already filled with the particles
+	 *
+	 * The images are inserted with id v_pos.size() + i and position calculated on the fly from the source,
+	 * nothing is added to v_pos. It fail if the Cell-list does not support the insertion (GPU Cell-list)
+	 *
+	 * \param cell_list Cell-list
+	 * \param fn function that is adding the images
+	 *
+	 */
+	template<typename CellL>
+	void add_virtual_images(CellL & cell_list, const char * fn)
+	{
+		if (this->isVirtualPeriodic() == false)
+		{return;}
+
+		typedef add_virtual_images_impl<has_addCell<CellL>::value && is_gpu_celllist<CellL>::value == false> avi;
+
+		if (avi::add(cell_list,getPosVirtualVector(),v_pos.size()) == false)
+		{check_no_virtual_images(fn);}
+	}
+
+	/*! \brief Fill a symmetric Verlet-list with the virtual periodic images
+	 *
+	 * The internal Cell-list of ver must be already filled with the particles
+	 *
+	 * \param ver symmetric Verlet-list
+	 * \param r_cut cut-off radius
+	 *
+	 */
+	template<typename VerletL>
+	void fill_verlet_sym_images(VerletL & ver, St r_cut)
+	{
+		auto & NN = ver.getInternalCellList();
+		NN.set_gm(g_m);
+		add_virtual_images(NN,"getVerletSym/updateVerlet");
+
+		fill_verlet_sym_virtual<dim,St>(ver,NN,getPosVirtualVector(),g_m,r_cut);
+	}
+
+	/*! \brief Calculate the parameters of the multi-resolution neighborhood structures
+	 *
+	 * \tparam prp_r property containing the radius of the particles
+	 *
+	 * \param bt box where the structure is defined
+	 * \param r_max biggest radius (real and ghost particles)
+	 * \param n_lvl number of levels, if 0 it is calculated from the ratio between the biggest and the smallest radius
+	 *
+	 */
+	template<unsigned int prp_r> void multi_res_parameters(Box<dim,St> & bt, St & r_max, size_t & n_lvl)
+	{
+		bt = getDecomposition().getProcessorBounds();
+
+		Ghost<dim,St> g = getDecomposition().getGhost();
+		g.magnify(1.013);
+		bt.enlarge(g);
+
+		r_max = 0;
+		St r_min = std::numeric_limits<St>::max();
+
+		for (size_t i = 0 ; i < v_pos.size() ; i++)
+		{
+			St r = v_prp.template get<prp_r>(i);
+
+			r_max = std::max(r_max,r);
+
+			if (r > 0)
+			{r_min = std::min(r_min,r);}
+		}
+
+		if (r_max == 0)
+		{r_max = getDecomposition().getGhost().getHigh(0);}
+
+		check_ghost_compatible_rcut(r_max);
+
+		if (n_lvl == 0)
+		{n_lvl = (r_min >= r_max)?1:(size_t)std::floor(std::log2(r_max / r_min)) + 1;}
+	}
+
 	/*! \brief Reorder based on hilbert space filling curve
 	 *
 	 * \param v_pos_dest reordered vector of position
@@ -1228,6 +1338,9 @@ public:
 	}
 
 	/*! \brief Construct a cell list symmetric based on a cut of radius
+	 *
+	 * If the last ghost_get used GHOST_VIRTUAL_PERIODIC the Cell-list contain also the virtual periodic
+	 * images, the symmetric iterator must be used with getPosVirtualVector() in place of getPosVector()
 	 *
 	 * \tparam CellL CellList type to construct
 	 *
@@ -1334,6 +1447,10 @@ public:
 	}
 
 	/*! \brief Construct a cell list starting from the stored particles
+	 *
+	 * If the last ghost_get used GHOST_VIRTUAL_PERIODIC the Cell-list contain also the virtual periodic
+	 * images, they have id bigger or equal than size_local_with_ghost() and they must be accessed with
+	 * getPosVirtual and getVirtualSource
 	 *
 	 * \tparam CellL CellList type to construct
 	 *
@@ -1532,7 +1649,19 @@ public:
 
 		if (to_reconstruct == false)
 		{
-			populate_cell_list<dim,St,prop,Memory,layout_base,CellL,prp ...>(v_pos,v_pos_out,v_prp,v_prp_out,cell_list,v_cl.getGpuContext(false),g_m,CL_NON_SYMMETRIC,opt);
+			bool done = false;
+
+			if (nn_thr != 1 && opt == cl_construct_opt::Full)
+			{
+				typedef populate_cell_list_threads_impl<has_addCell<CellL>::value && is_gpu_celllist<CellL>::value == false> pcl_thr;
+
+				done = pcl_thr::template populate<dim,St>(v_pos,cell_list,nn_threads_number(nn_thr));
+			}
+
+			if (done == false)
+			{populate_cell_list<dim,St,prop,Memory,layout_base,CellL,prp ...>(v_pos,v_pos_out,v_prp,v_prp_out,cell_list,v_cl.getGpuContext(false),g_m,CL_NON_SYMMETRIC,opt);}
+
+			add_virtual_images(cell_list,"getCellList/updateCellList");
 
 			cell_list.set_gm(g_m);
 		}
@@ -1569,6 +1698,8 @@ public:
 		{
 			populate_cell_list(v_pos,v_pos_out,v_prp,v_prp_out,cell_list,v_cl.getGpuContext(),g_m,CL_SYMMETRIC,cl_construct_opt::Full);
 
+			add_virtual_images(cell_list,"getCellListSym/updateCellListSym");
+
 			cell_list.set_gm(g_m);
 		}
 		else
@@ -1668,6 +1799,10 @@ public:
 	}
 
 	/*! \brief for each particle get the symmetric verlet list
+	 *
+	 * If the last ghost_get used GHOST_VIRTUAL_PERIODIC the neighborhood contain also the virtual periodic
+	 * images (like getVerlet), a pair with an image is stored only once like a pair with a ghost particle.
+	 * With pair_kernel the contributions on the images go directly to their source particles
 	 *
 	 * \param r_cut cut-off radius
 	 *
@@ -1686,7 +1821,15 @@ public:
 		// Processor bounding box
 		Box<dim, St> pbox = getDecomposition().getProcessorBounds();
 
-		ver.InitializeSym(getDecomposition().getDomain(),pbox,getDecomposition().getGhost(),r_cut,v_pos,g_m);
+		if (this->isVirtualPeriodic() == false)
+		{ver.InitializeSym(getDecomposition().getDomain(),pbox,getDecomposition().getGhost(),r_cut,v_pos,g_m);}
+		else
+		{
+			// Construct only the internal Cell-list, the neighborhood is filled with the virtual images
+			ver.InitializeSym(getDecomposition().getDomain(),pbox,getDecomposition().getGhost(),r_cut,v_pos,0);
+
+			fill_verlet_sym_images(ver,r_cut);
+		}
 
 		ver.set_ndec(getDecomposition().get_ndec());
 
@@ -1715,6 +1858,8 @@ public:
 		se3.getNN();
 #endif
 
+		check_no_virtual_images("getVerletCrs");
+
 		VerletL ver;
 
 		// Processor bounding box
@@ -1747,6 +1892,10 @@ public:
 	}
 
 	/*! \brief for each particle get the verlet list
+	 *
+	 * If the last ghost_get used GHOST_VIRTUAL_PERIODIC the neighborhood contain also the virtual periodic
+	 * images, they have id bigger or equal than size_local_with_ghost() and they must be accessed with
+	 * getPosVirtual and getVirtualSource (or with pair_kernel that resolve them)
 	 *
 	 * \param r_cut cut-off radius
 	 *
@@ -1772,13 +1921,94 @@ public:
 		// enlarge the box where the Verlet is defined
 		bt.enlarge(g);
 
-		ver.Initialize(bt,getDecomposition().getProcessorBounds(),r_cut,v_pos,g_m,VL_NON_SYMMETRIC);
+		if (nn_thr != 1 || this->isVirtualPeriodic() == true)
+		{
+			// Construct the internal Cell-list and fill the neighborhood with several threads,
+			// the virtual periodic images are added to the Cell-list with the shift applied on the fly
+			ver.Initialize(bt,getDecomposition().getProcessorBounds(),r_cut,v_pos,0,VL_NON_SYMMETRIC);
+
+			auto & NN = ver.getInternalCellList();
+			NN.set_gm(g_m);
+			add_virtual_images(NN,"getVerlet");
+
+			fill_verlet_threads<dim,St>(ver,NN,getPosVirtualVector(),g_m,r_cut,nn_threads_number(nn_thr));
+		}
+		else
+		{ver.Initialize(bt,getDecomposition().getProcessorBounds(),r_cut,v_pos,g_m,VL_NON_SYMMETRIC);}
 
 		ver.set_ndec(getDecomposition().get_ndec());
 
 		return ver;
 	}
 
+	/*! \brief Get a multi-resolution Cell-list for particles with different interaction radii
+	 *
+	 * Two particles interact if their distance is smaller or equal than max(r_p,r_q), where the radius of every
+	 * particle is stored in the property prp_r. The particles are binned by radius into levels with different cell
+	 * sizes, so small particles does not search the big neighborhood required by the biggest radius (see CellListMultiRes)
+	 *
+	 * \note the radius must be available on the ghost particles (ghost_get<prp_r>) and smaller than the ghost
+	 *
+	 * \tparam prp_r property containing the radius of the particles
+	 *
+	 * \param n_lvl number of levels, if 0 it is calculated from the ratio between the biggest and the smallest radius
+	 *
+	 * \return the multi-resolution Cell-list
+	 *
+	 */
+	template<unsigned int prp_r> CellListMultiRes<dim,St> getCellListMultiRes(size_t n_lvl = 0)
+	{
+#ifdef SE_CLASS3
+		se3.getNN();
+#endif
+
+		check_no_virtual_images("getCellListMultiRes");
+
+		Box<dim,St> bt;
+		St r_max;
+
+		multi_res_parameters<prp_r>(bt,r_max,n_lvl);
+
+		CellListMultiRes<dim,St> cl;
+		cl.template Initialize<prp_r>(bt,r_max,n_lvl,v_pos,v_prp);
+
+		return cl;
+	}
+
+	/*! \brief for each particle get the verlet list with a per-particle interaction radius
+	 *
+	 * Two particles interact if their distance is smaller or equal than max(r_p,r_q), where the radius of every
+	 * particle is stored in the property prp_r. It is constructed from a multi-resolution Cell-list (see
+	 * getCellListMultiRes), it contain the neighborhood of the real particles
+	 *
+	 * \snippet vector_dist_NN_tests.cpp Verlet multi resolution
+	 *
+	 * \tparam prp_r property containing the radius of the particles
+	 *
+	 * \param n_lvl number of levels, if 0 it is calculated from the ratio between the biggest and the smallest radius
+	 *
+	 * \return the Verlet-list
+	 *
+	 */
+	template<unsigned int prp_r> VerletListMultiRes<dim,St> getVerletMultiRes(size_t n_lvl = 0)
+	{
+#ifdef SE_CLASS3
+		se3.getNN();
+#endif
+
+		check_no_virtual_images("getVerletMultiRes");
+
+		Box<dim,St> bt;
+		St r_max;
+
+		multi_res_parameters<prp_r>(bt,r_max,n_lvl);
+
+		VerletListMultiRes<dim,St> ver;
+		ver.template Initialize<prp_r>(bt,r_max,n_lvl,v_pos,v_prp,g_m);
+
+		return ver;
+	}
+
 	/*! \brief for each particle get the verlet list
 	 *
 	 * \param r_cut cut-off radius
@@ -1793,6 +2023,9 @@ public:
 		se3.getNN();
 #endif
 
+		if (opt == VL_CRS_SYMMETRIC)
+		{check_no_virtual_images("updateVerlet with VL_CRS_SYMMETRIC");}
+
 		if (opt == VL_SYMMETRIC)
 		{
 			auto & NN = ver.getInternalCellList();
@@ -1801,7 +2034,14 @@ public:
 			// processor. if it is not like that we have to completely reconstruct from stratch
 			bool to_reconstruct = NN.get_ndec() != getDecomposition().get_ndec();
 
-			if (to_reconstruct == false)
+			if (to_reconstruct == false && this->isVirtualPeriodic() == true)
+			{
+				// update only the internal Cell-list, the neighborhood is filled with the virtual images
+				ver.update(getDecomposition().getDomain(),r_cut,v_pos,0,opt);
+
+				fill_verlet_sym_images(ver,r_cut);
+			}
+			else if (to_reconstruct == false)
 				ver.update(getDecomposition().getDomain(),r_cut,v_pos,g_m, opt);
 			else
 			{
@@ -1860,8 +2100,19 @@ public:
 			// processor. if it is not like that we have to completely reconstruct from stratch
 			bool to_reconstruct = NN.get_ndec() != getDecomposition().get_ndec();
 
-			if (to_reconstruct == false)
-				ver.update(getDecomposition().getDomain(),r_cut,v_pos,g_m, opt);
+			if (to_reconstruct == false && (nn_thr != 1 || this->isVirtualPeriodic() == true))
+			{
+				// the virtual periodic images are added to the Cell-list like in getVerlet
+				unsigned int n_thr = nn_threads_number(nn_thr);
+
+				populate_cell_list_threads<dim,St>(v_pos,NN,n_thr);
+				NN.set_gm(g_m);
+				add_virtual_images(NN,"updateVerlet");
+
+				fill_verlet_threads<dim,St>(ver,NN,getPosVirtualVector(),g_m,r_cut,n_thr);
+			}
+			else if (to_reconstruct == false)
+			{ver.update(getDecomposition().getDomain(),r_cut,v_pos,g_m, opt);}
 			else
 			{
 				VerletList<dim,St,Mem_type,shift<dim,St> > ver_tmp;
@@ -1992,6 +2243,7 @@ public:
 		// reset the ghost part
 		v_pos.resize(g_m);
 		v_prp.resize(g_m);
+		this->resetVirtualPeriodic();
 
 		auto cell_list = getCellList<CellL>(r_cut);
 
@@ -2371,6 +2623,246 @@ public:
 		return vector_dist_iterator(0, v_pos.size());
 	}
 
+	/*! \brief Apply a function to all the domain particles using a pool of threads
+	 *
+	 * The domain particles are divided in chunks of contiguous particles, the chunks are
+	 * executed as tasks by the threads, and idle threads steal the pending chunks
+	 *
+	 * \warning f is called concurrently, it must not write into other particles
+	 *
+	 * \param f function f(vect_dist_key_dx p) applied to every domain particle
+	 * \param chunk number of particles for each chunk
+	 *
+	 */
+	template<typename lambda_t>
+	void for_each_parallel(lambda_t f, size_t chunk = 1024)
+	{
+#ifdef SE_CLASS3
+		se3.getIterator();
+#endif
+
+		size_t n_chunk = (g_m + chunk - 1) / chunk;
+
+		auto fc = [&](size_t c, int thr)
+		{
+			size_t stop = ((c+1)*chunk < g_m)?(c+1)*chunk:g_m;
+
+			for (size_t i = c*chunk ; i < stop ; i++)
+			{f(vect_dist_key_dx(i));}
+		};
+
+		parallel_work_items(n_chunk,fc);
+	}
+
+	/*! \brief Apply a function to all the domain particles using a pool of threads and reduce the results
+	 *
+	 * Every thread accumulate into its own partial result, the partial results are reduced with op at the end
+	 *
+	 * \snippet Vector/tests/vector_dist_unit_test.cpp for_each_parallel reduction
+	 *
+	 * \param init identity of the reduction (for example 0 for a sum)
+	 * \param f function f(vect_dist_key_dx p, T & partial) applied to every domain particle
+	 * \param op reduction op(a,b) that return the reduction of a and b
+	 * \param chunk number of particles for each chunk
+	 *
+	 * \return the result of the reduction
+	 *
+	 */
+	template<typename T, typename lambda_t, typename reduce_t>
+	T for_each_parallel_reduce(const T & init, lambda_t f, reduce_t op, size_t chunk = 1024)
+	{
+#ifdef SE_CLASS3
+		se3.getIterator();
+#endif
+
+		size_t n_chunk = (g_m + chunk - 1) / chunk;
+
+		auto fc = [&](size_t c, T & partial)
+		{
+			size_t stop = ((c+1)*chunk < g_m)?(c+1)*chunk:g_m;
+
+			for (size_t i = c*chunk ; i < stop ; i++)
+			{f(vect_dist_key_dx(i),partial);}
+		};
+
+		return parallel_work_items_reduce(n_chunk,init,fc,op);
+	}
+
+	/*! \brief Apply a function to all the domain particles using a pool of threads, chunking by Cell-list cells
+	 *
+	 * Every chunk is a set of contiguous cells of the Cell-list NN, so particles processed by the same
+	 * thread are spatially close. It is useful when f access the neighborhood of the particle
+	 *
+	 * \param NN Cell-list (updated) used to chunk the particles
+	 * \param f function f(vect_dist_key_dx p) applied to every domain particle
+	 * \param chunk number of cells for each chunk
+	 *
+	 */
+	template<typename CellL, typename lambda_t>
+	void for_each_parallel_cells(CellL & NN, lambda_t f, size_t chunk = 16)
+	{
+#ifdef SE_CLASS3
+		se3.getIterator();
+#endif
+
+		size_t n_cell = NN.getGrid().size();
+		size_t n_chunk = (n_cell + chunk - 1) / chunk;
+
+		auto fc = [&](size_t c, int thr)
+		{
+			size_t stop = ((c+1)*chunk < n_cell)?(c+1)*chunk:n_cell;
+
+			for (size_t cell = c*chunk ; cell < stop ; cell++)
+			{
+				for (size_t j = 0 ; j < NN.getNelements(cell) ; j++)
+				{
+					size_t p = NN.get(cell,j);
+
+					// ghost particles are skipped
+					if (p < g_m)
+					{f(vect_dist_key_dx(p));}
+				}
+			}
+		};
+
+		parallel_work_items(n_chunk,fc);
+	}
+
+	/*! \brief Get the particle that store the data of a particle or of a virtual periodic image
+	 *
+	 * The virtual periodic images (GHOST_VIRTUAL_PERIODIC) have id bigger or equal than size_local_with_ghost(),
+	 * their properties are the properties of the source particle, writing into the source is like
+	 * writing into the image, no ghost_put is needed for them
+	 *
+	 * \param q particle or virtual image
+	 *
+	 * \return the particle that store the data of q
+	 *
+	 */
+	inline size_t getVirtualSource(size_t q)
+	{
+		if (q < v_pos.size())
+		{return q;}
+
+		return this->getVirtualImages().template get<0>(q - v_pos.size());
+	}
+
+	/*! \brief Get the position of a particle or of a virtual periodic image
+	 *
+	 * \param q particle or virtual image
+	 *
+	 * \return the position
+	 *
+	 */
+	inline Point<dim,St> getPosVirtual(size_t q)
+	{
+		if (q < v_pos.size())
+		{return v_pos.get(q);}
+
+		auto & img = this->getVirtualImages();
+		size_t i = q - v_pos.size();
+
+		Point<dim,St> p = v_pos.get(img.template get<0>(i));
+		p -= getDecomposition().getShiftVectors().get(img.template get<1>(i));
+
+		return p;
+	}
+
+	/*! \brief Get the positions of the particles followed by the virtual periodic images
+	 *
+	 * It must be used in place of getPosVector() to iterate the neighborhood of a Cell-list constructed
+	 * after a ghost_get with GHOST_VIRTUAL_PERIODIC, like in getNNIteratorSym(cell,p,vd.getPosVirtualVector()).
+	 * The position of the images is calculated on the fly, it is valid until the next ghost_get or map
+	 *
+	 * \return the positions of the particles and of the virtual images
+	 *
+	 */
+	inline auto getPosVirtualVector()
+	{
+		auto & img = this->getVirtualImages();
+		auto & shifts = getDecomposition().getShiftVectors();
+
+		typedef typename std::remove_reference<decltype(img)>::type img_type;
+		typedef typename std::remove_reference<decltype(shifts)>::type shift_type;
+
+		return vector_pos_virtual<dim,St,vector_dist_pos,img_type,shift_type>(v_pos,img,shifts);
+	}
+
+	/*! \brief Apply a pair kernel to all the pairs of a Verlet-list
+	 *
+	 * For every particle p the neighborhood is gathered into tiles of PAIR_TILE pairs in structure of arrays
+	 * (x_p - x_q, squared distance and the input properties prp_in of q, see pair_tile), f compute
+	 * the result of every lane of the tile and the results are accumulated on the property prp_out
+	 * (scalar or array) of p. Looping over the lanes of a tile the compiler can vectorize f.
+	 *
+	 * With a symmetric Verlet-list (VL_SYMMETRIC or VL_CRS_SYMMETRIC) sym_sign times the result of every lane is also
+	 * accumulated on q (-1 for forces, 1 for symmetric quantities like the density), the contributions on the
+	 * ghost particles must be sent back with ghost_put. The non symmetric case is executed in parallel,
+	 * the symmetric one is sequential. The virtual periodic images (GHOST_VIRTUAL_PERIODIC) are resolved on the
+	 * fly, their position is shifted and with VL_SYMMETRIC the contribution on q go directly to the source particle.
+	 * The VL_CRS_SYMMETRIC Verlet-lists cannot be constructed with virtual periodic images
+	 *
+	 * \snippet vector_dist_NN_tests.cpp pair kernel
+	 *
+	 * \tparam prp_out property where the results are accumulated
+	 * \tparam prp_in scalar properties gathered for the neighbors
+	 *
+	 * \param ver Verlet-list
+	 * \param f kernel f(pair_tile & t)
+	 * \param opt VL_NON_SYMMETRIC, VL_SYMMETRIC or VL_CRS_SYMMETRIC (the option used to construct the Verlet-list)
+	 * \param sym_sign sign of the contribution on q for symmetric Verlet-lists
+	 *
+	 */
+	template<unsigned int prp_out, unsigned int ... prp_in, typename VerletL, typename lambda_t>
+	void pair_kernel(VerletL & ver, lambda_t f, size_t opt = VL_NON_SYMMETRIC, int sym_sign = -1)
+	{
+#ifdef SE_CLASS3
+		se3.getIterator();
+#endif
+
+		typedef typename std::remove_reference<decltype(v_prp.template get<prp_out>(0))>::type out_type;
+		typedef pair_tile<dim,St,sizeof...(prp_in),pair_kernel_prp<out_type>::n> tile_type;
+
+		if (opt == VL_CRS_SYMMETRIC)
+		{check_no_virtual_images("pair_kernel with a VL_CRS_SYMMETRIC Verlet-list");}
+
+		// resolve the virtual periodic images
+		pair_kernel_images<decltype(this->getVirtualImages()),decltype(getDecomposition().getShiftVectors())>
+		img(this->getVirtualImages(),getDecomposition().getShiftVectors(),v_pos.size());
+
+		if (opt == VL_NON_SYMMETRIC)
+		{
+			size_t chunk = 256;
+			size_t n_chunk = (g_m + chunk - 1) / chunk;
+
+			auto fc = [&](size_t c, int thr)
+			{
+				tile_type t;
+				size_t stop = ((c+1)*chunk < g_m)?(c+1)*chunk:g_m;
+
+				for (size_t p = c*chunk ; p < stop ; p++)
+				{pair_kernel_particle<dim,St,prp_out,prp_in...>(p,ver,v_pos,v_prp,img,t,f,0);}
+			};
+
+			parallel_work_items(n_chunk,fc);
+		}
+		else if (opt == VL_CRS_SYMMETRIC)
+		{
+			tile_type t;
+			auto & seq = ver.getParticleSeq();
+
+			for (size_t i = 0 ; i < seq.size() ; i++)
+			{pair_kernel_particle<dim,St,prp_out,prp_in...>(seq.get(i),ver,v_pos,v_prp,img,t,f,sym_sign);}
+		}
+		else
+		{
+			tile_type t;
+
+			for (size_t p = 0 ; p < g_m ; p++)
+			{pair_kernel_particle<dim,St,prp_out,prp_in...>(p,ver,v_pos,v_prp,img,t,f,sym_sign);}
+		}
+	}
+
 	/*! \brief Get the decomposition
 	 *
 	 * \return
@@ -2430,6 +2922,9 @@ public:
 	 * elements out the local processor. Or just after initialization if each processor
 	 * contain non local particles
 	 *
+	 * With MAP_LOCAL | NEIGHBOR_COLLECTIVE the particles must move only to the near processors, they are
+	 * exchanged with MPI neighborhood collectives on the graph of the near processors (CPU, linear layout)
+	 *
 	 * \param opt options
 	 *
 	 */
@@ -2452,6 +2947,54 @@ public:
 		se3.map_post();
 #endif
 	}
+
+	/*! \brief Start to move the particles that does not belong to the local processor to the respective processor
+	 *
+	 * The particles that leave the processor are removed and sent. The particles that stay are valid and can be
+	 * iterated with getDomainIterator() and processed while the migrants are in flight, the particles received are
+	 * appended by map_wait(). Between Imap() and map_wait() particles must not be added or removed
+	 *
+	 * \snippet vector_dist_unit_test.cpp Imap overlap
+	 *
+	 * \tparam out of bound policy it specify what to do when the particles are detected out of bound
+	 *
+	 * \param opt options (with RUN_ON_DEVICE the map is synchronous)
+	 *
+	 */
+	template<typename obp = KillParticle> void Imap(size_t opt = NONE)
+	{
+#ifdef SE_CLASS3
+		se3.map_pre();
+#endif
+#ifdef SE_CLASS1
+	    map_ctr++;
+#endif
+
+		this->template Imap_<obp>(v_pos,v_prp,g_m,opt);
+
+#ifdef CUDA_GPU
+		this->update(this->toKernel());
+#endif
+	}
+
+	/*! \brief Complete the map started with Imap(), the received particles are appended to the local particles
+	 *
+	 * \param opt options
+	 *
+	 */
+	void map_wait(size_t opt = NONE)
+	{
+		this->map_wait_(v_pos,v_prp,g_m,opt);
+
+#ifdef CUDA_GPU
+		this->update(this->toKernel());
+#endif
+
+#ifdef SE_CLASS3
+		se3.map_post();
+#endif
+	}
+
 #ifdef SE_CLASS1
     int getMapCtr() const
     {
@@ -2472,6 +3015,15 @@ public:
 	}
 
 	/*! \brief It synchronize the properties and position of the ghost particles
+	 *
+	 * With SKIP_LABELLING | GHOST_ZERO_COPY the properties are sent directly from the particles and received
+	 * directly in the ghost part (CPU, linear layout), without send and receive buffers
+	 *
+	 * With NEIGHBOR_COLLECTIVE the ghost is exchanged with MPI neighborhood collectives on the graph of the near
+	 * processors of the decomposition (CPU, linear layout)
+	 *
+	 * With GHOST_NODE_SHARED the processors on the same node read the ghost directly from the MPI-3 shared
+	 * memory segment of the sender, the processors on other nodes use the normal exchange (CPU, linear layout)
 	 *
 	 * \tparam prp list of properties to get synchronize
 	 *
@@ -2509,6 +3061,43 @@ public:
 	}
 
 
+	/*! \brief It synchronize the properties and position of the ghost particles up to a cutoff
+	 *
+	 * Only the particles at distance smaller than rcut from the sub-domains of the other processors
+	 * (and the local periodic images at distance smaller than rcut) are sent, rcut must be smaller
+	 * than the ghost. Interactions with different ranges can synchronize only the layer they need
+	 *
+	 * \snippet vector_dist_unit_test.cpp ghost_get with cutoff
+	 *
+	 * The labelling is cached for every cutoff, so SKIP_LABELLING can be used also when ghost_get
+	 * with different cutoffs are alternated. If the current ghost particles have been produced by
+	 * another cutoff the positions are sent in any case
+	 *
+	 * \tparam prp list of properties to get synchronize
+	 *
+	 * \param opt options WITH_POSITION, it send also the positional information of the particles
+	 * \param rcut cutoff
+	 *
+	 */
+	template<int ... prp> inline void ghost_get(size_t opt, St rcut)
+	{
+#ifdef SE_CLASS1
+		Vcluster<Memory> & v_cl = create_vcluster<Memory>();
+
+		if (getDecomposition().getProcessorBounds().isValid() == false && size_local() != 0)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error the processor " << v_cl.getProcessUnitID() << " has particles, but is supposed to be unloaded" << std::endl;
+			ACTION_ON_ERROR(VECTOR_DIST_ERROR_OBJECT);
+		}
+#endif
+
+		this->template ghost_get_<GHOST_SYNC,prp...>(v_pos,v_prp,g_m,opt,rcut);
+
+#ifdef CUDA_GPU
+		this->update(this->toKernel());
+#endif
+	}
+
 	/*! \brief It synchronize the properties and position of the ghost particles
 	 *
 	 * \tparam prp list of properties to get synchronize
@@ -2576,6 +3165,7 @@ public:
 	 * \param opt_ options. It is an optional parameter.
 	 *             If set to NO_CHANGE_ELEMENTS the communication has lower latencies. This option has some usage limitations, so please refere to the examples
 	 *             for further explanations
+	 *             With NEIGHBOR_COLLECTIVE the communication use MPI neighborhood collectives on the graph of the near processors
 	 *
 	 *
 	 */
@@ -2649,6 +3239,108 @@ public:
 		g_m--;
 	}
 
+	/*! \brief Remove a set of particles without preserving the order of the remaining particles
+	 *
+	 * The holes below the new number of real particles are filled with the surviving particles
+	 * from the end of the real particles (like map does for the migrating particles), so the cost is
+	 * O(k) moves plus one pass over the marks instead of shifting all the tail for every removed
+	 * particle. The moves are executed in parallel in chunks of REMOVE_UNORDERED_CHUNK particles. The ghost particles are moved down to
+	 * stay after the real particles
+	 *
+	 * \param keys real particles to remove (in any order, duplicates are ignored)
+	 * \param moved if not NULL it is filled with the pairs (old index, new index) of the moved
+	 *        real particles, it can be used to update external indexes
+	 *
+	 */
+	void remove_unordered(const openfpm::vector<size_t> & keys, openfpm::vector<std::pair<size_t,size_t>> * moved = NULL)
+	{
+		if (moved != NULL)
+		{moved->clear();}
+
+		if (keys.size() == 0)
+		{return;}
+
+		openfpm::vector<unsigned char> mark;
+		mark.resize(g_m);
+
+		for (size_t i = 0 ; i < g_m ; i++)
+		{mark.get(i) = 0;}
+
+		size_t k = 0;
+		for (size_t i = 0 ; i < keys.size() ; i++)
+		{
+#ifdef SE_CLASS1
+			if (keys.get(i) >= g_m)
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " Error the particle " << keys.get(i) << " is not a real particle" << std::endl;
+				continue;
+			}
+#endif
+
+			if (mark.get(keys.get(i)) == 0)
+			{
+				mark.get(keys.get(i)) = 1;
+				k++;
+			}
+		}
+
+		size_t g_m_new = g_m - k;
+
+		// holes inside the new real particles and surviving particles outside, they have the same number
+		openfpm::vector<size_t> holes;
+		openfpm::vector<size_t> fill;
+
+		for (size_t i = g_m_new ; i < g_m ; i++)
+		{
+			if (mark.get(i) == 0)
+			{fill.add(i);}
+		}
+
+		for (size_t i = 0 ; i < keys.size() && holes.size() < fill.size() ; i++)
+		{
+			if (keys.get(i) < g_m_new && mark.get(keys.get(i)) == 1)
+			{
+				holes.add(keys.get(i));
+				mark.get(keys.get(i)) = 2;
+			}
+		}
+
+		// one work item move a chunk of particles
+		auto fm = [&](size_t c, int thr)
+		{
+			size_t stop = std::min((c+1)*REMOVE_UNORDERED_CHUNK,holes.size());
+
+			for (size_t i = c*REMOVE_UNORDERED_CHUNK ; i < stop ; i++)
+			{
+				v_pos.set(holes.get(i),v_pos.get(fill.get(i)));
+				v_prp.set(holes.get(i),v_prp.get(fill.get(i)));
+			}
+		};
+
+		parallel_work_items((holes.size() + REMOVE_UNORDERED_CHUNK - 1) / REMOVE_UNORDERED_CHUNK,fm);
+
+		if (moved != NULL)
+		{
+			moved->resize(holes.size());
+			for (size_t i = 0 ; i < holes.size() ; i++)
+			{moved->get(i) = std::pair<size_t,size_t>(fill.get(i),holes.get(i));}
+		}
+
+		// move the ghost down
+		size_t n_ghost = v_pos.size() - g_m;
+
+		for (size_t i = 0 ; i < n_ghost ; i++)
+		{
+			v_pos.set(g_m_new + i,v_pos.get(g_m + i));
+			v_prp.set(g_m_new + i,v_prp.get(g_m + i));
+		}
+
+		v_pos.resize(g_m_new + n_ghost);
+		v_prp.resize(g_m_new + n_ghost);
+
+		g_m = g_m_new;
+	}
+
 	/*! \brief Add the computation cost on the decomposition coming
 	 * from the particles
 	 *
@@ -2742,6 +3434,9 @@ public:
 	}
 
 	/*! \brief Load the distributed vector from an HDF5 file
+	 *
+	 * The file can be written by any number of processors. Every processor read in parallel a set of
+	 * the blocks written, the particles are then moved to the processor that own them with one map
 	 *
 	 * \param filename file from where to load
 	 *
@@ -2751,6 +3446,9 @@ public:
 		HDF5_reader<VECTOR_DIST> h5l;
 
 		h5l.load(filename,v_pos,v_prp,g_m);
+
+		// the blocks read are not related to the decomposition
+		map();
 	}
 
 	/*! \brief Reserve space for the internal vectors
@@ -2810,6 +3508,9 @@ public:
 			if (opt & FORMAT_BINARY)
 				ft = file_type::BINARY;
 
+			if (n_out_agg != 0)
+			{return write_aggregated(out,meta_info,ft);}
+
 			// VTKWriter for a set of points
 			VTKWriter<boost::mpl::pair<vector_dist_pos,
 									   vector_dist_prop>,
@@ -2830,6 +3531,168 @@ public:
 		}
 	}
 
+	/*! \brief Set the number of threads used to construct Cell-lists and Verlet-lists
+	 *
+	 * It affect getCellList, updateCellList, getVerlet and updateVerlet (non symmetric) for
+	 * CPU Cell-lists. With n_thr == 1 (default) the construction is sequential
+	 *
+	 * \param n_thr number of threads (0 = all the threads available)
+	 *
+	 */
+	void setNNThreads(unsigned int n_thr)
+	{
+		nn_thr = n_thr;
+	}
+
+	/*! \brief Get the number of threads used to construct Cell-lists and Verlet-lists
+	 *
+	 * \return the number of threads (0 = all the threads available)
+	 *
+	 */
+	unsigned int getNNThreads() const
+	{
+		return nn_thr;
+	}
+
+	/*! \brief Set the number of processors that aggregate the output
+	 *
+	 * When n_agg is different from zero, write and write_frame do not produce one file for each processor.
+	 * The processors are divided in n_agg contiguous groups, the first processor of each group
+	 * gather the particles of the group and write them in one file. Processor 0 write
+	 * one index (pvtp) file that reference only the aggregated files. The CSV output is not aggregated
+	 *
+	 * \param n_agg number of aggregators (0 disable the aggregation)
+	 *
+	 */
+	void setOutputAggregators(size_t n_agg)
+	{
+		n_out_agg = n_agg;
+	}
+
+	/*! \brief Get the number of processors that aggregate the output
+	 *
+	 * \return the number of aggregators (0 = each processor write its own file)
+	 *
+	 */
+	size_t getOutputAggregators() const
+	{
+		return n_out_agg;
+	}
+
+	/*! \brief Output particle position and properties gathering them into the aggregator processors
+	 *
+	 * The file produced by the aggregator of the group g is out_g.vtp (out_g_iteration.vtp for a frame)
+	 *
+	 * \param out output filename
+	 * \param meta_info meta information example ("time = 1.234" add the information time to the VTK file)
+	 * \param ft ASCII or BINARY
+	 * \param iteration frame number (-1 if it is not a frame)
+	 * \param time time stamp of the frame added to the pvtp (NULL for none)
+	 *
+	 * \return true if the file has been written without error
+	 *
+	 */
+	inline bool write_aggregated(std::string out, std::string meta_info, file_type ft, long int iteration = -1, const double * time = NULL)
+	{
+		Vcluster<Memory> & v_cl = create_vcluster<Memory>();
+
+		size_t n_agg = (n_out_agg > v_cl.size())?v_cl.size():n_out_agg;
+
+		// size of each group, number of groups and aggregator of this processor
+		size_t g_sz = (v_cl.size() + n_agg - 1) / n_agg;
+		size_t n_grp = (v_cl.size() + g_sz - 1) / g_sz;
+		size_t grp = v_cl.rank() / g_sz;
+		size_t agg = grp * g_sz;
+
+		openfpm::vector<openfpm::vector<Point<dim, St>,Memory,layout_base,openfpm::grow_policy_identity>> m_pos;
+		openfpm::vector<openfpm::vector<prop,Memory,layout_base,openfpm::grow_policy_identity>> m_prp;
+
+		openfpm::vector<size_t> prc_send;
+		openfpm::vector<size_t> prc_recv;
+		openfpm::vector<size_t> sz_recv;
+
+		// particles gathered by the aggregator
+		vector_dist_pos a_pos;
+		vector_dist_prop a_prp;
+
+		if (v_cl.rank() == agg)
+		{
+			// The aggregator start from its own real particles
+			a_pos.resize(g_m);
+			a_prp.resize(g_m);
+
+			for (size_t i = 0 ; i < g_m ; i++)
+			{
+				a_pos.get(i) = v_pos.get(i);
+				a_prp.get(i) = v_prp.get(i);
+			}
+		}
+		else
+		{
+			m_pos.resize(1);
+			m_prp.resize(1);
+
+			m_pos.get(0).resize(g_m);
+			m_prp.get(0).resize(g_m);
+
+			for (size_t i = 0 ; i < g_m ; i++)
+			{
+				m_pos.get(0).get(i) = v_pos.get(i);
+				m_prp.get(0).get(i) = v_prp.get(i);
+			}
+
+			prc_send.add(agg);
+		}
+
+		// Positions and properties are received in the same processor order
+		v_cl.template SSendRecv<openfpm::vector<Point<dim, St>,Memory,layout_base,openfpm::grow_policy_identity>,
+					   vector_dist_pos,
+					   layout_base>
+					   (m_pos,a_pos,prc_send,prc_recv,sz_recv);
+
+		v_cl.template SSendRecv<openfpm::vector<prop,Memory,layout_base,openfpm::grow_policy_identity>,
+					   vector_dist_prop,
+					   layout_base>
+					   (m_prp,a_prp,prc_send,prc_recv,sz_recv);
+
+		if(v_cl.rank()==0)
+		{
+			create_directory_if_not_exist("VTPDATA",1);
+
+			VTKWriter<boost::mpl::pair<vector_dist_pos,
+									   vector_dist_prop>,
+			                           VECTOR_POINTS> vtk_writer;
+
+			if (iteration == -1)
+			{vtk_writer.write_pvtp(out,prp_names,n_grp);}
+			else if (time == NULL)
+			{vtk_writer.write_pvtp(out,prp_names,n_grp,iteration);}
+			else
+			{vtk_writer.write_pvtp(out,prp_names,n_grp,iteration,*time);}
+		}
+		v_cl.barrier();
+
+		bool ret = true;
+
+		if (v_cl.rank() == agg)
+		{
+			VTKWriter<boost::mpl::pair<vector_dist_pos,
+									   vector_dist_prop>,
+			                           VECTOR_POINTS> vtk_writer;
+			vtk_writer.add(a_pos,a_prp,a_pos.size());
+
+			std::string output = out + "_" + std::to_string(grp) + ((iteration == -1)?std::string(""):"_" + std::to_string(iteration)) + ".vtp";
+			ret = vtk_writer.write(output,prp_names,"particles",meta_info,ft);
+		}
+
+		// all the processors report the result of the aggregators
+		size_t err = (ret == false);
+		v_cl.max(err);
+		v_cl.execute();
+
+		return err == 0;
+	}
+
 	/*! \brief Delete the particles on the ghost
 	 *
 	 *
@@ -2838,6 +3701,8 @@ public:
 	{
 		v_pos.resize(g_m);
 		v_prp.resize(g_m);
+
+		this->resetVirtualPeriodic();
 	}
 
 	/*! \brief Resize the vector (locally)
@@ -2926,6 +3791,9 @@ public:
 			if (opt & FORMAT_BINARY)
 				ft = file_type::BINARY;
 
+			if (n_out_agg != 0)
+			{return write_aggregated(out,meta_info,ft,iteration);}
+
 			// VTKWriter for a set of points
 			VTKWriter<boost::mpl::pair<vector_dist_pos,
 									   vector_dist_prop>, VECTOR_POINTS> vtk_writer;
@@ -2981,6 +3849,9 @@ public:
 			if (opt & FORMAT_BINARY)
 				ft = file_type::BINARY;
 
+			if (n_out_agg != 0)
+			{return write_aggregated(out,"",ft,iteration,&time);}
+
 			// VTKWriter for a set of points
 			VTKWriter<boost::mpl::pair<vector_dist_pos,
 									   vector_dist_prop>, VECTOR_POINTS> vtk_writer;
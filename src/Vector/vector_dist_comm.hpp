@@ -18,6 +18,13 @@
 #include "Vector/util/vector_dist_funcs.hpp"
 #include "cuda/vector_dist_comm_util_funcs.cuh"
 #include "util/cuda/scan_ofp.cuh"
+#include "memory/PtrMemory.hpp"
+#include "Vector/util/vector_dist_ghost_zero_copy.hpp"
+#include "util/for_each_parallel.hpp"
+#include "util/node_shared_exchange.hpp"
+
+//! Number of particles labelled by a work item in local_ghost_from_dec
+#define LOCAL_GHOST_CHUNK 1024
 
 template<typename T>
 struct DEBUG
@@ -416,6 +423,24 @@ class vector_dist_comm
 	//! The same as recv_sz_get but for map
 	openfpm::vector<size_t> recv_sz_map;
 
+	//! Imap in progress: processors to send
+	openfpm::vector<size_t> map_prc_r;
+
+	//! Imap in progress: sending buffers for positions
+	openfpm::vector<openfpm::vector<Point<dim, St>,Memory,layout_base,openfpm::grow_policy_identity>> map_m_pos;
+
+	//! Imap in progress: sending buffers for properties
+	openfpm::vector<openfpm::vector<prop,Memory,layout_base,openfpm::grow_policy_identity>> map_m_prp;
+
+	//! Imap in progress: received positions
+	openfpm::vector<Point<dim, St>,Memory,layout_base> map_recv_pos;
+
+	//! Imap in progress: received properties
+	openfpm::vector<prop,Memory,layout_base> map_recv_prp;
+
+	//! Imap in progress
+	bool map_async = false;
+
 	//! elements sent for each processors (ghost_get)
 	openfpm::vector<size_t> prc_sz_gg;
 
@@ -432,6 +457,32 @@ class vector_dist_comm
 	//! Processor communication size
 	openfpm::vector<aggregate<unsigned int, unsigned int>,Memory,layout_base> prc_offset;
 
+	//! Exchange of the ghost properties without buffers (GHOST_ZERO_COPY)
+	ghost_zero_copy zc;
+
+	//! the ghost layout of the last labelling allow the zero copy exchange (-1 not decided yet)
+	int zc_ok = -1;
+
+	//! number of ghost_get done with the zero copy exchange
+	size_t n_zero_copy = 0;
+
+	//! Exchange of the ghost with the processors of the same node (GHOST_NODE_SHARED)
+	node_shared_exchange nse;
+
+	//! index in prc_g_opart of the processors on the same node
+	openfpm::vector<size_t> nsh_on;
+
+	//! g_opart of the processors on other nodes
+	openfpm::vector<openfpm::vector<aggregate<size_t,size_t>>> g_opart_off;
+
+	//! processors on other nodes we send ghost to
+	openfpm::vector<size_t> prc_g_opart_off;
+
+	//! number of ghost particles we send to the processors on other nodes
+	openfpm::vector<size_t> prc_sz_gg_off;
+
+	//! the split of the current labelling between on-node and other nodes is valid
+	bool nsh_valid = false;
 
 	//! Temporary CudaMemory to do stuff
 	CudaMemory mem;
@@ -440,6 +491,9 @@ class vector_dist_comm
 	//! replicated ghost particles that are local
 	size_t lg_m;
 
+	//! The local periodic images are virtual (GHOST_VIRTUAL_PERIODIC), they are only listed in o_part_loc
+	bool virt_img = false;
+
 	//! Sending buffer
 	openfpm::vector_fr<Memory> hsmem;
 
@@ -568,6 +622,18 @@ class vector_dist_comm
 	//! each group contain internal ghost coming from sub-domains of the same section
 	openfpm::vector_std<openfpm::vector_std<Box<dim, St>>> box_f;
 
+	//! Bounding box of every group of box_f
+	openfpm::vector_std<Box<dim, St>> box_f_bb;
+
+	//! Shift id of every group of box_f
+	openfpm::vector_std<size_t> box_f_lin;
+
+	//! The particles inside this box (the domain shrunk by the ghost) are not inside any box of box_f
+	Box<dim, St> box_f_inner;
+
+	//! Indicate if box_f_inner is valid
+	bool box_f_inner_valid = false;
+
 	//! The boxes touching the border of the domain + shift vector linearized from where they come from
 	openfpm::vector<Box<dim, St>,Memory,layout_base> box_f_dev;
 	openfpm::vector<aggregate<unsigned int>,Memory,layout_base> box_f_sv;
@@ -578,6 +644,252 @@ class vector_dist_comm
 	//! Id of the local particle to replicate for ghost_get
 	openfpm::vector<aggregate<unsigned int,unsigned int>,Memory,layout_base> o_part_loc;
 
+	//! Labelling of a ghost_get for one cutoff, it is cached to be reused with SKIP_LABELLING
+	struct ghost_rcut_lbl
+	{
+		//! cutoff (0 is the full ghost)
+		St rcut;
+
+		//! indicate if the labelling is stored
+		bool valid = false;
+
+		//! see g_opart
+		openfpm::vector<openfpm::vector<aggregate<size_t,size_t>>> g_opart;
+
+		//! see prc_g_opart
+		openfpm::vector<size_t> prc_g_opart;
+
+		//! see prc_sz_gg
+		openfpm::vector<size_t> prc_sz_gg;
+
+		//! see g_opart_sz
+		openfpm::vector<size_t> g_opart_sz;
+
+		//! see prc_recv_get_pos
+		openfpm::vector<size_t> prc_recv_get_pos;
+
+		//! see prc_recv_get_prp
+		openfpm::vector<size_t> prc_recv_get_prp;
+
+		//! see recv_sz_get_pos
+		openfpm::vector<size_t> recv_sz_get_pos;
+
+		//! see recv_sz_get_prp
+		openfpm::vector<size_t> recv_sz_get_prp;
+
+		//! see recv_sz_get_byte
+		openfpm::vector<size_t> recv_sz_get_byte;
+
+		//! see o_part_loc
+		openfpm::vector<aggregate<unsigned int,unsigned int>,Memory,layout_base> o_part_loc;
+
+		//! see lg_m
+		size_t lg_m = 0;
+
+		//! see g_rcut_n_ghost
+		size_t n_ghost = (size_t)-1;
+
+		//! see virt_img
+		bool virt_img = false;
+	};
+
+	//! Cutoff of the current labelling of the ghost_get (0 is the full ghost)
+	St g_rcut = 0;
+
+	//! Cutoff of the labelling that produced the current ghost particles
+	St g_rcut_layout = 0;
+
+	//! Number of ghost particles produced by the current labelling ((size_t)-1 unknown)
+	size_t g_rcut_n_ghost = (size_t)-1;
+
+	//! Labelling of the cutoffs that are not the current one
+	openfpm::vector<ghost_rcut_lbl> g_rcut_lbl;
+
+	/*! \brief Swap the current labelling of the ghost_get with a cached one
+	 *
+	 * \param l cached labelling
+	 *
+	 */
+	void ghost_rcut_swap(ghost_rcut_lbl & l)
+	{
+		g_opart.swap(l.g_opart);
+		prc_g_opart.swap(l.prc_g_opart);
+		prc_sz_gg.swap(l.prc_sz_gg);
+		g_opart_sz.swap(l.g_opart_sz);
+		prc_recv_get_pos.swap(l.prc_recv_get_pos);
+		prc_recv_get_prp.swap(l.prc_recv_get_prp);
+		recv_sz_get_pos.swap(l.recv_sz_get_pos);
+		recv_sz_get_prp.swap(l.recv_sz_get_prp);
+		recv_sz_get_byte.swap(l.recv_sz_get_byte);
+		o_part_loc.swap(l.o_part_loc);
+		std::swap(lg_m,l.lg_m);
+		std::swap(g_rcut_n_ghost,l.n_ghost);
+		std::swap(virt_img,l.virt_img);
+
+		nsh_valid = false;
+	}
+
+	/*! \brief Get the cache slot of a cutoff, it is created if it does not exist
+	 *
+	 * \param rcut cutoff
+	 *
+	 * \return the cached labelling
+	 *
+	 */
+	ghost_rcut_lbl & ghost_rcut_slot(St rcut)
+	{
+		for (size_t i = 0 ; i < g_rcut_lbl.size() ; i++)
+		{
+			if (g_rcut_lbl.get(i).rcut == rcut)
+			{return g_rcut_lbl.get(i);}
+		}
+
+		g_rcut_lbl.add();
+		g_rcut_lbl.last().rcut = rcut;
+
+		return g_rcut_lbl.last();
+	}
+
+	/*! \brief Select the labelling of the cutoff used by a ghost_get
+	 *
+	 * The current labelling is moved in the cache and the labelling of rcut is restored. If rcut has
+	 * never been labelled SKIP_LABELLING is removed. If the current ghost particles have been produced
+	 * by another cutoff the ghost part is resized and the positions are sent again. When the labelling
+	 * change the zero copy exchange (GHOST_ZERO_COPY) is decided again
+	 *
+	 * \param rcut cutoff of the ghost_get (0 or bigger than the ghost is the full ghost)
+	 * \param v_prp vector of particle properties
+	 * \param g_m ghost marker
+	 * \param opt ghost_get options
+	 *
+	 */
+	void ghost_rcut_select(St rcut, openfpm::vector<prop,Memory,layout_base> & v_prp, size_t g_m, size_t & opt)
+	{
+		if (rcut < 0 || rcut >= dec.getGhost().getRcut())
+		{rcut = 0;}
+
+		if (rcut != 0 && (opt & RUN_ON_DEVICE))
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Warning a ghost_get with a cutoff is supported only on CPU, the full ghost is used" << std::endl;
+			rcut = 0;
+		}
+
+		if (rcut != g_rcut)
+		{
+			ghost_rcut_lbl & cur = ghost_rcut_slot(g_rcut);
+			ghost_rcut_swap(cur);
+			cur.valid = true;
+
+			ghost_rcut_lbl & nxt = ghost_rcut_slot(rcut);
+
+			if (nxt.valid == true)
+			{
+				ghost_rcut_swap(nxt);
+				nxt.valid = false;
+			}
+			else
+			{opt &= ~SKIP_LABELLING;}
+
+			g_rcut = rcut;
+
+			// the zero copy layout has been built on the labelling of the previous cutoff
+			zc_ok = -1;
+			zc.reset();
+		}
+
+		if ((opt & SKIP_LABELLING) && g_rcut_layout != g_rcut)
+		{
+			if (g_rcut_n_ghost == (size_t)-1)
+			{opt &= ~SKIP_LABELLING;}
+			else
+			{
+				opt &= ~NO_POSITION;
+				v_prp.resize(g_m + g_rcut_n_ghost);
+			}
+		}
+	}
+
+	/*! \brief Record the ghost particles produced by the current labelling
+	 *
+	 * \param v_prp vector of particle properties
+	 * \param g_m ghost marker
+	 * \param known the number of ghost particles is known (synchronous ghost_get)
+	 *
+	 */
+	void ghost_rcut_record(openfpm::vector<prop,Memory,layout_base> & v_prp, size_t g_m, bool known)
+	{
+		g_rcut_layout = g_rcut;
+		g_rcut_n_ghost = (known == true)?v_prp.size() - g_m:(size_t)-1;
+	}
+
+	/*! \brief Invalidate the cached labellings of the ghost_get (the particles are redistributed)
+	 *
+	 */
+	void ghost_rcut_reset()
+	{
+		for (size_t i = 0 ; i < g_rcut_lbl.size() ; i++)
+		{g_rcut_lbl.get(i).valid = false;}
+
+		g_rcut_n_ghost = (size_t)-1;
+
+		zc_ok = -1;
+		zc.reset();
+
+		nsh_valid = false;
+	}
+
+	/*! \brief Internal ghost boxes reduced to the current cutoff
+	 *
+	 * The internal ghost box of a near processor sub-domain n is the intersection of a local sub-domain with
+	 * n enlarged by the ghost, the reduced one is the intersection with n enlarged by the cutoff
+	 *
+	 * \param ibx for each near processor the reduced internal ghost boxes
+	 * \param ibx_sh for each near processor the shift id of the reduced internal ghost boxes
+	 *
+	 */
+	void ghost_rcut_boxes(openfpm::vector<openfpm::vector<Box<dim,St>>> & ibx, openfpm::vector<openfpm::vector<size_t>> & ibx_sh)
+	{
+		ibx.clear();
+		ibx_sh.clear();
+		ibx.resize(dec.getNNProcessors());
+		ibx_sh.resize(dec.getNNProcessors());
+
+		Ghost<dim,St> g(g_rcut);
+
+		for (size_t i = 0 ; i < dec.getNNProcessors() ; i++)
+		{
+			size_t prc = dec.IDtoProc(i);
+
+			const openfpm::vector<::Box<dim,St>> & n_box = dec.getNearSubdomains(prc);
+			const openfpm::vector<comb<dim>> & n_pos = dec.getNearSubdomainsPos(prc);
+			const openfpm::vector<size_t> & n_rid = dec.getNearSubdomainsRealId(prc);
+
+			for (size_t j = 0 ; j < dec.getProcessorNIGhost(i) ; j++)
+			{
+				size_t r_sub = dec.getProcessorIGhostSSub(i,j);
+				const comb<dim> & cmb = dec.getProcessorIGhostPos(i,j);
+
+				for (size_t k = 0 ; k < n_box.size() ; k++)
+				{
+					if (n_rid.get(k) != r_sub || n_pos.get(k) != cmb)
+					{continue;}
+
+					Box<dim,St> nb = n_box.get(k);
+					nb.enlarge(g);
+
+					Box<dim,St> b_int;
+					if (nb.Intersect(dec.getProcessorIGhostBox(i,j),b_int) == true)
+					{
+						ibx.get(i).add(b_int);
+						ibx_sh.get(i).add(dec.convertShift(cmb));
+					}
+
+					break;
+				}
+			}
+		}
+	}
+
 	//! Processor communication size
 	openfpm::vector<aggregate<unsigned int, unsigned int>,Memory,layout_base> prc_sz;
 
@@ -644,6 +956,39 @@ class vector_dist_comm
 			}
 		}
 
+		// bounding box and shift of every group
+		box_f_bb.clear();
+		box_f_lin.clear();
+
+		for (size_t i = 0 ; i < box_f.size() ; i++)
+		{
+			box_f_bb.add(box_f.get(i).get(0));
+
+			for (size_t j = 1 ; j < box_f.get(i).size() ; j++)
+			{
+				for (size_t k = 0 ; k < dim ; k++)
+				{
+					box_f_bb.last().setLow(k,std::min(box_f_bb.last().getLow(k),box_f.get(i).get(j).getLow(k)));
+					box_f_bb.last().setHigh(k,std::max(box_f_bb.last().getHigh(k),box_f.get(i).get(j).getHigh(k)));
+				}
+			}
+
+			box_f_lin.add(dec.convertShift(box_cmb.get(i)));
+		}
+
+		// box_f are inside the layer of ghost size at the border of the domain
+		const Box<dim,St> & domain = dec.getDomain();
+		const Ghost<dim,St> & ghost = dec.getGhost();
+
+		box_f_inner_valid = true;
+		for (size_t k = 0 ; k < dim ; k++)
+		{
+			box_f_inner.setLow(k,domain.getLow(k) + std::fabs(ghost.getLow(k)));
+			box_f_inner.setHigh(k,domain.getHigh(k) - std::fabs(ghost.getHigh(k)));
+
+			box_f_inner_valid &= box_f_inner.getLow(k) < box_f_inner.getHigh(k);
+		}
+
 		// now we sort box_f by shift_id, the reason is that we have to avoid duplicated particles
 		reord_shift.sort();
 
@@ -678,6 +1023,10 @@ class vector_dist_comm
 			                    openfpm::vector<prop,Memory,layout_base> & v_prp,
 			                    size_t opt)
 	{
+		// virtual images does not have copies to update
+		if (virt_img == true)
+		{return;}
+
 		// get the shift vectors
 		const openfpm::vector<Point<dim, St>,Memory,layout_base> & shifts = dec.getShiftVectors();
 
@@ -747,49 +1096,107 @@ class vector_dist_comm
 		}
 		else
 		{
-			// Label the internal (assigned) particles
-			auto it = v_pos.getIteratorTo(g_m);
+			// with a cutoff the local sub-domains enlarged by the cutoff, the images outside are not created
+			openfpm::vector<Box<dim,St>> sub_r;
 
-			while (it.isNext())
+			if (g_rcut != 0)
 			{
-				auto key = it.get();
+				Ghost<dim,St> g(g_rcut);
+
+				for (size_t i = 0 ; i < dec.getNSubDomain() ; i++)
+				{
+					sub_r.add(dec.getSubDomain(i));
+					sub_r.last().enlarge(g);
+				}
+			}
+
+			// Label the internal (assigned) particles in parallel, every chunk has its own list, so the
+			// order of the local ghost particles is the same of a sequential labelling
+			size_t n_chunk = (g_m + LOCAL_GHOST_CHUNK - 1) / LOCAL_GHOST_CHUNK;
+			std::vector<std::vector<std::pair<size_t,size_t>>> lbl(n_chunk);
+
+			auto fl = [&](size_t c, int thr)
+			{
+				size_t stop = std::min(g_m,(c+1)*LOCAL_GHOST_CHUNK);
 
-				// If particles are inside these boxes
-				for (size_t i = 0; i < box_f.size(); i++)
+				for (size_t key = c*LOCAL_GHOST_CHUNK ; key < stop ; key++)
 				{
-					for (size_t j = 0; j < box_f.get(i).size(); j++)
+					Point<dim, St> xp = v_pos.get(key);
+
+					// most of the particles are far from the border of the domain
+					if (box_f_inner_valid == true && box_f_inner.isInsideNP(xp) == true)
+					{continue;}
+
+					// If particles are inside these boxes
+					for (size_t i = 0; i < box_f.size(); i++)
 					{
-						if (box_f.get(i).get(j).isInsideNP(v_pos.get(key)) == true)
+						if (box_f_bb.get(i).isInside(xp) == false)
+						{continue;}
+
+						for (size_t j = 0; j < box_f.get(i).size(); j++)
 						{
-							size_t lin_id = dec.convertShift(box_cmb.get(i));
-
-							o_part_loc.add();
-							o_part_loc.template get<0>(o_part_loc.size()-1) = key;
-							o_part_loc.template get<1>(o_part_loc.size()-1) = lin_id;
-
-							Point<dim, St> p = v_pos.get(key);
-							// shift
-							p -= shifts.get(lin_id);
-
-							// add this particle shifting its position
-							v_pos.add(p);
-							v_prp.add();
-							v_prp.last() = v_prp.get(key);
-
-							// boxes in one group can be overlapping
-							// we do not have to search for the other
-							// boxes otherwise we will have duplicate particles
-							//
-							// A small note overlap of boxes across groups is fine
-							// (and needed) because each group has different shift
-							// producing non overlapping particles
-							//
-							break;
+							if (box_f.get(i).get(j).isInsideNP(xp) == true)
+							{
+								size_t lin_id = box_f_lin.get(i);
+
+								if (g_rcut != 0)
+								{
+									Point<dim, St> pi = xp;
+									pi -= shifts.get(lin_id);
+
+									bool in = false;
+									for (size_t k = 0 ; k < sub_r.size() && in == false ; k++)
+									{in = sub_r.get(k).isInsideNP(pi);}
+
+									// the image is outside the cutoff, the other boxes of the group has the same shift
+									if (in == false)
+									{break;}
+								}
+
+								lbl[c].push_back(std::pair<size_t,size_t>(key,lin_id));
+
+								// boxes in one group can be overlapping
+								// we do not have to search for the other
+								// boxes otherwise we will have duplicate particles
+								//
+								// A small note overlap of boxes across groups is fine
+								// (and needed) because each group has different shift
+								// producing non overlapping particles
+								//
+								break;
+							}
 						}
 					}
 				}
+			};
 
-				++it;
+			parallel_work_items(n_chunk,fl);
+
+			// add the local ghost particles
+			for (size_t c = 0 ; c < lbl.size() ; c++)
+			{
+				for (size_t l = 0 ; l < lbl[c].size() ; l++)
+				{
+					size_t key = lbl[c][l].first;
+					size_t lin_id = lbl[c][l].second;
+
+					o_part_loc.add();
+					o_part_loc.template get<0>(o_part_loc.size()-1) = key;
+					o_part_loc.template get<1>(o_part_loc.size()-1) = lin_id;
+
+					// virtual image, it is only listed
+					if (virt_img == true)
+					{continue;}
+
+					Point<dim, St> p = v_pos.get(key);
+					// shift
+					p -= shifts.get(lin_id);
+
+					// add this particle shifting its position
+					v_pos.add(p);
+					v_prp.add();
+					v_prp.last() = v_prp.get(key);
+				}
 			}
 		}
 	}
@@ -851,8 +1258,13 @@ class vector_dist_comm
 		createShiftBox();
 
 		if (!(opt & SKIP_LABELLING))
+		{
 			lg_m = v_prp.size();
 
+			// the mode is decided when the particles are labelled
+			virt_img = (opt & GHOST_VIRTUAL_PERIODIC) && !(opt & RUN_ON_DEVICE);
+		}
+
 		if (box_f.size() == 0)
 			return;
 		else
@@ -1549,6 +1961,13 @@ class vector_dist_comm
 		}
 		else
 		{
+			// Internal ghost boxes reduced to the cutoff
+			openfpm::vector<openfpm::vector<Box<dim,St>>> ibx_r;
+			openfpm::vector<openfpm::vector<size_t>> ibx_sh;
+
+			if (g_rcut != 0)
+			{ghost_rcut_boxes(ibx_r,ibx_sh);}
+
 			// Iterate over all particles
 			auto it = v_pos.getIteratorTo(g_m);
 			while (it.isNext())
@@ -1564,6 +1983,19 @@ class vector_dist_comm
 					// processor id
 					size_t p_id = vp_id.get(i).first;
 
+					// with a cutoff the particle must be inside a reduced internal ghost box with the same shift
+					if (g_rcut != 0)
+					{
+						Point<dim,St> xp = v_pos.get(key);
+
+						bool in = false;
+						for (size_t j = 0 ; j < ibx_r.get(p_id).size() && in == false ; j++)
+						{in = ibx_sh.get(p_id).get(j) == vp_id.get(i).second && ibx_r.get(p_id).get(j).isInsideNP(xp);}
+
+						if (in == false)
+						{continue;}
+					}
+
 					// add particle to communicate
 					g_opart.get(p_id).add();
 					g_opart.get(p_id).last().template get<0>() = key;
@@ -1765,63 +2197,721 @@ public:
 		dec.decompose();
 	}
 
-	/*! \brief It synchronize the properties and position of the ghost particles
+	/*! \brief Send the buffers and receive with neighborhood collectives on the graph of the near processors
+	 *
+	 * \tparam T type of the elements in the send buffers
+	 *
+	 * \param g_send send buffers
+	 * \param prc_send processor of each send buffer
+	 * \param recv_prc processors that sent us elements, when known (in) the processors we receive from
+	 * \param recv_ptr for each processor a pointer to the received elements
+	 * \param recv_n for each processor the number of received elements, when known (in) the number of elements we receive
+	 * \param known if true the processors and the number of elements we receive are known (no exchange of the sizes)
+	 *
+	 * \return false if some elements are directed to processors that are not near processors (they are not sent)
+	 *
+	 */
+	template<typename T, typename send_vector_type>
+	bool nn_coll_sendrecv(openfpm::vector<send_vector_type> & g_send,
+						  const openfpm::vector<size_t> & prc_send,
+						  openfpm::vector<size_t> & recv_prc,
+						  openfpm::vector<const void *> & recv_ptr,
+						  openfpm::vector<size_t> & recv_n,
+						  bool known)
+	{
+		openfpm::vector<const void *> ptr;
+		openfpm::vector<size_t> sz;
+
+		for (size_t i = 0 ; i < g_send.size() ; i++)
+		{
+			ptr.add(g_send.get(i).getPointer());
+			sz.add(g_send.get(i).size()*sizeof(T));
+		}
+
+		bool ret;
+
+		if (known == true)
+		{
+			for (size_t i = 0 ; i < recv_n.size() ; i++)
+			{recv_n.get(i) *= sizeof(T);}
+
+			ret = dec.getNeighborExchange().exchange_known(prc_send,ptr,sz,recv_prc,recv_ptr,recv_n);
+		}
+		else
+		{ret = dec.getNeighborExchange().exchange(prc_send,ptr,sz,recv_prc,recv_ptr,recv_n);}
+
+		for (size_t i = 0 ; i < recv_n.size() ; i++)
+		{recv_n.get(i) /= sizeof(T);}
+
+		return ret;
+	}
+
+	/*! \brief Split the current labelling between the processors on the same node and the processors on other nodes
+	 *
+	 */
+	void ghost_node_shared_split()
+	{
+		nsh_on.clear();
+		g_opart_off.clear();
+		prc_g_opart_off.clear();
+		prc_sz_gg_off.clear();
+
+		for (size_t i = 0 ; i < prc_g_opart.size() ; i++)
+		{
+			if (nse.isOnNode(prc_g_opart.get(i)) == true)
+			{nsh_on.add(i);}
+			else
+			{
+				g_opart_off.add(g_opart.get(i));
+				prc_g_opart_off.add(prc_g_opart.get(i));
+				prc_sz_gg_off.add(prc_sz_gg.get(i));
+			}
+		}
+
+		nsh_valid = true;
+	}
+
+	/*! \brief From the receive list of the last ghost_get extract the processors on other nodes
+	 *
+	 * \param prc_recv processors we received ghost from
+	 * \param recv_sz number of particles received from each processor
+	 * \param prc_recv_off processors on other nodes
+	 * \param recv_sz_off number of particles received from each processor on other nodes
+	 *
+	 */
+	void ghost_node_shared_recv_off(openfpm::vector<size_t> & prc_recv,
+									openfpm::vector<size_t> & recv_sz,
+									openfpm::vector<size_t> & prc_recv_off,
+									openfpm::vector<size_t> & recv_sz_off)
+	{
+		prc_recv_off.clear();
+		recv_sz_off.clear();
+
+		for (size_t i = 0 ; i < prc_recv.size() ; i++)
+		{
+			if (nse.isOnNode(prc_recv.get(i)) == false)
+			{
+				prc_recv_off.add(prc_recv.get(i));
+				recv_sz_off.add(recv_sz.get(i));
+			}
+		}
+	}
+
+	/*! \brief It synchronize the properties and position of the ghost particles, the processors on the same
+	 *         node are read directly from their shared memory segment
+	 *
+	 * The ghost particles for a processor on the same node are packed (properties and shifted positions)
+	 * directly into our segment of an MPI-3 shared window, the processor copy them from our segment into
+	 * its ghost part. The processors on other nodes use the normal exchange. The ghost of the processors on
+	 * the same node come before the ones of the processors on other nodes
 	 *
 	 * \tparam prp list of properties to get synchronize
 	 *
-	 * \param opt options WITH_POSITION, it send also the positional information of the particles
 	 * \param v_pos vector of position to update
 	 * \param v_prp vector of properties to update
 	 * \param g_m marker between real and ghost particles
+	 * \param opt options
 	 *
 	 */
-	template<unsigned int impl, int ... prp> inline void ghost_get_(openfpm::vector<Point<dim, St>,Memory,layout_base> & v_pos,
-												 openfpm::vector<prop,Memory,layout_base> & v_prp,
-												 size_t & g_m,
-												 size_t opt = WITH_POSITION)
+	template<int ... prp> void ghost_get_node_shared_(openfpm::vector<Point<dim, St>,Memory,layout_base> & v_pos,
+													  openfpm::vector<prop,Memory,layout_base> & v_prp,
+													  size_t & g_m,
+													  size_t opt)
 	{
-#ifdef PROFILE_SCOREP
-		SCOREP_USER_REGION("ghost_get",SCOREP_USER_REGION_TYPE_FUNCTION)
-#endif
-
 		// Sending property object
 		typedef object<typename object_creator<typename prop::type, prp...>::type> prp_object;
 
 		// send vector for each processor
 		typedef openfpm::vector<prp_object,Memory,layout_base,openfpm::grow_policy_identity> send_vector;
 
+		// linear vector on the memory of a message
+		typedef openfpm::vector<prp_object,PtrMemory,memory_traits_lin,openfpm::grow_policy_identity> msg_vector;
+
+		bool with_prp = sizeof...(prp) != 0;
+		bool with_pos = !(opt & NO_POSITION);
+
+		nse.init();
+
 		if (!(opt & NO_POSITION))
 		{v_pos.resize(g_m);}
 
-		// reset the ghost part
-
 		if (!(opt & SKIP_LABELLING))
 		{v_prp.resize(g_m);}
 
-		// Label all the particles
 		if ((opt & SKIP_LABELLING) == false)
 		{labelParticlesGhost(v_pos,v_prp,prc_g_opart,prc_sz_gg,prc_offset,g_m,opt);}
 
-		{
-			// Send and receive ghost particle information
-			openfpm::vector<send_vector> g_send_prp;
-
-			fill_send_ghost_prp_buf<send_vector, prp_object, prp...>(v_prp,prc_sz_gg,g_send_prp,opt);
+		if ((opt & SKIP_LABELLING) == false || nsh_valid == false)
+		{ghost_node_shared_split();}
 
-	#if defined(CUDA_GPU) && defined(__NVCC__)
-			cudaDeviceSynchronize();
-	#endif
+		// reserve the messages for the processors on the node, every message contain
+		// the properties followed by the shifted positions
+		openfpm::vector<size_t> prc_on;
+		openfpm::vector<size_t> n_on;
+		openfpm::vector<size_t> sz_on;
+		openfpm::vector<unsigned char *> msg;
 
-			// if there are no properties skip
-			// SSendRecvP send everything when we do not give properties
+		for (size_t i = 0 ; i < nsh_on.size() ; i++)
+		{
+			size_t n = prc_sz_gg.get(nsh_on.get(i));
 
-			ghost_exchange_comm_impl<impl,layout_base,prp ...>::template
-			sendrecv_prp(v_cl,g_send_prp,v_prp,v_pos,prc_g_opart,
-					 prc_recv_get_prp,recv_sz_get_prp,recv_sz_get_byte,g_opart_sz,g_m,opt);
+			prc_on.add(prc_g_opart.get(nsh_on.get(i)));
+			n_on.add(n);
+			sz_on.add(node_shared_exchange::block_offset((with_prp)?n*sizeof(prp_object):0) + ((with_pos)?n*dim*sizeof(St):0));
 		}
 
-		if (!(opt & NO_POSITION))
-		{
+		nse.begin(prc_on,n_on,sz_on,msg);
+
+		// get the shift vectors
+		const openfpm::vector<Point<dim,St>,Memory,layout_base> & shifts = dec.getShiftVectors();
+
+		// pack directly in the shared segment
+		for (size_t i = 0 ; i < nsh_on.size() ; i++)
+		{
+			auto & gop = g_opart.get(nsh_on.get(i));
+			size_t n = n_on.get(i);
+
+			if (with_prp == true)
+			{
+				PtrMemory ptr(msg.get(i),n*sizeof(prp_object));
+
+				msg_vector send_v;
+				send_v.setMemory(ptr);
+				send_v.resize(n);
+
+				for (size_t j = 0 ; j < n ; j++)
+				{
+					size_t id = gop.template get<0>(j);
+
+					object_si_d<decltype(v_prp.get(id)),decltype(send_v.get(j)),OBJ_ENCAP,prp...>(v_prp.get(id),send_v.get(j));
+				}
+			}
+
+			if (with_pos == true)
+			{
+				St * pts = (St *)(msg.get(i) + node_shared_exchange::block_offset((with_prp)?n*sizeof(prp_object):0));
+
+				for (size_t j = 0 ; j < n ; j++)
+				{
+					Point<dim, St> s = v_pos.get(gop.template get<0>(j));
+					s -= shifts.get(gop.template get<1>(j));
+
+					for (size_t d = 0 ; d < dim ; d++)
+					{pts[j*dim+d] = s.get(d);}
+				}
+			}
+		}
+
+		openfpm::vector<size_t> prc_recv_on;
+		openfpm::vector<const unsigned char *> recv_msg;
+		openfpm::vector<size_t> recv_n_on;
+
+		nse.publish(prc_recv_on,recv_msg,recv_n_on);
+
+		// copy from the segments of the other processors of the node into the ghost part
+		size_t k = g_m;
+		for (size_t i = 0 ; i < prc_recv_on.size() ; i++)
+		{
+			size_t n = recv_n_on.get(i);
+
+			if (with_prp == true)
+			{
+				PtrMemory ptr(const_cast<unsigned char *>(recv_msg.get(i)),n*sizeof(prp_object));
+
+				msg_vector recv_v;
+				recv_v.setMemory(ptr);
+				recv_v.resize(n);
+
+				for (size_t j = 0 ; j < n ; j++)
+				{
+					if (!(opt & SKIP_LABELLING))
+					{v_prp.add();}
+
+					object_s_di<decltype(recv_v.get(j)),decltype(v_prp.get(k+j)),OBJ_ENCAP,prp...>(recv_v.get(j),v_prp.get(k+j));
+				}
+			}
+
+			if (with_pos == true)
+			{
+				const St * pts = (const St *)(recv_msg.get(i) + node_shared_exchange::block_offset((with_prp)?n*sizeof(prp_object):0));
+
+				for (size_t j = 0 ; j < n ; j++)
+				{
+					v_pos.add();
+
+					for (size_t d = 0 ; d < dim ; d++)
+					{v_pos.template get<0>(v_pos.size()-1)[d] = pts[j*dim+d];}
+				}
+			}
+
+			k += n;
+		}
+
+		// the processors on other nodes use the normal exchange
+		openfpm::vector<size_t> prc_recv_get_prp_off;
+		openfpm::vector<size_t> recv_sz_get_prp_off;
+		openfpm::vector<size_t> prc_recv_get_pos_off;
+		openfpm::vector<size_t> recv_sz_get_pos_off;
+		openfpm::vector<size_t> g_opart_sz_off;
+
+		if (opt & SKIP_LABELLING)
+		{
+			ghost_node_shared_recv_off(prc_recv_get_prp,recv_sz_get_prp,prc_recv_get_prp_off,recv_sz_get_prp_off);
+			ghost_node_shared_recv_off(prc_recv_get_pos,recv_sz_get_pos,prc_recv_get_pos_off,recv_sz_get_pos_off);
+		}
+
+		// the fill functions pack g_opart
+		g_opart.swap(g_opart_off);
+
+		if (with_prp == true)
+		{
+			openfpm::vector<send_vector> g_send_prp;
+
+			fill_send_ghost_prp_buf<send_vector, prp_object, prp...>(v_prp,prc_sz_gg_off,g_send_prp,opt);
+
+			ghost_exchange_comm_impl<GHOST_SYNC,layout_base,prp ...>::template
+			sendrecv_prp(v_cl,g_send_prp,v_prp,v_pos,prc_g_opart_off,
+					 prc_recv_get_prp_off,recv_sz_get_prp_off,recv_sz_get_byte,g_opart_sz_off,k,opt);
+		}
+
+		if (with_pos == true)
+		{
+			openfpm::vector<send_pos_vector> g_pos_send;
+
+			fill_send_ghost_pos_buf(v_pos,prc_sz_gg_off,g_pos_send,opt,false);
+
+			ghost_exchange_comm_impl<GHOST_SYNC,layout_base,prp ...>::template
+			sendrecv_pos(v_cl,g_pos_send,v_prp,v_pos,prc_recv_get_pos_off,recv_sz_get_pos_off,prc_g_opart_off,opt);
+		}
+
+		g_opart.swap(g_opart_off);
+
+		// receive list of the whole ghost, processors on the node first
+		if (with_prp == true)
+		{
+			prc_recv_get_prp = prc_recv_on;
+			recv_sz_get_prp = recv_n_on;
+
+			for (size_t i = 0 ; i < prc_recv_get_prp_off.size() ; i++)
+			{
+				prc_recv_get_prp.add(prc_recv_get_prp_off.get(i));
+				recv_sz_get_prp.add(recv_sz_get_prp_off.get(i));
+			}
+		}
+
+		if (with_pos == true)
+		{
+			prc_recv_get_pos = prc_recv_on;
+			recv_sz_get_pos = recv_n_on;
+
+			for (size_t i = 0 ; i < prc_recv_get_pos_off.size() ; i++)
+			{
+				prc_recv_get_pos.add(prc_recv_get_pos_off.get(i));
+				recv_sz_get_pos.add(recv_sz_get_pos_off.get(i));
+			}
+		}
+
+		// fill g_opart_sz
+		g_opart_sz.resize(prc_g_opart.size());
+
+		for (size_t i = 0 ; i < prc_g_opart.size() ; i++)
+		{g_opart_sz.get(i) = prc_sz_gg.get(i);}
+
+		if (!(opt & SKIP_LABELLING))
+		{v_prp.resize(v_pos.size());}
+
+		add_loc_particles_bc(v_pos,v_prp,g_m,opt);
+	}
+
+	/*! \brief It synchronize the properties and position of the ghost particles with neighborhood collectives
+	 *
+	 * The ghost particles are exchanged on the graph communicator of the near processors created from the
+	 * decomposition, without the NBX handshake. With SKIP_LABELLING | NO_CHANGE_ELEMENTS the number of
+	 * particles received from each processor is the one of the previous ghost_get and is not exchanged
+	 *
+	 * \tparam prp list of properties to get synchronize
+	 *
+	 * \param v_pos vector of position to update
+	 * \param v_prp vector of properties to update
+	 * \param g_m marker between real and ghost particles
+	 * \param opt options
+	 *
+	 */
+	template<int ... prp> void ghost_get_nn_coll_(openfpm::vector<Point<dim, St>,Memory,layout_base> & v_pos,
+												  openfpm::vector<prop,Memory,layout_base> & v_prp,
+												  size_t & g_m,
+												  size_t opt)
+	{
+		// Sending property object
+		typedef object<typename object_creator<typename prop::type, prp...>::type> prp_object;
+
+		// send vector for each processor
+		typedef openfpm::vector<prp_object,Memory,layout_base,openfpm::grow_policy_identity> send_vector;
+
+		bool known = (opt & SKIP_LABELLING) && (opt & NO_CHANGE_ELEMENTS);
+
+		if (!(opt & NO_POSITION))
+		{v_pos.resize(g_m);}
+
+		if (!(opt & SKIP_LABELLING))
+		{v_prp.resize(g_m);}
+
+		if ((opt & SKIP_LABELLING) == false)
+		{labelParticlesGhost(v_pos,v_prp,prc_g_opart,prc_sz_gg,prc_offset,g_m,opt);}
+
+		openfpm::vector<const void *> recv_ptr;
+
+		if (sizeof...(prp) != 0)
+		{
+			openfpm::vector<send_vector> g_send_prp;
+
+			fill_send_ghost_prp_buf<send_vector, prp_object, prp...>(v_prp,prc_sz_gg,g_send_prp,opt);
+
+			nn_coll_sendrecv<prp_object>(g_send_prp,prc_g_opart,prc_recv_get_prp,recv_ptr,recv_sz_get_prp,known);
+
+			// copy the received properties in the ghost part
+			size_t k = g_m;
+			for (size_t i = 0 ; i < prc_recv_get_prp.size() ; i++)
+			{
+				PtrMemory ptr(const_cast<void *>(recv_ptr.get(i)),recv_sz_get_prp.get(i)*sizeof(prp_object));
+
+				// the send buffers are packed with a linear layout
+				openfpm::vector<prp_object,PtrMemory,memory_traits_lin,openfpm::grow_policy_identity> recv_v;
+				recv_v.setMemory(ptr);
+				recv_v.resize(recv_sz_get_prp.get(i));
+
+				for (size_t j = 0 ; j < recv_v.size() ; j++, k++)
+				{
+					if (!(opt & SKIP_LABELLING))
+					{v_prp.add();}
+
+					object_s_di<decltype(recv_v.get(j)),decltype(v_prp.get(k)),OBJ_ENCAP,prp...>(recv_v.get(j),v_prp.get(k));
+				}
+			}
+		}
+
+		if (!(opt & NO_POSITION))
+		{
+			openfpm::vector<send_pos_vector> g_pos_send;
+
+			fill_send_ghost_pos_buf(v_pos,prc_sz_gg,g_pos_send,opt,false);
+
+			nn_coll_sendrecv<Point<dim,St>>(g_pos_send,prc_g_opart,prc_recv_get_pos,recv_ptr,recv_sz_get_pos,known);
+
+			// copy the received positions in the ghost part
+			for (size_t i = 0 ; i < prc_recv_get_pos.size() ; i++)
+			{
+				const St * pts = (const St *)recv_ptr.get(i);
+
+				for (size_t j = 0 ; j < recv_sz_get_pos.get(i) ; j++)
+				{
+					v_pos.add();
+
+					for (size_t d = 0 ; d < dim ; d++)
+					{v_pos.template get<0>(v_pos.size()-1)[d] = pts[j*dim+d];}
+				}
+			}
+		}
+
+		// fill g_opart_sz
+		g_opart_sz.resize(prc_g_opart.size());
+
+		for (size_t i = 0 ; i < prc_g_opart.size() ; i++)
+		{g_opart_sz.get(i) = prc_sz_gg.get(i);}
+
+		if (!(opt & SKIP_LABELLING))
+		{v_prp.resize(v_pos.size());}
+
+		add_loc_particles_bc(v_pos,v_prp,g_m,opt);
+	}
+
+	/*! \brief Send back the ghost particles and merge them with neighborhood collectives
+	 *
+	 * With NO_CHANGE_ELEMENTS the number of particles received from each processor is the number of
+	 * particles sent in the last ghost_get and is not exchanged
+	 *
+	 * \tparam op operation to apply
+	 * \tparam send_vector type of the send buffers
+	 * \tparam prp_object object containing the properties to merge
+	 * \tparam prp set of properties
+	 *
+	 * \param g_send_prp send buffers (one for each processor we received ghost from)
+	 * \param v_prp vector of particle properties
+	 * \param opt options
+	 *
+	 */
+	template<template<typename,typename> class op, typename send_vector, typename prp_object, int ... prp>
+	void ghost_put_nn_coll_(openfpm::vector<send_vector> & g_send_prp,
+							openfpm::vector<prop,Memory,layout_base> & v_prp,
+							size_t opt)
+	{
+		openfpm::vector<size_t> recv_prc;
+		openfpm::vector<const void *> recv_ptr;
+		openfpm::vector<size_t> recv_n;
+
+		bool known = (opt & NO_CHANGE_ELEMENTS) != 0;
+
+		if (known == true)
+		{
+			recv_prc = prc_g_opart;
+			recv_n = g_opart_sz;
+		}
+
+		nn_coll_sendrecv<prp_object>(g_send_prp,get_last_ghost_get_num_proc_vector(),recv_prc,recv_ptr,recv_n,known);
+
+		for (size_t i = 0 ; i < recv_prc.size() ; i++)
+		{
+			// the particles come back in the order we sent them
+			size_t k = 0;
+			while (k < prc_g_opart.size() && prc_g_opart.get(k) != recv_prc.get(i))
+			{k++;}
+
+			if (k == prc_g_opart.size())
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " Error ghost_put received particles from processor " << recv_prc.get(i) << " that did not received ghost particles" << std::endl;
+				continue;
+			}
+
+			PtrMemory ptr(const_cast<void *>(recv_ptr.get(i)),recv_n.get(i)*sizeof(prp_object));
+
+			openfpm::vector<prp_object,PtrMemory,memory_traits_lin,openfpm::grow_policy_identity> recv_v;
+			recv_v.setMemory(ptr);
+			recv_v.resize(recv_n.get(i));
+
+			for (size_t j = 0 ; j < recv_v.size() ; j++)
+			{
+				size_t id = g_opart.get(k).template get<0>(j);
+
+				object_s_di_op<op,decltype(recv_v.get(j)),decltype(v_prp.get(id)),OBJ_ENCAP,prp...>(recv_v.get(j),v_prp.get(id));
+			}
+		}
+	}
+
+	/*! \brief Send the migrating particles to the near processors with neighborhood collectives (map with MAP_LOCAL)
+	 *
+	 * The caller must have checked on every processor that all the destinations are in the neighborhood
+	 *
+	 * \param v_pos vector of particle positions
+	 * \param v_prp vector of particle properties
+	 * \param m_pos positions to send (one vector for each processor in prc_r)
+	 * \param m_prp properties to send (one vector for each processor in prc_r)
+	 * \param prc_r processors to send
+	 *
+	 */
+	template<typename m_pos_type, typename m_prp_type>
+	void map_nn_coll_(openfpm::vector<Point<dim, St>,Memory,layout_base> & v_pos,
+					  openfpm::vector<prop,Memory,layout_base> & v_prp,
+					  openfpm::vector<m_pos_type> & m_pos,
+					  openfpm::vector<m_prp_type> & m_prp,
+					  openfpm::vector<size_t> & prc_r)
+	{
+		openfpm::vector<const void *> recv_ptr;
+
+		if (nn_coll_sendrecv<Point<dim,St>>(m_pos,prc_r,prc_recv_map,recv_ptr,recv_sz_map,false) == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error map with MAP_LOCAL, some particles moved further than the near processors and has been lost" << std::endl;
+			ACTION_ON_ERROR(NEIGHBOR_EXCHANGE_ERROR_OBJECT);
+		}
+
+		for (size_t i = 0 ; i < prc_recv_map.size() ; i++)
+		{
+			const St * pts = (const St *)recv_ptr.get(i);
+
+			for (size_t j = 0 ; j < recv_sz_map.get(i) ; j++)
+			{
+				v_pos.add();
+
+				for (size_t d = 0 ; d < dim ; d++)
+				{v_pos.template get<0>(v_pos.size()-1)[d] = pts[j*dim+d];}
+			}
+		}
+
+		nn_coll_sendrecv<prop>(m_prp,prc_r,prc_recv_map,recv_ptr,recv_sz_map,false);
+
+		for (size_t i = 0 ; i < prc_recv_map.size() ; i++)
+		{
+			PtrMemory ptr(const_cast<void *>(recv_ptr.get(i)),recv_sz_map.get(i)*sizeof(prop));
+
+			openfpm::vector<prop,PtrMemory,memory_traits_lin,openfpm::grow_policy_identity> recv_v;
+			recv_v.setMemory(ptr);
+			recv_v.resize(recv_sz_map.get(i));
+
+			for (size_t j = 0 ; j < recv_v.size() ; j++)
+			{
+				v_prp.add();
+				v_prp.set(v_prp.size()-1,recv_v.get(j));
+			}
+		}
+	}
+
+	/*! \brief Exchange the ghost properties directly from and into v_prp (GHOST_ZERO_COPY)
+	 *
+	 * The ghost layout must be known from a previous ghost_get (SKIP_LABELLING). The decision is collective:
+	 * if on one processor the layout does not match the ghost part, every processor use the buffered exchange.
+	 * It is taken once for every labelling, at the first zero copy ghost_get after it
+	 *
+	 * \tparam prp properties to exchange
+	 *
+	 * \param v_prp vector of particle properties
+	 * \param g_m ghost marker
+	 *
+	 * \return true if the properties has been exchanged
+	 *
+	 */
+	template<int ... prp> bool ghost_get_zero_copy_prp(openfpm::vector<prop,Memory,layout_base> & v_prp, size_t g_m)
+	{
+		if (zc_ok == -1)
+		{
+			size_t n_recv = 0;
+			for (size_t i = 0 ; i < recv_sz_get_prp.size() ; i++)
+			{n_recv += recv_sz_get_prp.get(i);}
+
+			size_t ok = recv_sz_get_prp.size() == prc_recv_get_prp.size() &&
+						g_opart.size() == prc_g_opart.size() &&
+						g_m + n_recv <= v_prp.size();
+
+			v_cl.min(ok);
+			v_cl.execute();
+
+			zc_ok = (ok != 0);
+		}
+
+		if (zc_ok == 0)
+		{return false;}
+
+		zc.init();
+
+		n_zero_copy++;
+
+		if (v_prp.size() == 0)
+		{return true;}
+
+		ghost_zc_base<openfpm::vector<prop,Memory,layout_base>> zb(v_prp);
+		boost::mpl::for_each_ref<boost::mpl::range_c<int,0,prop::max_prop>>(zb);
+
+		openfpm::vector<std::pair<size_t,size_t>> blocks;
+		int dummy[] = {0, (blocks.add(std::pair<size_t,size_t>((char *)&v_prp.template get<prp>(0) - zb.base,sizeof(v_prp.template get<prp>(0)))), 0)...};
+		(void)dummy;
+
+		zc.exchange(zb.base,sizeof(typename prop::type),blocks,prc_g_opart,g_opart,prc_recv_get_prp,recv_sz_get_prp,g_m);
+
+		return true;
+	}
+
+	/*! \brief It synchronize the properties and position of the ghost particles
+	 *
+	 * \tparam prp list of properties to get synchronize
+	 *
+	 * \param opt options WITH_POSITION, it send also the positional information of the particles
+	 * \param v_pos vector of position to update
+	 * \param v_prp vector of properties to update
+	 * \param g_m marker between real and ghost particles
+	 * \param rcut send only the particles at distance smaller than rcut from the other sub-domains
+	 *        (0 the full ghost)
+	 *
+	 */
+	template<unsigned int impl, int ... prp> inline void ghost_get_(openfpm::vector<Point<dim, St>,Memory,layout_base> & v_pos,
+												 openfpm::vector<prop,Memory,layout_base> & v_prp,
+												 size_t & g_m,
+												 size_t opt = WITH_POSITION,
+												 St rcut = 0)
+	{
+#ifdef PROFILE_SCOREP
+		SCOREP_USER_REGION("ghost_get",SCOREP_USER_REGION_TYPE_FUNCTION)
+#endif
+
+		// Sending property object
+		typedef object<typename object_creator<typename prop::type, prp...>::type> prp_object;
+
+		// send vector for each processor
+		typedef openfpm::vector<prp_object,Memory,layout_base,openfpm::grow_policy_identity> send_vector;
+
+		// select the labelling of the cutoff
+		ghost_rcut_select(rcut,v_prp,g_m,opt);
+
+		if ((opt & GHOST_NODE_SHARED) && !(opt & NEIGHBOR_COLLECTIVE))
+		{
+			if (impl == GHOST_SYNC && !(opt & RUN_ON_DEVICE) && is_layout_inte<layout_base<prop>>::value == false)
+			{
+				ghost_get_node_shared_<prp...>(v_pos,v_prp,g_m,opt);
+
+				if (!(opt & SKIP_LABELLING))
+				{
+					ghost_rcut_record(v_prp,g_m,true);
+
+					zc_ok = -1;
+					zc.reset();
+				}
+
+				return;
+			}
+
+			std::cerr << __FILE__ << ":" << __LINE__ << " Warning GHOST_NODE_SHARED require a synchronous ghost_get on CPU with linear layout, the NBX exchange is used instead" << std::endl;
+		}
+
+		if (opt & NEIGHBOR_COLLECTIVE)
+		{
+			if (impl == GHOST_SYNC && !(opt & RUN_ON_DEVICE) && is_layout_inte<layout_base<prop>>::value == false)
+			{
+				ghost_get_nn_coll_<prp...>(v_pos,v_prp,g_m,opt);
+
+				if (!(opt & SKIP_LABELLING))
+				{
+					ghost_rcut_record(v_prp,g_m,true);
+
+					zc_ok = -1;
+					zc.reset();
+				}
+
+				return;
+			}
+
+			std::cerr << __FILE__ << ":" << __LINE__ << " Warning NEIGHBOR_COLLECTIVE require a synchronous ghost_get on CPU with linear layout, the NBX exchange is used instead" << std::endl;
+		}
+
+		if (!(opt & NO_POSITION))
+		{v_pos.resize(g_m);}
+
+		// reset the ghost part
+
+		if (!(opt & SKIP_LABELLING))
+		{v_prp.resize(g_m);}
+
+		// Label all the particles
+		if ((opt & SKIP_LABELLING) == false)
+		{labelParticlesGhost(v_pos,v_prp,prc_g_opart,prc_sz_gg,prc_offset,g_m,opt);}
+
+		// with a known ghost layout the properties can be exchanged without buffers
+		bool zero_copy = (opt & GHOST_ZERO_COPY) && (opt & SKIP_LABELLING) && impl == GHOST_SYNC &&
+						 !(opt & RUN_ON_DEVICE) && sizeof...(prp) != 0 &&
+						 is_layout_inte<layout_base<prop>>::value == false &&
+						 std::is_same<Memory,HeapMemory>::value == true &&
+						 prop::noPointers() == true;
+
+		if (zero_copy == true)
+		{zero_copy = ghost_get_zero_copy_prp<prp...>(v_prp,g_m);}
+
+		if (zero_copy == false)
+		{
+			// Send and receive ghost particle information
+			openfpm::vector<send_vector> g_send_prp;
+
+			fill_send_ghost_prp_buf<send_vector, prp_object, prp...>(v_prp,prc_sz_gg,g_send_prp,opt);
+
+	#if defined(CUDA_GPU) && defined(__NVCC__)
+			cudaDeviceSynchronize();
+	#endif
+
+			// if there are no properties skip
+			// SSendRecvP send everything when we do not give properties
+
+			ghost_exchange_comm_impl<impl,layout_base,prp ...>::template
+			sendrecv_prp(v_cl,g_send_prp,v_prp,v_pos,prc_g_opart,
+					 prc_recv_get_prp,recv_sz_get_prp,recv_sz_get_byte,g_opart_sz,g_m,opt);
+		}
+
+		if (!(opt & NO_POSITION))
+		{
 			// Sending buffer for the ghost particles position
 			openfpm::vector<send_pos_vector> g_pos_send;
 
@@ -1850,6 +2940,15 @@ public:
         }
 
 		add_loc_particles_bc(v_pos,v_prp,g_m,opt);
+
+		if (!(opt & SKIP_LABELLING))
+		{
+			ghost_rcut_record(v_prp,g_m,impl == GHOST_SYNC);
+
+			// the zero copy exchange is decided again on the new layout
+			zc_ok = -1;
+			zc.reset();
+		}
 	}
 
 	/*! \brief It synchronize the properties and position of the ghost particles
@@ -1919,6 +3018,9 @@ public:
 		v_pos.resize(g_m);
 		v_prp.resize(g_m);
 
+		// the labelling of the ghost_get are not valid anymore
+		ghost_rcut_reset();
+
 		// m_opart, Contain the processor id of each particle (basically where they have to go)
 		labelParticleProcessor<obp>(v_pos,m_opart, prc_sz,opt);
 
@@ -1963,6 +3065,7 @@ public:
 		// mark the ghost part
 
 		g_m = v_pos.size();
+		virt_img = false;
 	}
 
 	/*! \brief It move all the particles that does not belong to the local processor to the respective processor
@@ -1993,6 +3096,9 @@ public:
 		v_pos.resize(g_m);
 		v_prp.resize(g_m);
 
+		// the labelling of the ghost_get are not valid anymore
+		ghost_rcut_reset();
+
 		// Contain the processor id of each particle (basically where they have to go)
 		labelParticleProcessor<obp>(v_pos,m_opart, prc_sz,opt);
 
@@ -2010,6 +3116,34 @@ public:
 
 		fill_send_map_buf(v_pos,v_prp, prc_sz_r,prc_r, m_pos, m_prp,prc_sz,opt);
 
+		// the particles move only to the near processors
+		if ((opt & NEIGHBOR_COLLECTIVE) && (opt & MAP_LOCAL) && !(opt & RUN_ON_DEVICE) &&
+			is_layout_inte<layout_base<prop>>::value == false && prop::noPointers() == true)
+		{
+			// every processor must send only to its neighborhood, otherwise the NBX exchange is used
+			size_t nn_ok = 1;
+			for (size_t i = 0 ; i < prc_r.size() ; i++)
+			{
+				if (m_pos.get(i).size() != 0 && dec.getNeighborExchange().isNeighbor(prc_r.get(i)) == false)
+				{nn_ok = 0;}
+			}
+
+			if (nn_ok == 0)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " Warning map with MAP_LOCAL | NEIGHBOR_COLLECTIVE, some particles moved further than the near processors, the NBX exchange is used" << std::endl;}
+
+			v_cl.min(nn_ok);
+			v_cl.execute();
+
+			if (nn_ok == 1)
+			{
+				map_nn_coll_(v_pos,v_prp,m_pos,m_prp,prc_r);
+
+				g_m = v_pos.size();
+				virt_img = false;
+				return;
+			}
+		}
+
 		size_t opt_ = 0;
 		if (opt & RUN_ON_DEVICE)
 		{
@@ -2035,6 +3169,161 @@ public:
 		// mark the ghost part
 
 		g_m = v_pos.size();
+		virt_img = false;
+	}
+
+	/*! \brief Start to move the particles that does not belong to the local processor to the respective processor
+	 *
+	 * The particles that migrate are removed and sent, the particles that stay are compacted at the beginning
+	 * of the vector and can be used until map_wait_. The received particles are appended in map_wait_
+	 *
+	 * \tparam out of bound policy it specify what to do when the particles are detected out of bound
+	 *
+	 * \param v_pos vector of particle positions
+	 * \param v_prp vector of particle properties
+	 * \param g_m ghost marker
+	 * \param opt options
+	 *
+	 */
+	template<typename obp = KillParticle>
+	void Imap_(openfpm::vector<Point<dim, St>,Memory,layout_base> & v_pos,
+			   openfpm::vector<prop,Memory,layout_base> & v_prp, size_t & g_m,
+			   size_t opt)
+	{
+		if (map_async == true)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error Imap has been called without map_wait for the previous Imap" << std::endl;
+			return;
+		}
+
+		// the exchange on device is done synchronously
+		if (opt & RUN_ON_DEVICE)
+		{
+			map_<obp>(v_pos,v_prp,g_m,opt);
+			return;
+		}
+
+		prc_sz.resize(v_cl.getProcessingUnits());
+
+		// map completely reset the ghost part
+		v_pos.resize(g_m);
+		v_prp.resize(g_m);
+
+		// the labelling of the ghost_get are not valid anymore
+		ghost_rcut_reset();
+
+		// Contain the processor id of each particle (basically where they have to go)
+		labelParticleProcessor<obp>(v_pos,m_opart, prc_sz,opt);
+
+		openfpm::vector<size_t> prc_sz_r;
+
+		calc_send_buffers(prc_sz,prc_sz_r,map_prc_r,opt);
+
+		fill_send_map_buf(v_pos,v_prp, prc_sz_r,map_prc_r, map_m_pos, map_m_prp,prc_sz,opt);
+
+		map_recv_pos.clear();
+		map_recv_prp.clear();
+
+		v_cl.template SSendRecvAsync<openfpm::vector<Point<dim, St>,Memory,layout_base,openfpm::grow_policy_identity>,
+					   openfpm::vector<Point<dim, St>,Memory,layout_base>,
+					   layout_base>
+					   (map_m_pos,map_recv_pos,map_prc_r,prc_recv_map,recv_sz_map,0);
+
+		v_cl.template SSendRecvAsync<openfpm::vector<prop,Memory,layout_base,openfpm::grow_policy_identity>,
+					   openfpm::vector<prop,Memory,layout_base>,
+					   layout_base>
+					   (map_m_prp,map_recv_prp,map_prc_r,prc_recv_map,recv_sz_map,0);
+
+		// only the particles that stay are local for now
+		g_m = v_pos.size();
+
+		map_async = true;
+	}
+
+	/*! \brief Complete the migration started with Imap_ and append the received particles
+	 *
+	 * \param v_pos vector of particle positions
+	 * \param v_prp vector of particle properties
+	 * \param g_m ghost marker
+	 * \param opt options
+	 *
+	 */
+	void map_wait_(openfpm::vector<Point<dim, St>,Memory,layout_base> & v_pos,
+				   openfpm::vector<prop,Memory,layout_base> & v_prp, size_t & g_m,
+				   size_t opt)
+	{
+		if (map_async == false)
+		{return;}
+
+		v_cl.template SSendRecvWait<openfpm::vector<Point<dim, St>,Memory,layout_base,openfpm::grow_policy_identity>,
+					   openfpm::vector<Point<dim, St>,Memory,layout_base>,
+					   layout_base>
+					   (map_m_pos,map_recv_pos,map_prc_r,prc_recv_map,recv_sz_map,0);
+
+		v_cl.template SSendRecvWait<openfpm::vector<prop,Memory,layout_base,openfpm::grow_policy_identity>,
+					   openfpm::vector<prop,Memory,layout_base>,
+					   layout_base>
+					   (map_m_prp,map_recv_prp,map_prc_r,prc_recv_map,recv_sz_map,0);
+
+		// anything added between Imap_ and map_wait_ is not a real particle
+		v_pos.resize(g_m);
+		v_prp.resize(g_m);
+
+		v_pos.add(map_recv_pos);
+		v_prp.add(map_recv_prp);
+
+		map_recv_pos.clear();
+		map_recv_prp.clear();
+
+		// mark the ghost part
+
+		g_m = v_pos.size();
+		virt_img = false;
+
+		map_async = false;
+	}
+
+	/*! \brief Return true if the local periodic images of the last ghost_get are virtual
+	 *
+	 * map remove the ghost and the virtual images with it
+	 *
+	 * \return true if ghost_get has been called with GHOST_VIRTUAL_PERIODIC
+	 *
+	 */
+	bool isVirtualPeriodic() const
+	{
+		return virt_img;
+	}
+
+	/*! \brief Number of ghost_get that exchanged the properties without buffers (GHOST_ZERO_COPY)
+	 *
+	 * \return the number of zero copy ghost_get
+	 *
+	 */
+	size_t getGhostZeroCopyCount() const
+	{
+		return n_zero_copy;
+	}
+
+	/*! \brief Drop the virtual periodic images, to be called when the ghost is removed
+	 *
+	 */
+	void resetVirtualPeriodic()
+	{
+		virt_img = false;
+	}
+
+	/*! \brief Get the local periodic images
+	 *
+	 * For each image the source particle (property 0) and the id of the shift vector (property 1) of the
+	 * decomposition, the image is in the position of the source minus the shift
+	 *
+	 * \return the local periodic images
+	 *
+	 */
+	const openfpm::vector<aggregate<unsigned int,unsigned int>,Memory,layout_base> & getVirtualImages() const
+	{
+		return o_part_loc;
 	}
 
 	/*! \brief Get the decomposition
@@ -2121,8 +3410,14 @@ public:
 #endif
 		}
 
+		bool nn_coll = (opt & NEIGHBOR_COLLECTIVE) && !(opt & RUN_ON_DEVICE) && is_layout_inte<layout_base<prop>>::value == false;
+
 		// Send and receive ghost particle information
-		if (opt & NO_CHANGE_ELEMENTS)
+		if (nn_coll == true)
+		{
+			ghost_put_nn_coll_<op,send_vector,prp_object,prp...>(g_send_prp,v_prp,opt);
+		}
+		else if (opt & NO_CHANGE_ELEMENTS)
 		{
 			size_t opt_ = compute_options(opt);
 
@@ -2169,7 +3464,11 @@ public:
 			}
 		}
 
-		// process also the local replicated particles
+		// process also the local replicated particles, virtual images has been written directly
+		// into their source particles
+
+		if (virt_img == true)
+		{return;}
 
 		if (lg_m < v_prp.size() && v_prp.size() - lg_m != o_part_loc.size())
 		{
@@ -0,0 +1,276 @@
+#
+# openfpm.py
+#
+#  Created on: Oct 18, 2026
+#      Author: i-bird
+#
+# Python interface of openfpm_pdata. Positions, properties and local grids are numpy arrays that
+# point to the memory of the distributed structures (no copy). An array is valid until the
+# structure is resized (add, map, ghost_get), after that the array must be requested again
+#
+#   import openfpm
+#
+#   openfpm.init()
+#   vd = openfpm.VectorDist(3, 4096, [0.0]*3, [1.0]*3, [1]*3, 0.1)
+#   x = vd.pos()        # (size_local_with_ghost, 3)
+#   rho = vd.prop(0)    # (size_local_with_ghost,)
+#   rho[:vd.size_local()] = 1.0
+#   vd.ghost_get()
+#
+# Structures of a C++ program are exposed with py_register_vector_dist / py_register_grid_dist
+# (see pdata_python.hpp), the handle returned is wrapped with VectorDist.from_handle(h) or
+# GridDist.from_handle(h). The type of the numpy arrays follows the type of the properties
+#
+
+import ctypes
+import os
+
+import numpy as np
+
+PY_VIEW_MAX_DIM = 4
+
+
+class _View(ctypes.Structure):
+    _fields_ = [("ptr", ctypes.c_void_p),
+                ("dtype", ctypes.c_int),
+                ("ndim", ctypes.c_int),
+                ("shape", ctypes.c_size_t * PY_VIEW_MAX_DIM),
+                ("strides", ctypes.c_long * PY_VIEW_MAX_DIM)]
+
+
+# numpy type of the py_dtype codes
+_DTYPE = {0: np.float64, 1: np.float32, 2: np.intc, 3: np.int_, 4: np.uintp}
+
+
+def _load():
+    name = os.environ.get("OPENFPM_PYTHON_LIB", "libofpm_pdata_python.so")
+    if not os.path.isabs(name):
+        local = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "lib", name)
+        if os.path.exists(local):
+            name = local
+
+    lib = ctypes.CDLL(name, mode=ctypes.RTLD_GLOBAL)
+
+    d_p = ctypes.POINTER(ctypes.c_double)
+    i_p = ctypes.POINTER(ctypes.c_int)
+    s_p = ctypes.POINTER(ctypes.c_size_t)
+    l_p = ctypes.POINTER(ctypes.c_long)
+    v_p = ctypes.POINTER(_View)
+    h = ctypes.c_void_p
+
+    sig = {
+        "ofp_init": (None, []),
+        "ofp_finalize": (None, []),
+        "ofp_rank": (ctypes.c_int, []),
+        "ofp_n_proc": (ctypes.c_int, []),
+        "ofp_vector_dist_create": (h, [ctypes.c_int, ctypes.c_size_t, d_p, d_p, i_p, ctypes.c_double]),
+        "ofp_vector_dist_delete": (None, [h]),
+        "ofp_vector_dist_dim": (ctypes.c_int, [h]),
+        "ofp_vector_dist_n_prop": (ctypes.c_int, [h]),
+        "ofp_vector_dist_size_local": (ctypes.c_size_t, [h]),
+        "ofp_vector_dist_size_local_with_ghost": (ctypes.c_size_t, [h]),
+        "ofp_vector_dist_add": (ctypes.c_int, [h, d_p, ctypes.c_size_t]),
+        "ofp_vector_dist_map": (ctypes.c_int, [h]),
+        "ofp_vector_dist_ghost_get": (ctypes.c_int, [h, ctypes.c_int]),
+        "ofp_vector_dist_pos_view": (ctypes.c_int, [h, v_p]),
+        "ofp_vector_dist_prop_view": (ctypes.c_int, [h, ctypes.c_int, v_p]),
+        "ofp_vector_dist_cell_list": (ctypes.c_size_t, [h, ctypes.c_double, v_p, v_p]),
+        "ofp_vector_dist_write": (ctypes.c_int, [h, ctypes.c_char_p]),
+        "ofp_grid_dist_create": (h, [ctypes.c_int, s_p, d_p, d_p, i_p, ctypes.c_long]),
+        "ofp_grid_dist_delete": (None, [h]),
+        "ofp_grid_dist_dim": (ctypes.c_int, [h]),
+        "ofp_grid_dist_n_prop": (ctypes.c_int, [h]),
+        "ofp_grid_dist_n_loc_grid": (ctypes.c_size_t, [h]),
+        "ofp_grid_dist_loc_grid_view": (ctypes.c_int, [h, ctypes.c_size_t, ctypes.c_int, v_p]),
+        "ofp_grid_dist_loc_grid_domain": (ctypes.c_int, [h, ctypes.c_size_t, l_p, l_p, l_p]),
+        "ofp_grid_dist_ghost_get": (ctypes.c_int, [h]),
+        "ofp_grid_dist_map": (ctypes.c_int, [h]),
+        "ofp_grid_dist_write": (ctypes.c_int, [h, ctypes.c_char_p]),
+    }
+
+    for f, (res, args) in sig.items():
+        fn = getattr(lib, f)
+        fn.restype = res
+        fn.argtypes = args
+
+    return lib
+
+
+_lib = _load()
+
+
+def _array(values, ctype, n):
+    if len(values) != n:
+        raise ValueError("expected %d values, got %d" % (n, len(values)))
+    return (ctype * n)(*values)
+
+
+def _numpy(v):
+    """Wrap a view into a numpy array without copy"""
+    if v.dtype not in _DTYPE:
+        raise TypeError("openfpm: property type not supported")
+    dtype = _DTYPE[v.dtype]
+
+    shape = tuple(v.shape[i] for i in range(v.ndim))
+    strides = tuple(v.strides[i] for i in range(v.ndim))
+
+    if not v.ptr:
+        return np.zeros(shape, dtype=dtype)
+
+    size = 0
+    lo = 0
+    for s, st in zip(shape, strides):
+        if st >= 0:
+            size += (s - 1) * st
+        else:
+            lo += (s - 1) * st
+    size += np.dtype(dtype).itemsize - lo
+
+    buf = (ctypes.c_char * size).from_address(v.ptr + lo)
+    return np.ndarray(shape, dtype=dtype, buffer=buf, offset=-lo, strides=strides)
+
+
+def _check(ret, what):
+    if ret != 0:
+        raise RuntimeError("openfpm: %s failed" % what)
+
+
+def init():
+    """Initialize openfpm (and MPI)"""
+    _lib.ofp_init()
+
+
+def finalize():
+    """Finalize openfpm (and MPI)"""
+    _lib.ofp_finalize()
+
+
+def rank():
+    return _lib.ofp_rank()
+
+
+def n_proc():
+    return _lib.ofp_n_proc()
+
+
+class VectorDist(object):
+    """Distributed particles, the ones created from python have properties
+       0: scalar, 1: scalar, 2: vector, 3: vector"""
+
+    def __init__(self, dim, np_, low, high, bc, ghost):
+        self.dim = dim
+        self.n_prop = 4
+        self._h = _lib.ofp_vector_dist_create(dim, np_,
+                                              _array(low, ctypes.c_double, dim),
+                                              _array(high, ctypes.c_double, dim),
+                                              _array(bc, ctypes.c_int, dim),
+                                              ghost)
+        if not self._h:
+            raise RuntimeError("openfpm: cannot create a vector_dist with dimensionality %d" % dim)
+
+    @classmethod
+    def from_handle(cls, h):
+        """Wrap a vector registered from C++ with py_register_vector_dist"""
+        vd = cls.__new__(cls)
+        vd._h = ctypes.c_void_p(h)
+        vd.dim = _lib.ofp_vector_dist_dim(vd._h)
+        vd.n_prop = _lib.ofp_vector_dist_n_prop(vd._h)
+        return vd
+
+    def __del__(self):
+        if getattr(self, "_h", None):
+            _lib.ofp_vector_dist_delete(self._h)
+            self._h = None
+
+    def size_local(self):
+        return _lib.ofp_vector_dist_size_local(self._h)
+
+    def size_local_with_ghost(self):
+        return _lib.ofp_vector_dist_size_local_with_ghost(self._h)
+
+    def add(self, x):
+        x = np.ascontiguousarray(x, dtype=np.float64).reshape(-1, self.dim)
+        _check(_lib.ofp_vector_dist_add(self._h, x.ctypes.data_as(ctypes.POINTER(ctypes.c_double)), x.shape[0]), "add")
+
+    def map(self):
+        _check(_lib.ofp_vector_dist_map(self._h), "map")
+
+    def ghost_get(self, with_position=True):
+        _check(_lib.ofp_vector_dist_ghost_get(self._h, 1 if with_position else 0), "ghost_get")
+
+    def pos(self):
+        v = _View()
+        _check(_lib.ofp_vector_dist_pos_view(self._h, ctypes.byref(v)), "pos")
+        return _numpy(v)
+
+    def prop(self, prp):
+        v = _View()
+        _check(_lib.ofp_vector_dist_prop_view(self._h, prp, ctypes.byref(v)), "prop")
+        return _numpy(v)
+
+    def cell_list(self, r_cut):
+        """Neighbors of the real particles in CSR format (start, nn), the neighbors
+           of p are nn[start[p]:start[p+1]], the arrays are valid until the next call"""
+        start = _View()
+        nn = _View()
+        _lib.ofp_vector_dist_cell_list(self._h, r_cut, ctypes.byref(start), ctypes.byref(nn))
+        return _numpy(start), _numpy(nn)
+
+    def write(self, name):
+        _check(_lib.ofp_vector_dist_write(self._h, name.encode()), "write")
+
+
+class GridDist(object):
+    """Distributed grid, the ones created from python have properties 0: scalar, 1: vector"""
+
+    def __init__(self, dim, sz, low, high, bc, ghost):
+        self.dim = dim
+        self.n_prop = 2
+        self._h = _lib.ofp_grid_dist_create(dim,
+                                            _array(sz, ctypes.c_size_t, dim),
+                                            _array(low, ctypes.c_double, dim),
+                                            _array(high, ctypes.c_double, dim),
+                                            _array(bc, ctypes.c_int, dim),
+                                            ghost)
+        if not self._h:
+            raise RuntimeError("openfpm: cannot create a grid_dist_id with dimensionality %d" % dim)
+
+    @classmethod
+    def from_handle(cls, h):
+        """Wrap a grid registered from C++ with py_register_grid_dist"""
+        gd = cls.__new__(cls)
+        gd._h = ctypes.c_void_p(h)
+        gd.dim = _lib.ofp_grid_dist_dim(gd._h)
+        gd.n_prop = _lib.ofp_grid_dist_n_prop(gd._h)
+        return gd
+
+    def __del__(self):
+        if getattr(self, "_h", None):
+            _lib.ofp_grid_dist_delete(self._h)
+            self._h = None
+
+    def n_loc_grid(self):
+        return _lib.ofp_grid_dist_n_loc_grid(self._h)
+
+    def loc_grid(self, i, prp):
+        """Local grid i with ghost, the index order is the numpy one (last coordinate first)"""
+        v = _View()
+        _check(_lib.ofp_grid_dist_loc_grid_view(self._h, i, prp, ctypes.byref(v)), "loc_grid")
+        return _numpy(v)
+
+    def loc_grid_domain(self, i):
+        """Domain of the local grid i (lo, hi inclusive in local coordinates) and its origin"""
+        lo = (ctypes.c_long * self.dim)()
+        hi = (ctypes.c_long * self.dim)()
+        origin = (ctypes.c_long * self.dim)()
+        _check(_lib.ofp_grid_dist_loc_grid_domain(self._h, i, lo, hi, origin), "loc_grid_domain")
+        return list(lo), list(hi), list(origin)
+
+    def ghost_get(self):
+        _check(_lib.ofp_grid_dist_ghost_get(self._h), "ghost_get")
+
+    def map(self):
+        _check(_lib.ofp_grid_dist_map(self._h), "map")
+
+    def write(self, name):
+        _check(_lib.ofp_grid_dist_write(self._h, name.encode()), "write")
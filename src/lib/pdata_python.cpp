@@ -1,7 +1,249 @@
+/*
+ * pdata_python.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ *
+ * C interface of the library used by the python module openfpm.py (ctypes). Positions, properties
+ * and local grids are returned as pointer + shape + strides, python wrap them into numpy arrays
+ * without copy. The views are valid until the structure is resized (add, map, ghost_get).
+ * The structures created from python have fixed properties (py_part_prop, py_grid_prop), any
+ * other structure can be exposed from C++ with py_register_vector_dist / py_register_grid_dist
+ *
+ */
 
+#include "lib/pdata_python.hpp"
+
+//! Properties of the particles created from python: two scalars and two vectors
+template<unsigned int dim> using py_part_prop = aggregate<double,double,double[dim],double[dim]>;
+
+//! Properties of the grids created from python: one scalar and one vector
+template<unsigned int dim> using py_grid_prop = aggregate<double,double[dim]>;
+
+//! Distributed vector created from python
+template<unsigned int dim> using py_vector_dist = vector_dist<dim,double,py_part_prop<dim>>;
+
+//! Distributed grid created from python
+template<unsigned int dim> using py_grid_dist = grid_dist_id<dim,double,py_grid_prop<dim>>;
+
+template<unsigned int dim> static py_vector_dist_base * py_vd_create(size_t np, const double * lo, const double * hi, const int * bc, double ghost)
+{
+	Box<dim,double> domain;
+	size_t bc_[dim];
+
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		domain.setLow(i,lo[i]);
+		domain.setHigh(i,hi[i]);
+		bc_[i] = (bc[i] != 0)?PERIODIC:NON_PERIODIC;
+	}
+
+	Ghost<dim,double> g(ghost);
+
+	auto * vd = new py_vector_dist_impl<py_vector_dist<dim>>(new py_vector_dist<dim>(np,domain,bc_,g),true);
+
+	// set properties to zero
+	vd->zero();
+
+	return vd;
+}
+
+template<unsigned int dim> static py_grid_dist_base * py_gd_create(const size_t * sz, const double * lo, const double * hi, const int * bc, long int ghost)
+{
+	Box<dim,double> domain;
+	size_t sz_[dim];
+	periodicity<dim> pr;
+
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		domain.setLow(i,lo[i]);
+		domain.setHigh(i,hi[i]);
+		sz_[i] = sz[i];
+		pr.bc[i] = (bc[i] != 0)?PERIODIC:NON_PERIODIC;
+	}
+
+	Ghost<dim,long int> g(ghost);
+
+	return new py_grid_dist_impl<py_grid_dist<dim>>(new py_grid_dist<dim>(sz_,domain,g,pr),true);
+}
+
+/*! \brief Check the dimensionality requested by python
+ *
+ * \param dim dimensionality
+ *
+ * \return true if supported
+ *
+ */
+static bool py_check_dim(int dim)
+{
+	if (dim != 2 && dim != 3)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error only 2D and 3D structures are supported from python" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/*! \brief Initialize the library (MPI included) if it is not initialized
+ *
+ */
 void init_openfpm_python()
 {
+	if (is_openfpm_init() == true)
+	{return;}
+
+	int argc = 1;
+	char name[] = "python";
+	char * argv_[] = {name, NULL};
+	char ** argv = argv_;
+
+	openfpm_init(&argc,&argv);
 }
 
+extern "C"
+{
 
+void ofp_init()
+{
+	init_openfpm_python();
+}
 
+void ofp_finalize()
+{
+	if (is_openfpm_init() == true)
+	{openfpm_finalize();}
+}
+
+int ofp_rank()
+{
+	return create_vcluster().getProcessUnitID();
+}
+
+int ofp_n_proc()
+{
+	return create_vcluster().getProcessingUnits();
+}
+
+void * ofp_vector_dist_create(int dim, size_t np, const double * lo, const double * hi, const int * bc, double ghost)
+{
+	if (py_check_dim(dim) == false)
+	{return NULL;}
+
+	return (dim == 2)?py_vd_create<2>(np,lo,hi,bc,ghost):py_vd_create<3>(np,lo,hi,bc,ghost);
+}
+
+void ofp_vector_dist_delete(void * h)
+{
+	delete static_cast<py_vector_dist_base *>(h);
+}
+
+int ofp_vector_dist_dim(void * h)
+{
+	return static_cast<py_vector_dist_base *>(h)->dim();
+}
+
+int ofp_vector_dist_n_prop(void * h)
+{
+	return static_cast<py_vector_dist_base *>(h)->n_prop();
+}
+
+size_t ofp_vector_dist_size_local(void * h)
+{
+	return static_cast<py_vector_dist_base *>(h)->size_local();
+}
+
+size_t ofp_vector_dist_size_local_with_ghost(void * h)
+{
+	return static_cast<py_vector_dist_base *>(h)->size_local_with_ghost();
+}
+
+int ofp_vector_dist_add(void * h, const double * x, size_t n)
+{
+	return static_cast<py_vector_dist_base *>(h)->add(x,n);
+}
+
+int ofp_vector_dist_map(void * h)
+{
+	return static_cast<py_vector_dist_base *>(h)->map();
+}
+
+int ofp_vector_dist_ghost_get(void * h, int with_position)
+{
+	return static_cast<py_vector_dist_base *>(h)->ghost_get(with_position);
+}
+
+int ofp_vector_dist_pos_view(void * h, py_view * v)
+{
+	return static_cast<py_vector_dist_base *>(h)->pos_view(*v);
+}
+
+int ofp_vector_dist_prop_view(void * h, int prp, py_view * v)
+{
+	return static_cast<py_vector_dist_base *>(h)->prop_view(prp,*v);
+}
+
+size_t ofp_vector_dist_cell_list(void * h, double r_cut, py_view * start, py_view * nn)
+{
+	return static_cast<py_vector_dist_base *>(h)->cell_list(r_cut,*start,*nn);
+}
+
+int ofp_vector_dist_write(void * h, const char * out)
+{
+	return static_cast<py_vector_dist_base *>(h)->write(out);
+}
+
+void * ofp_grid_dist_create(int dim, const size_t * sz, const double * lo, const double * hi, const int * bc, long int ghost)
+{
+	if (py_check_dim(dim) == false)
+	{return NULL;}
+
+	return (dim == 2)?py_gd_create<2>(sz,lo,hi,bc,ghost):py_gd_create<3>(sz,lo,hi,bc,ghost);
+}
+
+void ofp_grid_dist_delete(void * h)
+{
+	delete static_cast<py_grid_dist_base *>(h);
+}
+
+int ofp_grid_dist_dim(void * h)
+{
+	return static_cast<py_grid_dist_base *>(h)->dim();
+}
+
+int ofp_grid_dist_n_prop(void * h)
+{
+	return static_cast<py_grid_dist_base *>(h)->n_prop();
+}
+
+size_t ofp_grid_dist_n_loc_grid(void * h)
+{
+	return static_cast<py_grid_dist_base *>(h)->n_loc_grid();
+}
+
+int ofp_grid_dist_loc_grid_view(void * h, size_t i, int prp, py_view * v)
+{
+	return static_cast<py_grid_dist_base *>(h)->loc_grid_view(i,prp,*v);
+}
+
+int ofp_grid_dist_loc_grid_domain(void * h, size_t i, long int * lo, long int * hi, long int * origin)
+{
+	return static_cast<py_grid_dist_base *>(h)->loc_grid_domain(i,lo,hi,origin);
+}
+
+int ofp_grid_dist_ghost_get(void * h)
+{
+	return static_cast<py_grid_dist_base *>(h)->ghost_get();
+}
+
+int ofp_grid_dist_map(void * h)
+{
+	return static_cast<py_grid_dist_base *>(h)->map();
+}
+
+int ofp_grid_dist_write(void * h, const char * out)
+{
+	return static_cast<py_grid_dist_base *>(h)->write(out);
+}
+
+}
@@ -0,0 +1,722 @@
+/*
+ * pdata_python.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ *
+ * Templated part of the C interface used by the python module openfpm.py (see pdata_python.cpp).
+ * Any vector_dist or grid_dist_id (dense) of a C++ program can be exposed to python with
+ * py_register_vector_dist and py_register_grid_dist, the returned handle is passed to python
+ * (for example from an extern "C" function of the program) and wrapped with
+ * openfpm.VectorDist.from_handle / openfpm.GridDist.from_handle
+ *
+ * \code
+ *
+ * vector_dist<3,float,aggregate<float,int,float[3]>> vd(...);
+ *
+ * extern "C" void * my_particles()
+ * {
+ *     return py_register_vector_dist(vd);
+ * }
+ *
+ * \endcode
+ *
+ * Positions and properties (scalars or one dimensional arrays of double, float, int, long int or size_t)
+ * are returned as pointer + shape + strides, the strides are taken from the address of the elements in the
+ * container, so they do not depend on the layout of the properties
+ *
+ */
+
+#ifndef PDATA_PYTHON_HPP_
+#define PDATA_PYTHON_HPP_
+
+#include "Vector/vector_dist.hpp"
+#include "Grid/grid_dist_id.hpp"
+#include <utility>
+
+//! Maximum number of dimensions of a view (dim + components)
+#define PY_VIEW_MAX_DIM 4
+
+//! Type of the elements of a view (numpy dtype)
+enum py_dtype
+{
+	PY_DOUBLE = 0,
+	PY_FLOAT = 1,
+	PY_INT = 2,
+	PY_LONG = 3,
+	PY_SIZE_T = 4,
+	PY_UNKNOWN = -1
+};
+
+//! Type code of the elements of a view
+template<typename T> struct py_dtype_of {enum {value = PY_UNKNOWN};};
+template<> struct py_dtype_of<double> {enum {value = PY_DOUBLE};};
+template<> struct py_dtype_of<float> {enum {value = PY_FLOAT};};
+template<> struct py_dtype_of<int> {enum {value = PY_INT};};
+template<> struct py_dtype_of<long int> {enum {value = PY_LONG};};
+template<> struct py_dtype_of<size_t> {enum {value = PY_SIZE_T};};
+
+/*! \brief Description of a strided array, python create a numpy array from it
+ *
+ * The layout is the one of numpy, the first index is the slowest
+ *
+ */
+struct py_view
+{
+	//! pointer to the first element (NULL if the array is empty)
+	void * ptr;
+
+	//! type of the elements (see py_dtype)
+	int dtype;
+
+	//! number of dimensions of the array
+	int ndim;
+
+	//! shape
+	size_t shape[PY_VIEW_MAX_DIM];
+
+	//! strides in byte
+	long int strides[PY_VIEW_MAX_DIM];
+};
+
+/*! \brief Distance in byte between two elements of a container
+ *
+ */
+template<typename T1, typename T2> static inline long int py_addr_diff(const T1 & a, const T2 & b)
+{
+	return (const char *)&a - (const char *)&b;
+}
+
+/*! \brief Address and components of an element of a view (scalar)
+ *
+ */
+template<unsigned int rank>
+struct py_element
+{
+	template<typename base_type, typename T> static void * addr(T && a)
+	{
+		return (void *)&a;
+	}
+
+	template<typename base_type, typename T> static void components(T && a, size_t n_comp, py_view & v)
+	{}
+
+	template<typename base_type, typename T1, typename T2> static long int stride(T1 && a1, T2 && a0)
+	{
+		return py_addr_diff(a1,a0);
+	}
+};
+
+/*! \brief Address and components of an element of a view (one dimensional array)
+ *
+ */
+template<>
+struct py_element<1>
+{
+	template<typename base_type, typename T> static void * addr(T && a)
+	{
+		return (void *)&a[0];
+	}
+
+	template<typename base_type, typename T> static void components(T && a, size_t n_comp, py_view & v)
+	{
+		v.shape[v.ndim] = n_comp;
+		v.strides[v.ndim] = (n_comp < 2)?(long int)sizeof(base_type):py_addr_diff(a[1],a[0]);
+		v.ndim++;
+	}
+
+	template<typename base_type, typename T1, typename T2> static long int stride(T1 && a1, T2 && a0)
+	{
+		return py_addr_diff(a1[0],a0[0]);
+	}
+};
+
+/*! \brief Check that a property type can be exposed to python
+ *
+ * \return true if it is a scalar or a one dimensional array of a supported type
+ *
+ */
+template<typename prp_type> static bool py_check_type()
+{
+	typedef typename std::remove_all_extents<prp_type>::type base_type;
+
+	if (std::rank<prp_type>::value > 1 || (int)py_dtype_of<base_type>::value == PY_UNKNOWN)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error only scalars and one dimensional arrays of double, float, int, long int and size_t can be exposed to python" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/*! \brief Fill the view of an empty array (contiguous strides)
+ *
+ * \param n_shape number of dimensions of the elements
+ * \param n_comp number of components (0 for scalars)
+ * \param sz size of the base type
+ * \param v view
+ *
+ */
+static inline void py_empty_view(size_t n_shape, size_t n_comp, size_t sz, py_view & v)
+{
+	v.ptr = NULL;
+	v.ndim = n_shape + ((n_comp == 0)?0:1);
+
+	for (int i = v.ndim - 1 ; i >= 0 ; i--)
+	{
+		v.shape[i] = ((size_t)i == n_shape)?n_comp:0;
+		v.strides[i] = sz;
+	}
+}
+
+//! Set to zero the arithmetic properties (scalars and arrays)
+template<typename T, unsigned int rank = std::rank<T>::value>
+struct py_zero
+{
+	template<typename TT> static void set(TT && a)
+	{}
+};
+
+template<typename T>
+struct py_zero<T,0>
+{
+	template<typename TT> static void set(TT && a)
+	{
+		if (std::is_arithmetic<T>::value == true)
+		{a = 0;}
+	}
+};
+
+template<typename T>
+struct py_zero<T,1>
+{
+	template<typename TT> static void set(TT && a)
+	{
+		if (std::is_arithmetic<typename std::remove_all_extents<T>::type>::value == true)
+		{
+			for (size_t i = 0 ; i < std::extent<T>::value ; i++)
+			{a[i] = 0;}
+		}
+	}
+};
+
+/*! \brief Set to zero the arithmetic properties of a particle
+ *
+ */
+template<typename vector_type>
+struct py_zero_particle
+{
+	//! vector
+	vector_type & vd;
+
+	//! particle
+	size_t p;
+
+	py_zero_particle(vector_type & vd, size_t p)
+	:vd(vd),p(p)
+	{}
+
+	template<typename T> inline void operator()(T & t)
+	{
+		typedef typename boost::mpl::at<typename vector_type::value_type::type,T>::type prp_type;
+
+		py_zero<prp_type>::set(vd.template getPropNC<T::value>(p));
+	}
+};
+
+/*! \brief Call a templated member of obj for the property prp selected at runtime
+ *
+ */
+template<unsigned int prp, unsigned int n_prp>
+struct py_prop_dispatch
+{
+	template<typename obj_type, typename ... Args> static int call(obj_type & obj, int p, Args && ... args)
+	{
+		if (p == (int)prp)
+		{return obj.template prop_view_<prp>(args...);}
+
+		return py_prop_dispatch<prp+1,n_prp>::call(obj,p,args...);
+	}
+};
+
+template<unsigned int n_prp>
+struct py_prop_dispatch<n_prp,n_prp>
+{
+	template<typename obj_type, typename ... Args> static int call(obj_type & obj, int p, Args && ... args)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error the structure has " << n_prp << " properties, property " << p << " does not exist" << std::endl;
+		return -1;
+	}
+};
+
+/*! \brief Distributed vector seen from python
+ *
+ */
+class py_vector_dist_base
+{
+public:
+
+	//! for every real particle the start of its neighbors in nn_list (cell list)
+	openfpm::vector<size_t> nn_start;
+
+	//! neighbors of the particles (cell list)
+	openfpm::vector<size_t> nn_list;
+
+	virtual ~py_vector_dist_base() {}
+
+	virtual int dim() = 0;
+	virtual int n_prop() = 0;
+	virtual size_t size_local() = 0;
+	virtual size_t size_local_with_ghost() = 0;
+	virtual int add(const double * x, size_t n) = 0;
+	virtual int map() = 0;
+	virtual int ghost_get(int with_position) = 0;
+	virtual int pos_view(py_view & v) = 0;
+	virtual int prop_view(int prp, py_view & v) = 0;
+	virtual size_t cell_list(double r_cut, py_view & start, py_view & nn) = 0;
+	virtual int write(const char * out) = 0;
+};
+
+/*! \brief Distributed grid seen from python
+ *
+ */
+class py_grid_dist_base
+{
+public:
+
+	virtual ~py_grid_dist_base() {}
+
+	virtual int dim() = 0;
+	virtual int n_prop() = 0;
+	virtual size_t n_loc_grid() = 0;
+	virtual int loc_grid_view(size_t i, int prp, py_view & v) = 0;
+	virtual int loc_grid_domain(size_t i, long int * lo, long int * hi, long int * origin) = 0;
+	virtual int ghost_get() = 0;
+	virtual int map() = 0;
+	virtual int write(const char * out) = 0;
+};
+
+/*! \brief Expose a vector_dist to python
+ *
+ * \tparam vector_type vector_dist
+ *
+ */
+template<typename vector_type>
+class py_vector_dist_impl : public py_vector_dist_base
+{
+	typedef typename vector_type::value_type prop;
+	typedef typename vector_type::stype St;
+
+	//! vector
+	vector_type * vd;
+
+	//! the vector is deleted with this object
+	bool own;
+
+	template<size_t ... prp> void ghost_get_all(size_t opt, std::index_sequence<prp...>)
+	{
+		vd->template ghost_get<prp...>(opt);
+	}
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param vd vector
+	 * \param own if true the vector is deleted with this object
+	 *
+	 */
+	py_vector_dist_impl(vector_type * vd, bool own)
+	:vd(vd),own(own)
+	{}
+
+	~py_vector_dist_impl()
+	{
+		if (own == true)
+		{delete vd;}
+	}
+
+	/*! \brief Set to zero the arithmetic properties of the real particles
+	 *
+	 */
+	void zero()
+	{
+		for (size_t i = 0 ; i < vd->size_local() ; i++)
+		{
+			py_zero_particle<vector_type> zp(*vd,i);
+			boost::mpl::for_each_ref<boost::mpl::range_c<int,0,prop::max_prop>>(zp);
+		}
+	}
+
+	int dim()
+	{
+		return vector_type::dims;
+	}
+
+	int n_prop()
+	{
+		return prop::max_prop;
+	}
+
+	size_t size_local()
+	{
+		return vd->size_local();
+	}
+
+	size_t size_local_with_ghost()
+	{
+		return vd->size_local_with_ghost();
+	}
+
+	int add(const double * x, size_t n)
+	{
+		for (size_t i = 0 ; i < n ; i++)
+		{
+			vd->add();
+
+			for (size_t j = 0 ; j < vector_type::dims ; j++)
+			{vd->getLastPos()[j] = x[i*vector_type::dims + j];}
+
+			py_zero_particle<vector_type> zp(*vd,vd->size_local()-1);
+			boost::mpl::for_each_ref<boost::mpl::range_c<int,0,prop::max_prop>>(zp);
+		}
+
+		return 0;
+	}
+
+	int map()
+	{
+		vd->map();
+		return 0;
+	}
+
+	int ghost_get(int with_position)
+	{
+		ghost_get_all((with_position != 0)?WITH_POSITION:NO_POSITION,std::make_index_sequence<prop::max_prop>());
+		return 0;
+	}
+
+	int pos_view(py_view & v)
+	{
+		size_t n = vd->size_local_with_ghost();
+
+		v.dtype = py_dtype_of<St>::value;
+
+		if (n == 0)
+		{
+			py_empty_view(1,vector_type::dims,sizeof(St),v);
+			return 0;
+		}
+
+		v.ptr = py_element<1>::template addr<St>(vd->getPos(0));
+		v.ndim = 1;
+		v.shape[0] = n;
+		v.strides[0] = (n < 2)?sizeof(St)*vector_type::dims:py_element<1>::template stride<St>(vd->getPos(1),vd->getPos(0));
+		py_element<1>::template components<St>(vd->getPos(0),vector_type::dims,v);
+
+		return 0;
+	}
+
+	template<unsigned int prp> int prop_view_(py_view & v)
+	{
+		typedef typename boost::mpl::at<typename prop::type,boost::mpl::int_<prp>>::type prp_type;
+		typedef typename std::remove_all_extents<prp_type>::type base_type;
+		typedef py_element<std::rank<prp_type>::value> elem;
+
+		if (py_check_type<prp_type>() == false)
+		{return -1;}
+
+		size_t n = vd->size_local_with_ghost();
+		size_t n_comp = (std::rank<prp_type>::value == 0)?0:std::extent<prp_type>::value;
+
+		v.dtype = py_dtype_of<base_type>::value;
+
+		if (n == 0)
+		{
+			py_empty_view(1,n_comp,sizeof(base_type),v);
+			return 0;
+		}
+
+		v.ptr = elem::template addr<base_type>(vd->template getPropNC<prp>(0));
+		v.ndim = 1;
+		v.shape[0] = n;
+		v.strides[0] = (n < 2)?sizeof(prp_type):elem::template stride<base_type>(vd->template getPropNC<prp>(1),vd->template getPropNC<prp>(0));
+		elem::template components<base_type>(vd->template getPropNC<prp>(0),n_comp,v);
+
+		return 0;
+	}
+
+	int prop_view(int prp, py_view & v)
+	{
+		return py_prop_dispatch<0,prop::max_prop>::call(*this,prp,v);
+	}
+
+	size_t cell_list(double r_cut, py_view & start, py_view & nn)
+	{
+		nn_start.clear();
+		nn_list.clear();
+
+		auto NN = vd->getCellList(r_cut);
+
+		double r_cut2 = r_cut*r_cut;
+
+		for (size_t p = 0 ; p < vd->size_local() ; p++)
+		{
+			nn_start.add(nn_list.size());
+
+			Point<vector_type::dims,St> xp = vd->getPos(p);
+
+			auto Np = NN.getNNIterator(NN.getCell(xp));
+
+			while (Np.isNext())
+			{
+				size_t q = Np.get();
+
+				Point<vector_type::dims,St> xq = vd->getPos(q);
+
+				if (q != p && xp.distance2(xq) < r_cut2)
+				{nn_list.add(q);}
+
+				++Np;
+			}
+		}
+
+		nn_start.add(nn_list.size());
+
+		start.dtype = PY_SIZE_T;
+		nn.dtype = PY_SIZE_T;
+
+		py_empty_view(1,0,sizeof(size_t),start);
+		py_empty_view(1,0,sizeof(size_t),nn);
+
+		start.shape[0] = nn_start.size();
+		start.ptr = &nn_start.get(0);
+
+		nn.shape[0] = nn_list.size();
+		nn.ptr = (nn_list.size() == 0)?NULL:&nn_list.get(0);
+
+		return nn_list.size();
+	}
+
+	int write(const char * out)
+	{
+		return (vd->write(std::string(out)) == true)?0:-1;
+	}
+};
+
+/*! \brief Expose a grid_dist_id to python
+ *
+ * \tparam grid_type grid_dist_id with dense local grids
+ *
+ */
+template<typename grid_type>
+class py_grid_dist_impl : public py_grid_dist_base
+{
+	typedef typename grid_type::value_type prop;
+
+	static const unsigned int dims = grid_type::dims;
+
+	static_assert(grid_type::d_grid::isCompressed() == false,"only grids with dense local grids can be exposed to python");
+
+	//! grid
+	grid_type * gd;
+
+	//! the grid is deleted with this object
+	bool own;
+
+	template<size_t ... prp> void ghost_get_all(std::index_sequence<prp...>)
+	{
+		gd->template ghost_get<prp...>();
+	}
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param gd grid
+	 * \param own if true the grid is deleted with this object
+	 *
+	 */
+	py_grid_dist_impl(grid_type * gd, bool own)
+	:gd(gd),own(own)
+	{}
+
+	~py_grid_dist_impl()
+	{
+		if (own == true)
+		{delete gd;}
+	}
+
+	int dim()
+	{
+		return dims;
+	}
+
+	int n_prop()
+	{
+		return prop::max_prop;
+	}
+
+	size_t n_loc_grid()
+	{
+		return gd->getN_loc_grid();
+	}
+
+	template<unsigned int prp> int prop_view_(size_t i, py_view & v)
+	{
+		typedef typename boost::mpl::at<typename prop::type,boost::mpl::int_<prp>>::type prp_type;
+		typedef typename std::remove_all_extents<prp_type>::type base_type;
+		typedef py_element<std::rank<prp_type>::value> elem;
+
+		if (py_check_type<prp_type>() == false)
+		{return -1;}
+
+		auto & lg = gd->get_loc_grid(i);
+		size_t n_comp = (std::rank<prp_type>::value == 0)?0:std::extent<prp_type>::value;
+
+		v.dtype = py_dtype_of<base_type>::value;
+
+		size_t n = 1;
+		for (size_t j = 0 ; j < dims ; j++)
+		{n *= lg.getGrid().size(j);}
+
+		if (n == 0)
+		{
+			py_empty_view(dims,n_comp,sizeof(base_type),v);
+			return 0;
+		}
+
+		grid_key_dx<dims> zero;
+		zero.zero();
+
+		v.ptr = elem::template addr<base_type>(lg.template get<prp>(zero));
+		v.ndim = dims;
+
+		// numpy shape, the first coordinate is the fastest in the local grid
+		for (size_t j = 0 ; j < dims ; j++)
+		{
+			grid_key_dx<dims> kj = zero;
+			kj.set_d(j,1);
+
+			v.shape[dims - 1 - j] = lg.getGrid().size(j);
+			v.strides[dims - 1 - j] = (lg.getGrid().size(j) < 2)?sizeof(prp_type):elem::template stride<base_type>(lg.template get<prp>(kj),lg.template get<prp>(zero));
+		}
+
+		elem::template components<base_type>(lg.template get<prp>(zero),n_comp,v);
+
+		return 0;
+	}
+
+	int loc_grid_view(size_t i, int prp, py_view & v)
+	{
+		if (i >= gd->getN_loc_grid())
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error the local grid " << i << " does not exist" << std::endl;
+			return -1;
+		}
+
+		return py_prop_dispatch<0,prop::max_prop>::call(*this,prp,i,v);
+	}
+
+	int loc_grid_domain(size_t i, long int * lo, long int * hi, long int * origin)
+	{
+		auto & gdb_ext = gd->getLocalGridsInfo();
+
+		if (i >= gdb_ext.size())
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error the local grid " << i << " does not exist" << std::endl;
+			return -1;
+		}
+
+		for (size_t j = 0 ; j < dims ; j++)
+		{
+			lo[j] = gdb_ext.get(i).Dbox.getLow(j);
+			hi[j] = gdb_ext.get(i).Dbox.getHigh(j);
+			origin[j] = gdb_ext.get(i).origin.get(j);
+		}
+
+		return 0;
+	}
+
+	int ghost_get()
+	{
+		ghost_get_all(std::make_index_sequence<prop::max_prop>());
+		return 0;
+	}
+
+	int map()
+	{
+		gd->map();
+		return 0;
+	}
+
+	int write(const char * out)
+	{
+		return (gd->write(std::string(out)) == true)?0:-1;
+	}
+};
+
+/*! \brief Expose a distributed vector to python
+ *
+ * The vector is not copied and it is not deleted by python, it must live longer than the python object
+ *
+ * \param vd vector to expose
+ *
+ * \return the handle to pass to openfpm.VectorDist.from_handle
+ *
+ */
+template<typename vector_type> void * py_register_vector_dist(vector_type & vd)
+{
+	return static_cast<py_vector_dist_base *>(new py_vector_dist_impl<vector_type>(&vd,false));
+}
+
+/*! \brief Expose a distributed grid to python
+ *
+ * The grid is not copied and it is not deleted by python, it must live longer than the python object
+ *
+ * \param gd grid to expose
+ *
+ * \return the handle to pass to openfpm.GridDist.from_handle
+ *
+ */
+template<typename grid_type> void * py_register_grid_dist(grid_type & gd)
+{
+	return static_cast<py_grid_dist_base *>(new py_grid_dist_impl<grid_type>(&gd,false));
+}
+
+extern "C"
+{
+
+void ofp_init();
+void ofp_finalize();
+int ofp_rank();
+int ofp_n_proc();
+
+void * ofp_vector_dist_create(int dim, size_t np, const double * lo, const double * hi, const int * bc, double ghost);
+void ofp_vector_dist_delete(void * h);
+int ofp_vector_dist_dim(void * h);
+int ofp_vector_dist_n_prop(void * h);
+size_t ofp_vector_dist_size_local(void * h);
+size_t ofp_vector_dist_size_local_with_ghost(void * h);
+int ofp_vector_dist_add(void * h, const double * x, size_t n);
+int ofp_vector_dist_map(void * h);
+int ofp_vector_dist_ghost_get(void * h, int with_position);
+int ofp_vector_dist_pos_view(void * h, py_view * v);
+int ofp_vector_dist_prop_view(void * h, int prp, py_view * v);
+size_t ofp_vector_dist_cell_list(void * h, double r_cut, py_view * start, py_view * nn);
+int ofp_vector_dist_write(void * h, const char * out);
+
+void * ofp_grid_dist_create(int dim, const size_t * sz, const double * lo, const double * hi, const int * bc, long int ghost);
+void ofp_grid_dist_delete(void * h);
+int ofp_grid_dist_dim(void * h);
+int ofp_grid_dist_n_prop(void * h);
+size_t ofp_grid_dist_n_loc_grid(void * h);
+int ofp_grid_dist_loc_grid_view(void * h, size_t i, int prp, py_view * v);
+int ofp_grid_dist_loc_grid_domain(void * h, size_t i, long int * lo, long int * hi, long int * origin);
+int ofp_grid_dist_ghost_get(void * h);
+int ofp_grid_dist_map(void * h);
+int ofp_grid_dist_write(void * h, const char * out);
+
+}
+
+#endif /* PDATA_PYTHON_HPP_ */
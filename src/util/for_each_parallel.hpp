@@ -0,0 +1,109 @@
+/*
+ * for_each_parallel.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef FOR_EACH_PARALLEL_HPP_
+#define FOR_EACH_PARALLEL_HPP_
+
+#include "config.h"
+#include <vector>
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+/*! \brief Return the number of threads used by the parallel iterations
+ *
+ * \param n_thr requested number of threads (0 = all the threads available)
+ *
+ * \return the number of threads
+ *
+ */
+inline unsigned int pdata_threads_number(unsigned int n_thr = 0)
+{
+#ifdef HAVE_OPENMP
+	return (n_thr == 0)?omp_get_max_threads():n_thr;
+#else
+	return 1;
+#endif
+}
+
+/*! \brief Execute a set of work items on a pool of threads
+ *
+ * Every work item is an OpenMP task, the tasks are created by one thread and executed by the
+ * pool. Idle threads steal the pending tasks, so work items of different cost does not stall
+ * the other threads. Without OpenMP the work items are executed sequentially
+ *
+ * \param n_item number of work items
+ * \param f function f(item,thread) executed for each work item
+ *
+ */
+template<typename lambda_t>
+void parallel_work_items(size_t n_item, lambda_t & f)
+{
+#ifdef HAVE_OPENMP
+	#pragma omp parallel
+	{
+		#pragma omp single
+		{
+			for (size_t i = 0 ; i < n_item ; i++)
+			{
+				#pragma omp task firstprivate(i) shared(f)
+				{f(i,omp_get_thread_num());}
+			}
+		}
+	}
+#else
+	for (size_t i = 0 ; i < n_item ; i++)
+	{f(i,0);}
+#endif
+}
+
+/*! \brief Partial result of a reduction for one thread
+ *
+ * It is aligned to a cache line to avoid false sharing across threads
+ *
+ */
+template<typename T>
+struct alignas(64) red_partial
+{
+	//! partial result
+	T v;
+};
+
+/*! \brief Execute a set of work items on a pool of threads and reduce the result
+ *
+ * \param n_item number of work items
+ * \param init identity of the reduction (it is the initial value of every partial reduction)
+ * \param f function f(item,partial) executed for each work item, it accumulate into partial
+ * \param op reduction operation op(a,b) that return the reduction of a and b
+ *
+ * \return the reduced value
+ *
+ */
+template<typename T, typename lambda_t, typename reduce_t>
+T parallel_work_items_reduce(size_t n_item, const T & init, lambda_t & f, reduce_t & op)
+{
+	std::vector<red_partial<T>> partial(pdata_threads_number());
+
+	for (size_t i = 0 ; i < partial.size() ; i++)
+	{partial[i].v = init;}
+
+	auto fr = [&](size_t item, int thr)
+	{
+		f(item,partial[thr].v);
+	};
+
+	parallel_work_items(n_item,fr);
+
+	T red = init;
+	for (size_t i = 0 ; i < partial.size() ; i++)
+	{red = op(red,partial[i].v);}
+
+	return red;
+}
+
+#endif /* FOR_EACH_PARALLEL_HPP_ */
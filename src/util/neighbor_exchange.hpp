@@ -0,0 +1,346 @@
+/*
+ * neighbor_exchange.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef NEIGHBOR_EXCHANGE_HPP_
+#define NEIGHBOR_EXCHANGE_HPP_
+
+#include <mpi.h>
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include "Vector/map_vector.hpp"
+
+#define NEIGHBOR_EXCHANGE_ERROR_OBJECT std::runtime_error("Runtime neighbor exchange error");
+
+/*! \brief Exchange buffers with the neighborhood processors using MPI neighborhood collectives
+ *
+ * The processors we send to and the processors we receive from are known from the decomposition.
+ * They define a distributed graph communicator (MPI_Dist_graph_create_adjacent), every exchange
+ * is a single MPI_Neighbor_alltoallw on it, without the NBX handshake used to discover the
+ * communicating processors. The graph is symmetric (the neighborhood is the union of the two lists),
+ * so the messages can also be sent back the other way (ghost_put).
+ * When the number of bytes received from each source is not known, it is exchanged
+ * before with an MPI_Neighbor_alltoall
+ *
+ * The send buffers are read in place (MPI_BOTTOM with absolute addresses), the received
+ * messages are stored in an internal buffer and remain valid until the next call to exchange
+ *
+ * \note exchange is collective across all the processors of MPI_COMM_WORLD
+ *
+ */
+class neighbor_exchange
+{
+	//! graph communicator
+	MPI_Comm graph_comm = MPI_COMM_NULL;
+
+	//! processors we receive from (sorted by rank)
+	openfpm::vector<int> src;
+
+	//! processors we send to (sorted by rank, equal to src)
+	openfpm::vector<int> dst;
+
+	//! number of bytes to send to each destination
+	openfpm::vector<int> s_cnt;
+
+	//! number of bytes received from each source
+	openfpm::vector<int> r_cnt;
+
+	//! address of the message for each destination
+	openfpm::vector<MPI_Aint> s_disp;
+
+	//! offset of the message of each source in the receive buffer
+	openfpm::vector<MPI_Aint> r_disp;
+
+	//! datatype of each message (MPI_BYTE)
+	openfpm::vector<MPI_Datatype> s_type;
+
+	//! datatype of each message (MPI_BYTE)
+	openfpm::vector<MPI_Datatype> r_type;
+
+	//! receive buffer
+	openfpm::vector<unsigned char> r_buf;
+
+	/*! \brief Free the graph communicator
+	 *
+	 */
+	void free_comm()
+	{
+		int finalized = 0;
+		MPI_Finalized(&finalized);
+
+		if (finalized == false && graph_comm != MPI_COMM_NULL)
+		{MPI_Comm_free(&graph_comm);}
+
+		graph_comm = MPI_COMM_NULL;
+	}
+
+	/*! \brief Position of a processor in a sorted list
+	 *
+	 * \param list sorted list of processors
+	 * \param prc processor
+	 *
+	 * \return the position or -1 if the processor is not in the list
+	 *
+	 */
+	static long int find(const openfpm::vector<int> & list, size_t prc)
+	{
+		auto it = std::lower_bound(list.begin(),list.end(),(int)prc);
+
+		if (it == list.end() || *it != (int)prc)
+		{return -1;}
+
+		return it - list.begin();
+	}
+
+	/*! \brief Exchange the messages
+	 *
+	 * \see exchange
+	 *
+	 * \param known if true recv_prc and recv_sz are the known sources and sizes
+	 *
+	 * \return false if a destination is not a neighborhood processor or a message is bigger than 2GB
+	 *         (the message is not sent)
+	 *
+	 */
+	bool exchange_(const openfpm::vector<size_t> & prc,
+				   const openfpm::vector<const void *> & ptr,
+				   const openfpm::vector<size_t> & sz,
+				   openfpm::vector<size_t> & recv_prc,
+				   openfpm::vector<const void *> & recv_ptr,
+				   openfpm::vector<size_t> & recv_sz,
+				   bool known)
+	{
+		init();
+
+		bool ret = true;
+
+		s_cnt.resize(dst.size());
+		s_disp.resize(dst.size());
+		s_type.resize(dst.size());
+
+		for (size_t i = 0 ; i < dst.size() ; i++)
+		{
+			s_cnt.get(i) = 0;
+			s_disp.get(i) = 0;
+			s_type.get(i) = MPI_BYTE;
+		}
+
+		for (size_t i = 0 ; i < prc.size() ; i++)
+		{
+			long int id = find(dst,prc.get(i));
+
+			if (id == -1)
+			{
+				if (sz.get(i) != 0)
+				{ret = false;}
+
+				continue;
+			}
+
+			// the counts of MPI_Neighbor_alltoallw are int
+			if (sz.get(i) > INT_MAX)
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " Error message to processor " << prc.get(i) << " is bigger than 2GB" << std::endl;
+				ACTION_ON_ERROR(NEIGHBOR_EXCHANGE_ERROR_OBJECT);
+
+				ret = false;
+				continue;
+			}
+
+			s_cnt.get(id) = sz.get(i);
+			MPI_Get_address(ptr.get(i),&s_disp.get(id));
+		}
+
+		r_cnt.resize(src.size());
+		r_disp.resize(src.size());
+		r_type.resize(src.size());
+
+		if (known == true)
+		{
+			for (size_t i = 0 ; i < src.size() ; i++)
+			{r_cnt.get(i) = 0;}
+
+			for (size_t i = 0 ; i < recv_prc.size() ; i++)
+			{
+				long int id = find(src,recv_prc.get(i));
+
+				if (id != -1)
+				{r_cnt.get(id) = recv_sz.get(i);}
+			}
+		}
+		else
+		{
+			MPI_Neighbor_alltoall((s_cnt.size() != 0)?&s_cnt.get(0):NULL,1,MPI_INT,
+								  (r_cnt.size() != 0)?&r_cnt.get(0):NULL,1,MPI_INT,graph_comm);
+		}
+
+		size_t tot = 0;
+		for (size_t i = 0 ; i < src.size() ; i++)
+		{
+			r_disp.get(i) = tot;
+			r_type.get(i) = MPI_BYTE;
+			tot += r_cnt.get(i);
+		}
+
+		r_buf.resize(tot);
+
+		MPI_Neighbor_alltoallw(MPI_BOTTOM,
+							   (s_cnt.size() != 0)?&s_cnt.get(0):NULL,
+							   (s_disp.size() != 0)?&s_disp.get(0):NULL,
+							   (s_type.size() != 0)?&s_type.get(0):NULL,
+							   (tot != 0)?&r_buf.get(0):NULL,
+							   (r_cnt.size() != 0)?&r_cnt.get(0):NULL,
+							   (r_disp.size() != 0)?&r_disp.get(0):NULL,
+							   (r_type.size() != 0)?&r_type.get(0):NULL,
+							   graph_comm);
+
+		recv_prc.clear();
+		recv_ptr.clear();
+		recv_sz.clear();
+
+		for (size_t i = 0 ; i < src.size() ; i++)
+		{
+			if (r_cnt.get(i) == 0)
+			{continue;}
+
+			recv_prc.add(src.get(i));
+			recv_ptr.add(&r_buf.get(r_disp.get(i)));
+			recv_sz.add(r_cnt.get(i));
+		}
+
+		return ret;
+	}
+
+public:
+
+	//! Constructor
+	neighbor_exchange()
+	{}
+
+	//! Copy constructor, the neighborhood is copied, the communicator is not shared across objects
+	neighbor_exchange(const neighbor_exchange & ne)
+	:src(ne.src),dst(ne.dst)
+	{}
+
+	//! Copy, the neighborhood is copied, the communicator is not shared across objects
+	neighbor_exchange & operator=(const neighbor_exchange & ne)
+	{
+		setNeighborhood(ne.src,ne.dst);
+
+		return *this;
+	}
+
+	//! Destructor
+	~neighbor_exchange()
+	{
+		free_comm();
+	}
+
+	/*! \brief Set the neighborhood
+	 *
+	 * The neighborhood is the union of the two lists, in this way it is consistent across processors
+	 * even if one processor is near to another but not the opposite. The graph communicator is created
+	 * at the first exchange
+	 *
+	 * \param sources processors we receive from
+	 * \param destinations processors we send to
+	 *
+	 */
+	template<typename T>
+	void setNeighborhood(const openfpm::vector<T> & sources, const openfpm::vector<T> & destinations)
+	{
+		free_comm();
+
+		src.clear();
+		for (size_t i = 0 ; i < sources.size() ; i++)
+		{src.add(sources.get(i));}
+
+		for (size_t i = 0 ; i < destinations.size() ; i++)
+		{src.add(destinations.get(i));}
+
+		std::sort(src.begin(),src.end());
+		auto last = std::unique(src.begin(),src.end());
+		src.resize(last - src.begin());
+
+		dst = src;
+	}
+
+	/*! \brief Create the graph communicator
+	 *
+	 * \note It is collective on MPI_COMM_WORLD, it does nothing if already created
+	 *
+	 */
+	void init()
+	{
+		if (graph_comm != MPI_COMM_NULL)
+		{return;}
+
+		MPI_Dist_graph_create_adjacent(MPI_COMM_WORLD,
+									   src.size(),(src.size() != 0)?&src.get(0):NULL,MPI_UNWEIGHTED,
+									   dst.size(),(dst.size() != 0)?&dst.get(0):NULL,MPI_UNWEIGHTED,
+									   MPI_INFO_NULL,0,&graph_comm);
+	}
+
+	/*! \brief Check if we can send to a processor
+	 *
+	 * \param prc processor (rank in MPI_COMM_WORLD)
+	 *
+	 * \return true if the processor is in the neighborhood
+	 *
+	 */
+	bool isNeighbor(size_t prc) const
+	{
+		return find(dst,prc) != -1;
+	}
+
+	/*! \brief Exchange buffers with the neighborhood processors
+	 *
+	 * \param prc destination processors
+	 * \param ptr pointer to the data to send for each destination
+	 * \param sz size in byte of each message
+	 * \param recv_prc processors (ordered by rank) that sent a message to us
+	 * \param recv_ptr for each received message a pointer to the data
+	 * \param recv_sz size in byte of each received message
+	 *
+	 * \return false if a destination is not a neighborhood processor (the message is not sent)
+	 *
+	 */
+	bool exchange(const openfpm::vector<size_t> & prc,
+				  const openfpm::vector<const void *> & ptr,
+				  const openfpm::vector<size_t> & sz,
+				  openfpm::vector<size_t> & recv_prc,
+				  openfpm::vector<const void *> & recv_ptr,
+				  openfpm::vector<size_t> & recv_sz)
+	{
+		return exchange_(prc,ptr,sz,recv_prc,recv_ptr,recv_sz,false);
+	}
+
+	/*! \brief Exchange buffers with the neighborhood processors when the size of the messages
+	 *         we receive is already known (no exchange of the sizes)
+	 *
+	 * \param prc destination processors
+	 * \param ptr pointer to the data to send for each destination
+	 * \param sz size in byte of each message
+	 * \param recv_prc in: processors we receive from, out: processors (ordered by rank) that sent a message to us
+	 * \param recv_ptr for each received message a pointer to the data
+	 * \param recv_sz in: size in byte of the message of each processor in recv_prc, out: size of each received message
+	 *
+	 * \return false if a destination is not a neighborhood processor (the message is not sent)
+	 *
+	 */
+	bool exchange_known(const openfpm::vector<size_t> & prc,
+						const openfpm::vector<const void *> & ptr,
+						const openfpm::vector<size_t> & sz,
+						openfpm::vector<size_t> & recv_prc,
+						openfpm::vector<const void *> & recv_ptr,
+						openfpm::vector<size_t> & recv_sz)
+	{
+		return exchange_(prc,ptr,sz,recv_prc,recv_ptr,recv_sz,true);
+	}
+};
+
+#endif /* NEIGHBOR_EXCHANGE_HPP_ */
@@ -0,0 +1,323 @@
+/*
+ * node_shared_exchange.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: i-bird
+ */
+
+#ifndef NODE_SHARED_EXCHANGE_HPP_
+#define NODE_SHARED_EXCHANGE_HPP_
+
+#include <mpi.h>
+#include "Vector/map_vector.hpp"
+
+//! Alignment of the messages inside a segment
+#define NODE_SHARED_ALIGN 64
+
+/*! \brief Exchange data between processors of the same node using an MPI-3 shared memory window
+ *
+ * Every processor of the node own a segment of a shared window. A processor reserve in its segment
+ * one message for each processor of the node it send to (begin), an header at the beginning of the
+ * segment store destination, offset and number of elements of every message. The sender write the data
+ * directly into the messages (no send buffer), after the synchronization on the node communicator
+ * (publish) every processor read the messages directed to it directly from the segments of the other
+ * processors (MPI_Win_shared_query), without MPI messages and without receive buffers
+ *
+ * \verbatim
+
+   begin()        ensure the size of the segments (Allreduce on the node), reserve the messages
+   ...            the sender write into the messages
+   publish()      Barrier on the node, return the pointers to the messages inside the other segments
+   ...            the receiver read the messages, they are valid until the next begin()
+
+ * \endverbatim
+ *
+ * \note begin and publish are collective across all the processors of the node
+ *
+ */
+class node_shared_exchange
+{
+	//! Message entry in the segment header
+	struct msg_entry
+	{
+		//! destination processor (rank in MPI_COMM_WORLD)
+		size_t dst;
+
+		//! offset of the message from the beginning of the segment
+		size_t off;
+
+		//! number of elements in the message
+		size_t n;
+	};
+
+	//! communicator of the processors on the same node
+	MPI_Comm node_comm = MPI_COMM_NULL;
+
+	//! For each processor (rank in MPI_COMM_WORLD) its rank in node_comm or -1 if it is on another node
+	openfpm::vector<int> node_rank;
+
+	//! For each rank in node_comm the rank in MPI_COMM_WORLD
+	openfpm::vector<size_t> world_rank;
+
+	//! Shared memory window
+	MPI_Win win = MPI_WIN_NULL;
+
+	//! size of the segments
+	size_t seg_sz = 0;
+
+	//! Pointer to the segment of each processor of the node (index is the rank in node_comm)
+	openfpm::vector<unsigned char *> seg_nd;
+
+	//! rank in MPI_COMM_WORLD
+	int rank = 0;
+
+	/*! \brief Round up to the alignment of the messages
+	 *
+	 */
+	static size_t align(size_t sz)
+	{
+		return (sz + NODE_SHARED_ALIGN - 1) / NODE_SHARED_ALIGN * NODE_SHARED_ALIGN;
+	}
+
+	/*! \brief Free the shared memory window
+	 *
+	 */
+	void free_window()
+	{
+		if (win != MPI_WIN_NULL)
+		{
+			MPI_Win_unlock_all(win);
+			MPI_Win_free(&win);
+			win = MPI_WIN_NULL;
+		}
+
+		seg_sz = 0;
+	}
+
+	/*! \brief Be sure that the segment of every processor can contain at least the requested bytes
+	 *
+	 * It is collective across the node, and it act also as a synchronization point, after it
+	 * every processor of the node has finished to read the messages of the previous exchange
+	 *
+	 * \param bytes requested size
+	 *
+	 */
+	void ensure(size_t bytes)
+	{
+		unsigned long int req = bytes;
+
+		MPI_Allreduce(MPI_IN_PLACE,&req,1,MPI_UNSIGNED_LONG,MPI_MAX,node_comm);
+
+		if (req <= seg_sz)
+		{return;}
+
+		size_t n_sz = req + req / 2;
+
+		free_window();
+
+		unsigned char * base;
+		MPI_Win_allocate_shared(n_sz,1,MPI_INFO_NULL,node_comm,&base,&win);
+		MPI_Win_lock_all(MPI_MODE_NOCHECK,win);
+		seg_sz = n_sz;
+
+		seg_nd.resize(world_rank.size());
+		for (size_t i = 0 ; i < world_rank.size() ; i++)
+		{
+			MPI_Aint sz;
+			int disp_unit;
+			MPI_Win_shared_query(win,i,&sz,&disp_unit,&seg_nd.get(i));
+		}
+	}
+
+public:
+
+	//! Constructor
+	node_shared_exchange()
+	{}
+
+	//! Copy constructor, the window is not shared across objects
+	node_shared_exchange(const node_shared_exchange & nse)
+	{}
+
+	//! Copy, the window is not shared across objects
+	node_shared_exchange & operator=(const node_shared_exchange & nse)
+	{
+		return *this;
+	}
+
+	//! Destructor
+	~node_shared_exchange()
+	{
+		int finalized = 0;
+		MPI_Finalized(&finalized);
+
+		if (finalized == false && node_comm != MPI_COMM_NULL)
+		{
+			free_window();
+			MPI_Comm_free(&node_comm);
+		}
+	}
+
+	/*! \brief Create the node communicator
+	 *
+	 * \note It is collective on MPI_COMM_WORLD, it does nothing if already initialized
+	 *
+	 */
+	void init()
+	{
+		if (node_comm != MPI_COMM_NULL)
+		{return;}
+
+		int size;
+
+		MPI_Comm_rank(MPI_COMM_WORLD,&rank);
+		MPI_Comm_size(MPI_COMM_WORLD,&size);
+
+		MPI_Comm_split_type(MPI_COMM_WORLD,MPI_COMM_TYPE_SHARED,rank,MPI_INFO_NULL,&node_comm);
+
+		int n_size;
+		MPI_Comm_size(node_comm,&n_size);
+
+		// translate the ranks of the node into world ranks
+		MPI_Group w_group;
+		MPI_Group n_group;
+		MPI_Comm_group(MPI_COMM_WORLD,&w_group);
+		MPI_Comm_group(node_comm,&n_group);
+
+		openfpm::vector<int> n_ranks;
+		openfpm::vector<int> w_ranks;
+		n_ranks.resize(n_size);
+		w_ranks.resize(n_size);
+
+		for (int i = 0 ; i < n_size ; i++)
+		{n_ranks.get(i) = i;}
+
+		MPI_Group_translate_ranks(n_group,n_size,&n_ranks.get(0),w_group,&w_ranks.get(0));
+
+		MPI_Group_free(&w_group);
+		MPI_Group_free(&n_group);
+
+		node_rank.resize(size);
+		for (int i = 0 ; i < size ; i++)
+		{node_rank.get(i) = -1;}
+
+		world_rank.resize(n_size);
+		for (int i = 0 ; i < n_size ; i++)
+		{
+			node_rank.get(w_ranks.get(i)) = i;
+			world_rank.get(i) = w_ranks.get(i);
+		}
+	}
+
+	/*! \brief Check if a processor is on the same node of the local processor
+	 *
+	 * \warning init must be called before
+	 *
+	 * \param prc processor (rank in MPI_COMM_WORLD)
+	 *
+	 * \return true if the processor is on the same node
+	 *
+	 */
+	bool isOnNode(size_t prc) const
+	{
+		return node_rank.get(prc) != -1;
+	}
+
+	/*! \brief Reserve in the local segment the messages for the processors of the node
+	 *
+	 * \param prc destination processors (they must be on the node)
+	 * \param n number of elements of each message
+	 * \param sz size in byte of each message
+	 * \param msg for each message the pointer where the data must be written
+	 *
+	 * \warning init must be called before
+	 *
+	 */
+	void begin(const openfpm::vector<size_t> & prc,
+			   const openfpm::vector<size_t> & n,
+			   const openfpm::vector<size_t> & sz,
+			   openfpm::vector<unsigned char *> & msg)
+	{
+		// header + data
+		size_t head = align(sizeof(size_t) + prc.size()*sizeof(msg_entry));
+		size_t tot = head;
+		for (size_t i = 0 ; i < sz.size() ; i++)
+		{tot += align(sz.get(i));}
+
+		ensure(tot);
+
+		unsigned char * seg = seg_nd.get(node_rank.get(rank));
+
+		*(size_t *)seg = prc.size();
+		msg_entry * ent = (msg_entry *)(seg + sizeof(size_t));
+
+		msg.resize(prc.size());
+
+		size_t off = head;
+		for (size_t i = 0 ; i < prc.size() ; i++)
+		{
+			ent[i].dst = prc.get(i);
+			ent[i].off = off;
+			ent[i].n = n.get(i);
+
+			msg.get(i) = seg + off;
+
+			off += align(sz.get(i));
+		}
+	}
+
+	/*! \brief Make the messages visible to the processors of the node and get the ones directed to us
+	 *
+	 * \param recv_prc processors (ordered by rank) that sent a message to us
+	 * \param recv_msg for each received message a pointer to the data (inside the segment of the sender)
+	 * \param recv_n number of elements of each received message
+	 *
+	 */
+	void publish(openfpm::vector<size_t> & recv_prc,
+				 openfpm::vector<const unsigned char *> & recv_msg,
+				 openfpm::vector<size_t> & recv_n)
+	{
+		MPI_Win_sync(win);
+		MPI_Barrier(node_comm);
+		MPI_Win_sync(win);
+
+		recv_prc.clear();
+		recv_msg.clear();
+		recv_n.clear();
+
+		// node ranks are ordered like the world ranks
+		for (size_t r = 0 ; r < world_rank.size() ; r++)
+		{
+			if (world_rank.get(r) == (size_t)rank)
+			{continue;}
+
+			const unsigned char * seg_r = seg_nd.get(r);
+			size_t n_msg = *(const size_t *)seg_r;
+			const msg_entry * ent_r = (const msg_entry *)(seg_r + sizeof(size_t));
+
+			for (size_t i = 0 ; i < n_msg ; i++)
+			{
+				if (ent_r[i].dst == (size_t)rank)
+				{
+					recv_prc.add(world_rank.get(r));
+					recv_msg.add(seg_r + ent_r[i].off);
+					recv_n.add(ent_r[i].n);
+				}
+			}
+		}
+	}
+
+	/*! \brief Offset of a block inside a message, the blocks of a message are aligned
+	 *
+	 * \param sz size of the previous blocks
+	 *
+	 * \return the offset of the next block
+	 *
+	 */
+	static size_t block_offset(size_t sz)
+	{
+		return align(sz);
+	}
+};
+
+#endif /* NODE_SHARED_EXCHANGE_HPP_ */